@@ -1,13 +1,24 @@
-fr_import_lef "path/to/example.lef"
-fr_import_def "path/to/example.def"
+if {![fr_read_db "path/to/example.db" "path/to/example.lef path/to/example.def"]} {
+        fr_import_lef "path/to/example.lef"
+        fr_import_def "path/to/example.def"
+        fr_write_db "path/to/example.db"
+}
 set_output_file "path/to/output.guide"
+set_recording_file "path/to/input.frec"
 
 set_capacity_adjustment 0.X
+set_max_runtime S
+set_max_maze_rounds R
+set_overflow_plateau P
+set_multi_start K N
+set_hilbert_net_order B
+set_verification_level V
 set_layer_adjustment M 0.N
 set_region_adjustment lx ly ux uy layer adjustment
 set_min_layer Y
 set_max_layer Z
 set_unidirectional_routing B
+set_num_threads T
 
 run
 
@@ -15,15 +26,25 @@ exit
 
 # fr_import_lef:                string input. set the lef file that will be loaded
 # fr_import_def:                string input. set the def file that will be loaded
+# fr_read_db:                   string inputs. load a database saved by fr_write_db from the listed LEF and DEF files, returns 0 if it was saved from other files or one of them changed since. optional
+# fr_write_db:                  string input. save the imported LEF and DEF files as a database. optional
 # set_output_file:              string input. indicate the name of the generated guides file. do not need ".guide" extension
+# set_recording_file:           string input. indicate the file where the routing input of FastRoute is recorded, to be routed again by the Replay target of FastRoute4.1. optional
 
 # set_pitches_in_tile:          integer input. indicate the number of routing tracks per tile
 # set_capacity_adjustment:      float input. indicate the percentage reduction of each edge. optional
+# set_max_runtime:              float input. indicate the wall-clock budget of the routing in seconds. optional
+# set_max_maze_rounds:          integer input. indicate the max number of maze routing rounds. optional
+# set_overflow_plateau:         integer input. indicate the number of rounds without a better overflow before stopping. optional
+# set_multi_start:              integer, integer inputs. indicate the number of speculative variants and the number of maze routing rounds of each phase. optional
+# set_hilbert_net_order:        boolean input. indicate if the nets are routed in Hilbert curve order of their positions. optional
+# set_verification_level:       string input. indicate the checks of the final routes: none, fast or full. optional
 # set_layer_adjustment:         integer, float inputs. indicate the percentage reduction of each edge in a specified layer
 # set_region_adjustment:        int, int, int, int, int, float. indicate the percentage reduction of each edge in a specified region
 # set_min_layer:                integer input. indicate the min routing layer available for FastRoute. optional
 # set_max_layer:                integer input. indicate the max routing layer available for FastRoute. optional
 # set_unidirectional_routing:   boolean input. indicate if unidirectional routing is activated. optional
+# set_num_threads:              integer input. indicate the number of threads used by the initialization stages, the pattern routing passes and the layer assignment. optional
 
 
 # start_fastroute:              initialize FastRoute4-lefdef structures
@@ -2,4 +2,5 @@ mkdir -p /fastroute/build
 rm -f /fastroute/src/TclInterfaceWrap.cpp
 cd /fastroute/build
 cmake -DCMAKE_BUILD_TYPE=Release ..  && \
-    make
\ No newline at end of file
+    make && \
+    make Replay
\ No newline at end of file
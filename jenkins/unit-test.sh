@@ -2,4 +2,6 @@ cp /fastroute/etc/*.dat /fastroute/
 cd fastroute/
 rm -f FastRoute
 ln -s /fastroute/build/FastRoute ./FastRoute
+rm -f Replay
+ln -s /fastroute/build/third_party/fastroute/Replay ./Replay
 tclsh tests/run_all.tcl
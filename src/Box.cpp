@@ -39,7 +39,7 @@
 
 namespace FastRoute {
 
-Coordinate Box::getMiddle() {
+Coordinate Box::getMiddle() const {
         DBU lowerX = _lowerBound.getX();
         DBU lowerY = _lowerBound.getY();
         DBU upperX = _upperBound.getX();
@@ -48,7 +48,7 @@ Coordinate Box::getMiddle() {
         return Coordinate((lowerX + (upperX - lowerX)/ 2.0) , (lowerY + (upperY - lowerY)/ 2.0));
 }
 
-DBU Box::getHalfPerimeter() {
+DBU Box::getHalfPerimeter() const {
         DBU lowerX = _lowerBound.getX();
         DBU lowerY = _lowerBound.getY();
         DBU upperX = _upperBound.getX();
@@ -67,9 +67,14 @@ public:
         Coordinate getLowerBound() const { return _lowerBound; }
         Coordinate getUpperBound() const { return _upperBound; }
         int getLayer() const { return _layer; }
+        
+        Box translate(const DBU dx, const DBU dy) const {
+                return Box(_lowerBound.getX() + dx, _lowerBound.getY() + dy,
+                           _upperBound.getX() + dx, _upperBound.getY() + dy, _layer);
+        }
 
-        DBU getHalfPerimeter();
-        Coordinate getMiddle();
+        DBU getHalfPerimeter() const;
+        Coordinate getMiddle() const;
         
         bool overlap(Box box);
 };
@@ -0,0 +1,180 @@
+
+////////////////////////////////////////////////////////////////////////////////
+// Authors: Vitor Bandeira, Mateus Fogaça, Eder Matheus Monteiro e Isadora
+// Oliveira
+//          (Advisor: Ricardo Reis)
+//
+// BSD 3-Clause License
+//
+// Copyright (c) 2019, Federal University of Rio Grande do Sul (UFRGS)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+
+#include <algorithm>
+#include <thread>
+
+#include "CapacityRaster.h"
+
+namespace FastRoute {
+
+CapacityRaster::CapacityRaster(const int xGrids, const int yGrids, const int numLayers)
+    : _xGrids(xGrids), _yGrids(yGrids), _layers(numLayers) {
+        for (LAYER &raster : _layers)
+                raster._used = false;
+}
+
+// Edges are indexed by their lower left gcell, in a (xGrids + 1) x (yGrids + 1)
+// grid so the difference entries past the last edge have a place to go
+void CapacityRaster::addRect(int layer, std::vector<int> &diff, int x1, int y1, int x2, int y2, int value) {
+        LAYER &raster = _layers[layer - 1];
+        int lastX = (raster._direction == RoutingLayer::HORIZONTAL) ? _xGrids - 2 : _xGrids - 1;
+        int lastY = (raster._direction == RoutingLayer::HORIZONTAL) ? _yGrids - 1 : _yGrids - 2;
+        int width = _xGrids + 1;
+
+        x1 = std::max(x1, 0);
+        y1 = std::max(y1, 0);
+        x2 = std::min(x2, lastX);
+        y2 = std::min(y2, lastY);
+        if (value == 0 || x1 > x2 || y1 > y2)
+                return;
+
+        diff[y1 * width + x1] += value;
+        diff[y1 * width + x2 + 1] -= value;
+        diff[(y2 + 1) * width + x1] -= value;
+        diff[(y2 + 1) * width + x2 + 1] += value;
+}
+
+// An obstacle covering the tiles from firstTile to lastTile blocks the edges
+// of its inner rows (columns in vertical layers) completely and removes
+// firstTileReduce and lastTileReduce tracks from the edges of its first and
+// last rows (columns)
+void CapacityRaster::addBlockage(int layer, bool direction, const Grid::TILE &firstTile,
+                                 const Grid::TILE &lastTile, int firstTileReduce, int lastTileReduce) {
+        LAYER &raster = _layers[layer - 1];
+
+        if (!raster._used) {
+                raster._used = true;
+                raster._direction = direction;
+                raster._blocked.assign((_xGrids + 1) * (_yGrids + 1), 0);
+                raster._reduce.assign((_xGrids + 1) * (_yGrids + 1), 0);
+        }
+
+        if (direction == RoutingLayer::HORIZONTAL) {
+                addRect(layer, raster._reduce, firstTile._x, firstTile._y, lastTile._x, firstTile._y, firstTileReduce);
+                if (lastTile._y > firstTile._y) {
+                        addRect(layer, raster._reduce, firstTile._x, lastTile._y, lastTile._x, lastTile._y, lastTileReduce);
+                        addRect(layer, raster._blocked, firstTile._x, firstTile._y + 1, lastTile._x, lastTile._y - 1, 1);
+                }
+        } else {
+                addRect(layer, raster._reduce, firstTile._x, firstTile._y, firstTile._x, lastTile._y, firstTileReduce);
+                if (lastTile._x > firstTile._x) {
+                        addRect(layer, raster._reduce, lastTile._x, firstTile._y, lastTile._x, lastTile._y, lastTileReduce);
+                        addRect(layer, raster._blocked, firstTile._x + 1, firstTile._y, lastTile._x - 1, lastTile._y, 1);
+                }
+        }
+}
+
+// Turns the difference grids of a layer into coverage counts and computes the
+// final capacity of every covered edge. Reductions are subtracted from the
+// capacity before the raster is applied and clamped at zero once, which is
+// what applying the obstacles one after another gives.
+void CapacityRaster::resolveLayer(FT &fastRoute, int layer) {
+        LAYER &raster = _layers[layer - 1];
+        int width = _xGrids + 1;
+        int capsWidth = (raster._direction == RoutingLayer::HORIZONTAL) ? _xGrids - 1 : _xGrids;
+        int capsHeight = (raster._direction == RoutingLayer::HORIZONTAL) ? _yGrids : _yGrids - 1;
+
+        for (int y = 0; y < _yGrids; y++) {
+                for (int x = 0; x < _xGrids; x++) {
+                        int pos = y * width + x;
+                        if (x > 0) {
+                                raster._blocked[pos] += raster._blocked[pos - 1];
+                                raster._reduce[pos] += raster._reduce[pos - 1];
+                        }
+                        if (y > 0) {
+                                raster._blocked[pos] += raster._blocked[pos - width];
+                                raster._reduce[pos] += raster._reduce[pos - width];
+                        }
+                        if (x > 0 && y > 0) {
+                                raster._blocked[pos] -= raster._blocked[pos - width - 1];
+                                raster._reduce[pos] -= raster._reduce[pos - width - 1];
+                        }
+                }
+        }
+
+        raster._caps.resize(capsWidth * capsHeight);
+        fastRoute.getLayerCapacities(layer, raster._direction == RoutingLayer::HORIZONTAL, raster._caps.data());
+
+        for (int y = 0; y < capsHeight; y++) {
+                for (int x = 0; x < capsWidth; x++) {
+                        int blocked = raster._blocked[y * width + x];
+                        int reduce = raster._reduce[y * width + x];
+                        int &edgeCap = raster._caps[y * capsWidth + x];
+
+                        if (blocked > 0)
+                                edgeCap = 0;
+                        else
+                                edgeCap = std::max(edgeCap - reduce, 0);
+                }
+        }
+
+        std::vector<int>().swap(raster._blocked);
+        std::vector<int>().swap(raster._reduce);
+}
+
+// The layers are resolved in parallel, the capacities are applied afterwards
+// in layer order since they also update the shared 2D edges
+void CapacityRaster::apply(FT &fastRoute, int numThreads) {
+        std::vector<int> usedLayers;
+
+        for (int layer = 1; layer <= _layers.size(); layer++) {
+                if (_layers[layer - 1]._used)
+                        usedLayers.push_back(layer);
+        }
+
+        int numWorkers = std::min<int>(std::max(numThreads, 1), usedLayers.size());
+        std::vector<std::thread> workers;
+        for (int worker = 1; worker < numWorkers; worker++) {
+                workers.push_back(std::thread([&, worker]() {
+                        for (int i = worker; i < usedLayers.size(); i += numWorkers)
+                                resolveLayer(fastRoute, usedLayers[i]);
+                }));
+        }
+        for (int i = 0; i < usedLayers.size(); i += std::max(numWorkers, 1))
+                resolveLayer(fastRoute, usedLayers[i]);
+        for (std::thread &worker : workers)
+                worker.join();
+
+        for (int layer : usedLayers) {
+                LAYER &raster = _layers[layer - 1];
+                fastRoute.setLayerCapacities(layer, raster._direction == RoutingLayer::HORIZONTAL, raster._caps.data());
+                std::vector<int>().swap(raster._caps);
+                raster._used = false;
+        }
+}
+
+}
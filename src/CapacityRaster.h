@@ -0,0 +1,78 @@
+
+////////////////////////////////////////////////////////////////////////////////
+// Authors: Vitor Bandeira, Mateus Fogaça, Eder Matheus Monteiro e Isadora
+// Oliveira
+//          (Advisor: Ricardo Reis)
+//
+// BSD 3-Clause License
+//
+// Copyright (c) 2019, Federal University of Rio Grande do Sul (UFRGS)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+
+#ifndef __CAPACITYRASTER_H_
+#define __CAPACITYRASTER_H_
+
+#include <vector>
+#include "Grid.h"
+#include "RoutingLayer.h"
+#include "../include/FastRoute.h"
+
+namespace FastRoute {
+
+// Accumulates the blocked tracks of obstacles and adjusted regions into a
+// difference grid per layer and resolves all of them with one prefix sum,
+// so each edge capacity is read and adjusted once no matter how many
+// obstacles overlap it.
+class CapacityRaster {
+private:
+        typedef struct {
+                bool _used;
+                bool _direction;
+                std::vector<int> _blocked;  // number of obstacles fully blocking each edge
+                std::vector<int> _reduce;   // tracks removed from each edge by partially blocking obstacles
+                std::vector<int> _caps;     // resolved capacities of the edges of the layer
+        } LAYER;
+
+        int _xGrids;
+        int _yGrids;
+        std::vector<LAYER> _layers;
+
+        void addRect(int layer, std::vector<int> &diff, int x1, int y1, int x2, int y2, int value);
+        void resolveLayer(FT &fastRoute, int layer);
+
+public:
+        CapacityRaster(const int xGrids, const int yGrids, const int numLayers);
+
+        void addBlockage(int layer, bool direction, const Grid::TILE &firstTile,
+                         const Grid::TILE &lastTile, int firstTileReduce, int lastTileReduce);
+        void apply(FT &fastRoute, int numThreads);
+};
+
+}
+
+#endif /* __CAPACITYRASTER_H_ */
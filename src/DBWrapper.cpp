@@ -1,5 +1,7 @@
 #include "DBWrapper.h"
 
+#include <sys/stat.h>
+#include <cstdio>
 #include <iostream>
 #include <vector>
 #include <cmath>
@@ -11,6 +13,14 @@
 #include "Coordinate.h"
 #include "Box.h"
 #include "Pin.h"
+#include "ParallelFor.h"
+#include "TaskGraph.h"
+
+// A database saved by writeDB is a header (DB_MAGIC, DB_VERSION, # input
+// files), the path, size and mtime of each input file, the OpenDB database and
+// a trailer with the size of the OpenDB database and DB_MAGIC
+#define DB_MAGIC 0x46524442  // "FRDB"
+#define DB_VERSION 1
 
 namespace FastRoute {
 
@@ -22,6 +32,10 @@ DBWrapper::DBWrapper(Netlist& netlist, Grid& grid) :
 void DBWrapper::parseLEF(const std::string &filename) {
         odb::lefin lefReader(_db, false);
         lefReader.createTechAndLib("testlib", filename.c_str());
+        
+        INPUT_FILE input;
+        getInputFile(filename, input);
+        _inputFiles.push_back(input);
 }
 
 void DBWrapper::parseDEF(const std::string &filename) {
@@ -35,19 +49,193 @@ void DBWrapper::parseDEF(const std::string &filename) {
         }
         
         _chip = defReader.createChip(searchLibs, filename.c_str());
+        
+        INPUT_FILE input;
+        getInputFile(filename, input);
+        _inputFiles.push_back(input);
+}
+
+bool DBWrapper::getInputFile(const std::string &path, INPUT_FILE &input) {
+        struct stat status;
+        
+        input._path = path;
+        input._size = -1;
+        input._mtime = -1;
+        if (stat(path.c_str(), &status) != 0) {
+                return false;
+        }
+        
+        input._size = status.st_size;
+        input._mtime = status.st_mtime;
+        return true;
+}
+
+// Loads a database saved by writeDB, in place of the files read so far, if it
+// was saved from the LEF and DEF files of inputPaths, in the same order, and
+// none of them changed since
+bool DBWrapper::readDB(const std::string &filename, const std::vector<std::string> &inputPaths) {
+        FILE* file = std::fopen(filename.c_str(), "rb");
+        if (!file) {
+                std::cout << "[WARNING] Database " << filename << " not found\n";
+                return false;
+        }
+        
+        int header[3];
+        if (std::fread(header, sizeof(int), 3, file) != 3 || header[0] != DB_MAGIC ||
+            header[1] != DB_VERSION || header[2] < 0) {
+                std::cout << "[WARNING] " << filename << " is not a FastRoute database\n";
+                std::fclose(file);
+                return false;
+        }
+        
+        // The saved paths are compared with the expected ones before anything
+        // is allocated, so a corrupt header cannot ask for a huge allocation
+        if (header[2] != (int)inputPaths.size()) {
+                std::cout << "[WARNING] Database " << filename << " was saved from other LEF and DEF files\n";
+                std::fclose(file);
+                return false;
+        }
+        
+        std::vector<INPUT_FILE> inputFiles(header[2]);
+        bool complete = true;
+        for (int i = 0; i < header[2]; i++) {
+                INPUT_FILE& input = inputFiles[i];
+                int length;
+                long long key[2];
+                if (std::fread(&length, sizeof(int), 1, file) != 1 || length < 0) {
+                        complete = false;
+                        break;
+                }
+                if (length != (int)inputPaths[i].size()) {
+                        std::cout << "[WARNING] Database " << filename << " was saved from other LEF and DEF files\n";
+                        std::fclose(file);
+                        return false;
+                }
+                input._path.resize(length);
+                if ((length > 0 && std::fread(&input._path[0], 1, length, file) != (size_t)length) ||
+                    std::fread(key, sizeof(long long), 2, file) != 2) {
+                        complete = false;
+                        break;
+                }
+                if (input._path != inputPaths[i]) {
+                        std::cout << "[WARNING] Database " << filename << " was saved from other LEF and DEF files\n";
+                        std::fclose(file);
+                        return false;
+                }
+                
+                INPUT_FILE current;
+                if (!getInputFile(input._path, current) || current._size != key[0] ||
+                    current._mtime != key[1]) {
+                        std::cout << "[WARNING] " << input._path << " changed since database "
+                                  << filename << " was saved\n";
+                        std::fclose(file);
+                        return false;
+                }
+                input = current;
+        }
+        
+        // The trailer gives the size of the OpenDB database, so a file cut short
+        // is rejected before anything is read
+        long dataStart = std::ftell(file);
+        long long dataSize = -1;
+        int endMagic = 0;
+        if (complete) {
+                complete = std::fseek(file, -(long)(sizeof(long long) + sizeof(int)), SEEK_END) == 0 &&
+                           std::fread(&dataSize, sizeof(long long), 1, file) == 1 &&
+                           std::fread(&endMagic, sizeof(int), 1, file) == 1 && endMagic == DB_MAGIC &&
+                           std::ftell(file) - (long)(sizeof(long long) + sizeof(int)) - dataStart == dataSize &&
+                           std::fseek(file, dataStart, SEEK_SET) == 0;
+        }
+        
+        if (!complete) {
+                std::cout << "[WARNING] Database " << filename << " is truncated\n";
+                std::fclose(file);
+                return false;
+        }
+        
+        // The current database is only replaced once the saved one is read
+        odb::dbDatabase* db = odb::dbDatabase::create();
+        bool loaded = true;
+        try {
+                db->read(file);
+        } catch (...) {
+                loaded = false;
+        }
+        
+        if (!loaded || std::ferror(file) || std::ftell(file) != dataStart + dataSize || !db->getChip()) {
+                std::cout << "[WARNING] Database " << filename << " cannot be read\n";
+                odb::dbDatabase::destroy(db);
+                std::fclose(file);
+                return false;
+        }
+        std::fclose(file);
+        
+        odb::dbDatabase::destroy(_db);
+        _db = db;
+        _chip = _db->getChip();
+        _masterGeometries.clear();
+        _inputFiles = inputFiles;
+        return true;
+}
+
+// Saves the database with the LEF and DEF files read into it. The file is
+// written under a temporary name and renamed once complete, so a failed save
+// never leaves a file that fr_read_db accepts
+void DBWrapper::writeDB(const std::string &filename) {
+        if (!_chip) {
+                std::cout << "[ERROR] No design to save, import the LEF and DEF files first\n";
+                return;
+        }
+        
+        std::string tmpFilename = filename + ".tmp";
+        FILE* file = std::fopen(tmpFilename.c_str(), "wb");
+        if (!file) {
+                std::cout << "[ERROR] Database " << filename << " cannot be written\n";
+                return;
+        }
+        
+        int header[3] = {DB_MAGIC, DB_VERSION, (int)_inputFiles.size()};
+        std::fwrite(header, sizeof(int), 3, file);
+        for (const INPUT_FILE& input : _inputFiles) {
+                int length = input._path.size();
+                long long key[2] = {input._size, input._mtime};
+                std::fwrite(&length, sizeof(int), 1, file);
+                std::fwrite(input._path.data(), 1, length, file);
+                std::fwrite(key, sizeof(long long), 2, file);
+        }
+        
+        long dataStart = std::ftell(file);
+        bool complete = true;
+        try {
+                _db->write(file);
+        } catch (...) {
+                complete = false;
+        }
+        
+        long long dataSize = std::ftell(file) - dataStart;
+        int endMagic = DB_MAGIC;
+        std::fwrite(&dataSize, sizeof(long long), 1, file);
+        std::fwrite(&endMagic, sizeof(int), 1, file);
+        
+        complete = complete && !std::ferror(file);
+        complete = (std::fclose(file) == 0) && complete;
+        if (!complete || std::rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+                std::cout << "[ERROR] Database " << filename << " cannot be written\n";
+                std::remove(tmpFilename.c_str());
+        }
 }
 
 void DBWrapper::initGrid() {
         odb::dbTech* tech = _db->getTech();
         if (!tech) {
                 std::cout << "[ERROR] obd::dbTech not initialized! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
 
         odb::dbBlock* block = _chip->getBlock();
         if (!block) {
                 std::cout << "[ERROR] odb::dbBlock not found! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
         
         odb::dbBox* coreBBox = block->getBBox();
@@ -55,14 +243,14 @@ void DBWrapper::initGrid() {
         
         if (!selectedLayer) {
                 std::cout << "[ERROR] Layer" << selectedMetal << " not found! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
         
         odb::dbTrackGrid* selectedTrack = block->findTrackGrid(selectedLayer);
         
         if (!selectedTrack) {
                 std::cout << "[ERROR] Track for layer " << selectedMetal << " not found! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
         
         int trackStepX, trackStepY;
@@ -79,7 +267,7 @@ void DBWrapper::initGrid() {
                 trackSpacing = trackStepX;
         } else {
                 std::cout << "[ERROR] Layer " << selectedMetal << " does not have valid direction! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
         
         long lowerLeftX = coreBBox->xMin();
@@ -115,7 +303,7 @@ void DBWrapper::initGrid() {
                 metal1Orientation = RoutingLayer::VERTICAL;
         } else {
                 std::cout << "[ERROR] Layer 1 does not have valid direction! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
         
         std::vector<int> genericVector(numLayers);
@@ -132,7 +320,7 @@ void DBWrapper::initRoutingLayers(std::vector<RoutingLayer>& routingLayers) {
         
         if (!tech) {
                 std::cout << "[ERROR] obd::dbTech not initialized! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
         
         for (int l = 1; l <= tech->getRoutingLayerCount(); l++) {
@@ -146,7 +334,7 @@ void DBWrapper::initRoutingLayers(std::vector<RoutingLayer>& routingLayers) {
                         preferredDirection = RoutingLayer::VERTICAL;
                 } else {
                         std::cout << "[ERROR] Layer 1 does not have valid direction! Exiting...\n";
-                        std::exit(1);
+                        throw TaskFailure(1);
                 }
                 
                 RoutingLayer routingLayer = RoutingLayer(index, name, preferredDirection);
@@ -158,13 +346,13 @@ void DBWrapper::initRoutingTracks(std::vector<RoutingTracks>& allRoutingTracks)
         odb::dbTech* tech = _db->getTech();
         if (!tech) {
                 std::cout << "[ERROR] obd::dbTech not initialized! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
 
         odb::dbBlock* block = _chip->getBlock();
         if (!block) {
                 std::cout << "[ERROR] odb::dbBlock not found! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
         
         for (int layer = 1; layer <= tech->getRoutingLayerCount(); layer++) {
@@ -172,14 +360,14 @@ void DBWrapper::initRoutingTracks(std::vector<RoutingTracks>& allRoutingTracks)
         
                 if (!techayer) {
                         std::cout << "[ERROR] Layer" << selectedMetal << " not found! Exiting...\n";
-                        std::exit(1);
+                        throw TaskFailure(1);
                 }
 
                 odb::dbTrackGrid* selectedTrack = block->findTrackGrid(techayer);
 
                 if (!selectedTrack) {
                         std::cout << "[ERROR] Track for layer " << selectedMetal << " not found! Exiting...\n";
-                        std::exit(1);
+                        throw TaskFailure(1);
                 }
                 
                 int trackStepX, trackStepY;
@@ -203,7 +391,7 @@ void DBWrapper::initRoutingTracks(std::vector<RoutingTracks>& allRoutingTracks)
                         orientation = RoutingLayer::VERTICAL;
                 } else {
                         std::cout << "[ERROR] Layer " << selectedMetal << " does not have valid direction! Exiting...\n";
-                        std::exit(1);
+                        throw TaskFailure(1);
                 }
                 
                 RoutingTracks routingTracks = RoutingTracks(layer, spacing,
@@ -225,13 +413,13 @@ void DBWrapper::computeCapacities() {
         
         if (!tech) {
                 std::cout << "[ERROR] obd::dbTech not initialized! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
         
         odb::dbBlock* block = _chip->getBlock();
         if (!block) {
                 std::cout << "[ERROR] odb::dbBlock not found! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
         
         for (int l = 1; l <= tech->getRoutingLayerCount(); l++) {
@@ -241,7 +429,7 @@ void DBWrapper::computeCapacities() {
                 
                 if (!track) {
                         std::cout << "[ERROR] Track for layer " << l << " not found! Exiting...\n";
-                        std::exit(1);
+                        throw TaskFailure(1);
                 }
                 
                 track->getGridPatternX(0, initTrackX, numTracksX, trackStepX);
@@ -261,7 +449,7 @@ void DBWrapper::computeCapacities() {
                         _grid->addVerticalCapacity(vCapacity, l-1);
                 } else {
                         std::cout << "[ERROR] Layer " << l << " does not have valid direction! Exiting...\n";
-                        std::exit(1);
+                        throw TaskFailure(1);
                 }
         }
 }
@@ -277,13 +465,13 @@ void DBWrapper::computeSpacingsAndMinWidth() {
         
         if (!tech) {
                 std::cout << "[ERROR] obd::dbTech not initialized! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
         
         odb::dbBlock* block = _chip->getBlock();
         if (!block) {
                 std::cout << "[ERROR] odb::dbBlock not found! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
         
         for (int l = 1; l <= tech->getRoutingLayerCount(); l++) {
@@ -293,7 +481,7 @@ void DBWrapper::computeSpacingsAndMinWidth() {
                 
                 if (!track) {
                         std::cout << "[ERROR] Track for layer " << l << " not found! Exiting...\n";
-                        std::exit(1);
+                        throw TaskFailure(1);
                 }
                 
                 track->getGridPatternX(0, initTrackX, numTracksX, trackStepX);
@@ -305,7 +493,7 @@ void DBWrapper::computeSpacingsAndMinWidth() {
                         minWidth = trackStepX;
                 } else {
                         std::cout << "[ERROR] Layer " << l << " does not have valid direction! Exiting...\n";
-                        std::exit(1);
+                        throw TaskFailure(1);
                 }
                 
                 _grid->addSpacing(minSpacing, l-1);
@@ -313,137 +501,96 @@ void DBWrapper::computeSpacingsAndMinWidth() {
         }
 }
 
-void DBWrapper::initNetlist() {
+void DBWrapper::initNetlist(int numThreads) {
         odb::dbBlock* block = _chip->getBlock();
         if (!block) {
                 std::cout << "[ERROR] ads::dbBlock not found! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
         
         odb::dbSet<odb::dbNet> nets = block->getNets();
         
         if (nets.size() == 0) {
                 std::cout << "[ERROR] Design without nets. Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
         
         odb::dbSet<odb::dbNet>::iterator nIter;
+        std::vector<odb::dbNet*> signalNets;
         
         for (nIter = nets.begin(); nIter != nets.end(); ++nIter) {
-                std::vector<Pin> netPins;
-                
                 odb::dbNet* currNet = *nIter;
                 if (currNet->getSigType().getValue() == odb::dbSigType::POWER ||
                     currNet->getSigType().getValue() == odb::dbSigType::GROUND ||
                     currNet->getSWires().size() > 0) {
                         continue;
                 }
+                signalNets.push_back(currNet);
+        }
+        
+        // initMasterGeometries filled the master geometry cache, the threads
+        // only read it
+        std::vector<std::vector<Pin>> netPins(signalNets.size());
+        parallelFor(signalNets.size(), numThreads, [&](int begin, int end) {
+                for (int i = begin; i < end; i++) {
+                        initNetPins(signalNets[i], netPins[i]);
+                }
+        });
+        
+        // Nets are added in the order of the block
+        for (int i = 0; i < signalNets.size(); i++) {
+                odb::dbNet* currNet = signalNets[i];
                 std::string netName = currNet->getConstName();
                 std::string signalType = currNet->getSigType().getString();
+                _netlist->addNet(netName, signalType, std::move(netPins[i]));
+        }
+}
+
+// Caches the geometry of every master and orientation used by the block.
+// Once it is done getMasterGeometry only reads the cache, so netlist and
+// obstacle extraction can share it from different threads. It must run
+// before initNetlist and initObstacles.
+void DBWrapper::initMasterGeometries() {
+        odb::dbBlock* block = _chip->getBlock();
+        if (!block) {
+                std::cout << "[ERROR] odb::dbBlock not found! Exiting...\n";
+                throw TaskFailure(1);
+        }
+        
+        odb::dbSet<odb::dbInst> insts = block->getInsts();
+        odb::dbSet<odb::dbInst>::iterator instIter;
+        for (instIter = insts.begin(); instIter != insts.end(); instIter++) {
+                getMasterGeometry(*instIter);
+        }
+}
+
+void DBWrapper::initNetPins(odb::dbNet* currNet, std::vector<Pin>& netPins) {
+        std::string netName = currNet->getConstName();
+        
+        // Iterate through all instance pins
+        odb::dbSet<odb::dbITerm> iTerms = currNet->getITerms();
+        odb::dbSet<odb::dbITerm>::iterator iIter;
+        
+        for (iIter = iTerms.begin(); iIter != iTerms.end(); iIter++) {
+                odb::dbITerm* currITerm = *iIter;
+                int pX, pY;
+                std::string pinName;
+                std::vector<int> pinLayers;
+                std::map<int, std::vector<Box>> pinBoxes;
                 
-                // Iterate through all instance pins
-                odb::dbSet<odb::dbITerm> iTerms = currNet->getITerms();
-                odb::dbSet<odb::dbITerm>::iterator iIter;
+                odb::dbMTerm* mTerm = currITerm->getMTerm();
+                std::string instName = currITerm->getInst()->getConstName();
+                pinName = mTerm->getConstName();
+                pinName = instName + ":" + pinName;
                 
-                for (iIter = iTerms.begin(); iIter != iTerms.end(); iIter++) {
-                        odb::dbITerm* currITerm = *iIter;
-                        int pX, pY;
-                        std::string pinName;
-                        std::vector<int> pinLayers;
-                        std::map<int, std::vector<Box>> pinBoxes;
-                        
-                        odb::dbMTerm* mTerm = currITerm->getMTerm();
-                        std::string instName = currITerm->getInst()->getConstName();
-                        pinName = mTerm->getConstName();
-                        pinName = instName + ":" + pinName;
-                        
-                        odb::dbSet<odb::dbMPin> mTermPins = mTerm->getMPins();
-                        odb::dbSet<odb::dbMPin>::iterator pinIter;
-                        
-                        odb::dbInst* inst = currITerm->getInst();
-                        inst->getOrigin(pX, pY);
-                        odb::adsPoint origin = odb::adsPoint(pX, pY);
-                        odb::dbTransform transform(inst->getOrient(), origin);
-                        
-                        for (pinIter = mTermPins.begin(); pinIter != mTermPins.end(); pinIter++) {
-                                Coordinate lowerBound;
-                                Coordinate upperBound;
-                                Box pinBox;
-                                int pinLayer;
-                                
-                                odb::dbMPin* currMTermPin = *pinIter;
-                                odb::dbSet<odb::dbBox> geometries = currMTermPin->getGeometry();
-                                odb::dbSet<odb::dbBox>::iterator geomIter;
-                                
-                                for (geomIter = geometries.begin(); geomIter != geometries.end(); geomIter++) {
-                                        odb::dbBox* box = *geomIter;
-                                        odb::adsRect rect;
-                                        box->getBox(rect);
-                                        transform.apply(rect);
-                                        
-                                        odb::dbTechLayer* techLayer = box->getTechLayer();
-                                        if (techLayer->getType().getValue() != odb::dbTechLayerType::ROUTING) {
-                                                continue;
-                                        }
-                                        
-                                        pinLayer = techLayer->getRoutingLevel();
-                                        lowerBound = Coordinate(rect.xMin(), 
-                                                                rect.yMin());
-                                        upperBound = Coordinate(rect.xMax(), 
-                                                                rect.yMax());
-                                        pinBox = Box(lowerBound, upperBound, pinLayer);
-                                        pinBoxes[pinLayer].push_back(pinBox);
-                                }
-                                
-                                for(std::map<int, std::vector<Box>>::iterator it = pinBoxes.begin();
-                                    it != pinBoxes.end(); ++it) {
-                                        pinLayers.push_back(it->first);
-                                }
-                                
-                                Coordinate pinPos = Coordinate(pX, pY);
-                                Pin pin = Pin(pinName, pinPos, pinLayers, pinBoxes, netName, false);
-                                netPins.push_back(pin);
-                        }
-                }
+                odb::dbInst* inst = currITerm->getInst();
+                inst->getOrigin(pX, pY);
+                const MASTER_GEOMETRY& geometry = getMasterGeometry(inst);
+                const std::vector<std::vector<Box>>& mTermPins = geometry._pins.at(mTerm);
                 
-                // Iterate through all I/O pins
-                odb::dbSet<odb::dbBTerm> bTerms = currNet->getBTerms();
-                odb::dbSet<odb::dbBTerm>::iterator bIter;
-                
-                for (bIter = bTerms.begin(); bIter != bTerms.end(); bIter++) {
-                        int posX, posY;
-                        odb::dbBTerm* currBTerm = *bIter;
-                        std::string pinName;
-                        
-                        currBTerm->getFirstPinLocation(posX, posY);
-                        
-                        std::vector<int> pinLayers;
-                        std::map<int, std::vector<Box>> pinBoxes;
-                                                
-                        pinName = currBTerm->getConstName();
-                        odb::dbSet<odb::dbBPin> bTermPins = currBTerm->getBPins();
-                        odb::dbSet<odb::dbBPin>::iterator pinIter;
-                        
-                        for (pinIter = bTermPins.begin(); pinIter != bTermPins.end(); pinIter++) {
-                                Coordinate lowerBound;
-                                Coordinate upperBound;
-                                Box pinBox;
-                                int pinLayer;
-                                
-                                odb::dbBPin* currBTermPin = *pinIter;
-                                odb::dbBox* currBTermBox = currBTermPin->getBox();
-                                odb::dbTechLayer* techLayer = currBTermBox->getTechLayer();
-                                if (techLayer->getType().getValue() != odb::dbTechLayerType::ROUTING) {
-                                        continue;
-                                }
-                                
-                                pinLayer = techLayer->getRoutingLevel();
-                                lowerBound = Coordinate(currBTermBox->xMin(), 
-                                                        currBTermBox->yMin());
-                                upperBound = Coordinate(currBTermBox->xMax(), 
-                                                        currBTermBox->yMax());
-                                pinBox = Box(lowerBound, upperBound, pinLayer);
-                                pinBoxes[pinLayer].push_back(pinBox);
+                for (const std::vector<Box>& mPinBoxes : mTermPins) {
+                        for (const Box& box : mPinBoxes) {
+                                pinBoxes[box.getLayer()].push_back(box.translate(pX, pY));
                         }
                         
                         for(std::map<int, std::vector<Box>>::iterator it = pinBoxes.begin();
@@ -451,28 +598,80 @@ void DBWrapper::initNetlist() {
                                 pinLayers.push_back(it->first);
                         }
                         
-                        Coordinate pinPos = Coordinate(posX, posY);
-                        Pin pin = Pin(pinName, pinPos, pinLayers, pinBoxes, netName, true);
-                        netPins.push_back(pin);
+                        Coordinate pinPos = Coordinate(pX, pY);
+                        netPins.push_back(Pin(pinName, pinPos, pinLayers, pinBoxes, netName, false));
                 }
-                _netlist->addNet(netName, signalType, netPins);
+        }
+        
+        // Iterate through all I/O pins
+        odb::dbSet<odb::dbBTerm> bTerms = currNet->getBTerms();
+        odb::dbSet<odb::dbBTerm>::iterator bIter;
+        
+        for (bIter = bTerms.begin(); bIter != bTerms.end(); bIter++) {
+                int posX, posY;
+                odb::dbBTerm* currBTerm = *bIter;
+                std::string pinName;
+                
+                currBTerm->getFirstPinLocation(posX, posY);
+                
+                std::vector<int> pinLayers;
+                std::map<int, std::vector<Box>> pinBoxes;
+                                        
+                pinName = currBTerm->getConstName();
+                odb::dbSet<odb::dbBPin> bTermPins = currBTerm->getBPins();
+                odb::dbSet<odb::dbBPin>::iterator pinIter;
+                
+                for (pinIter = bTermPins.begin(); pinIter != bTermPins.end(); pinIter++) {
+                        Coordinate lowerBound;
+                        Coordinate upperBound;
+                        Box pinBox;
+                        int pinLayer;
+                        
+                        odb::dbBPin* currBTermPin = *pinIter;
+                        odb::dbBox* currBTermBox = currBTermPin->getBox();
+                        odb::dbTechLayer* techLayer = currBTermBox->getTechLayer();
+                        if (techLayer->getType().getValue() != odb::dbTechLayerType::ROUTING) {
+                                continue;
+                        }
+                        
+                        pinLayer = techLayer->getRoutingLevel();
+                        lowerBound = Coordinate(currBTermBox->xMin(), 
+                                                currBTermBox->yMin());
+                        upperBound = Coordinate(currBTermBox->xMax(), 
+                                                currBTermBox->yMax());
+                        pinBox = Box(lowerBound, upperBound, pinLayer);
+                        pinBoxes[pinLayer].push_back(pinBox);
+                }
+                
+                for(std::map<int, std::vector<Box>>::iterator it = pinBoxes.begin();
+                    it != pinBoxes.end(); ++it) {
+                        pinLayers.push_back(it->first);
+                }
+                
+                Coordinate pinPos = Coordinate(posX, posY);
+                netPins.push_back(Pin(pinName, pinPos, std::move(pinLayers), std::move(pinBoxes), netName, true));
         }
 }
 
+// Imports the obstructions that overlap the die area. Obstructions on
+// non-routing layers are skipped, the capacity adjustments ignore them.
 void DBWrapper::initObstacles() {
         // Get routing obstructions
         odb::dbTech* tech = _db->getTech();
         if (!tech) {
                 std::cout << "[ERROR] obd::dbTech not initialized! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
 
         odb::dbBlock* block = _chip->getBlock();
         if (!block) {
                 std::cout << "[ERROR] odb::dbBlock not found! Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
         
+        Box dieArea = Box(_grid->getLowerLeftX(), _grid->getLowerLeftY(),
+                          _grid->getUpperRightX(), _grid->getUpperRightY(), -1);
+        
         odb::dbSet<odb::dbObstruction> obstructions = block->getObstructions();
         
         odb::dbSet<odb::dbObstruction>::iterator obstructIter;
@@ -481,11 +680,16 @@ void DBWrapper::initObstacles() {
                 odb::dbBox* obstructBox = currObstruct->getBBox();
                 
                 int layer = obstructBox->getTechLayer()->getRoutingLevel();
+                if (layer < 1) {
+                        continue;
+                }
                 
                 Coordinate lowerBound = Coordinate(obstructBox->xMin(), obstructBox->yMin());
                 Coordinate upperBound = Coordinate(obstructBox->xMax(), obstructBox->yMax());
                 Box obstacleBox = Box(lowerBound, upperBound, layer);
-                _grid->addObstacle(layer, obstacleBox);
+                if (dieArea.overlap(obstacleBox)) {
+                        _grid->addObstacle(layer, obstacleBox);
+                }
         }
         
         // Get instance obstructions
@@ -497,30 +701,82 @@ void DBWrapper::initObstacles() {
         for (instIter = insts.begin(); instIter != insts.end(); instIter++) {
                 int pX, pY;
                 odb::dbInst* currInst = *instIter;
-                odb::dbMaster* master = currInst->getMaster();
                 
                 currInst->getOrigin(pX, pY);
-                odb::adsPoint origin = odb::adsPoint(pX, pY);
+                const MASTER_GEOMETRY& geometry = getMasterGeometry(currInst);
                 
-                odb::dbTransform transform(currInst->getOrient(), origin);
+                for (const Box& box : geometry._obstructions) {
+                        Box obstacleBox = box.translate(pX, pY);
+                        if (dieArea.overlap(obstacleBox)) {
+                                _grid->addObstacle(obstacleBox.getLayer(), obstacleBox);
+                        }
+                }
+        }
+}
+
+const DBWrapper::MASTER_GEOMETRY& DBWrapper::getMasterGeometry(odb::dbInst* inst) {
+        odb::dbMaster* master = inst->getMaster();
+        odb::dbOrientType orient = inst->getOrient();
+        std::pair<odb::dbMaster*, int> key = std::make_pair(master, (int)orient.getValue());
+        
+        std::map<std::pair<odb::dbMaster*, int>, MASTER_GEOMETRY>::iterator geomIter = _masterGeometries.find(key);
+        if (geomIter != _masterGeometries.end())
+                return geomIter->second;
+        
+        MASTER_GEOMETRY& geometry = _masterGeometries[key];
+        odb::dbTransform transform(orient, odb::adsPoint(0, 0));
+        
+        odb::dbSet<odb::dbMTerm> mTerms = master->getMTerms();
+        odb::dbSet<odb::dbMTerm>::iterator mTermIter;
+        
+        for (mTermIter = mTerms.begin(); mTermIter != mTerms.end(); mTermIter++) {
+                odb::dbMTerm* mTerm = *mTermIter;
+                std::vector<std::vector<Box>>& mTermPins = geometry._pins[mTerm];
                 
-                odb::dbSet<odb::dbBox> obstructions = master->getObstructions();
-                odb::dbSet<odb::dbBox>::iterator boxIter;
+                odb::dbSet<odb::dbMPin> mPins = mTerm->getMPins();
+                odb::dbSet<odb::dbMPin>::iterator pinIter;
                 
-                for (boxIter = obstructions.begin(); boxIter != obstructions.end(); boxIter++) {
-                        odb::dbBox* currBox = *boxIter;
-                        int layer = currBox->getTechLayer()->getRoutingLevel();
+                for (pinIter = mPins.begin(); pinIter != mPins.end(); pinIter++) {
+                        odb::dbMPin* currMTermPin = *pinIter;
+                        odb::dbSet<odb::dbBox> geometries = currMTermPin->getGeometry();
+                        odb::dbSet<odb::dbBox>::iterator boxIter;
                         
-                        odb::adsRect rect;
-                        currBox->getBox(rect);
-                        transform.apply(rect);
-
-                        Coordinate lowerBound = Coordinate(rect.xMin(), rect.yMin());
-                        Coordinate upperBound = Coordinate(rect.xMax(), rect.yMax());
-                        Box obstacleBox = Box(lowerBound, upperBound, layer);
-                        _grid->addObstacle(layer, obstacleBox);
+                        mTermPins.push_back(std::vector<Box>());
+                        for (boxIter = geometries.begin(); boxIter != geometries.end(); boxIter++) {
+                                odb::dbBox* box = *boxIter;
+                                odb::dbTechLayer* techLayer = box->getTechLayer();
+                                if (techLayer->getType().getValue() != odb::dbTechLayerType::ROUTING) {
+                                        continue;
+                                }
+                                
+                                odb::adsRect rect;
+                                box->getBox(rect);
+                                transform.apply(rect);
+                                
+                                int pinLayer = techLayer->getRoutingLevel();
+                                mTermPins.back().push_back(Box(rect.xMin(), rect.yMin(),
+                                                               rect.xMax(), rect.yMax(), pinLayer));
+                        }
+                }
+        }
+        
+        odb::dbSet<odb::dbBox> obstructions = master->getObstructions();
+        odb::dbSet<odb::dbBox>::iterator boxIter;
+        
+        for (boxIter = obstructions.begin(); boxIter != obstructions.end(); boxIter++) {
+                odb::dbBox* currBox = *boxIter;
+                int layer = currBox->getTechLayer()->getRoutingLevel();
+                if (layer < 1) {  // not a routing layer
+                        continue;
                 }
+                
+                odb::adsRect rect;
+                currBox->getBox(rect);
+                transform.apply(rect);
+                
+                geometry._obstructions.push_back(Box(rect.xMin(), rect.yMin(),
+                                                     rect.xMax(), rect.yMax(), layer));
         }
+        
+        return geometry;
 }
-
-}
\ No newline at end of file
@@ -40,6 +40,9 @@
 #define DBWRAPPER_h
 
 #include <string>
+#include <map>
+#include <vector>
+#include <utility>
 #include "Netlist.h"
 #include "Grid.h"
 #include "RoutingLayer.h"
@@ -57,6 +60,10 @@ namespace odb{
 class dbDatabase;
 class dbChip;
 class dbTech;
+class dbInst;
+class dbMaster;
+class dbMTerm;
+class dbNet;
 }
 
 namespace FastRoute {
@@ -68,22 +75,46 @@ public:
 
         void parseLEF(const std::string &filename);
         void parseDEF(const std::string &filename);
+        bool readDB(const std::string &filename, const std::vector<std::string> &inputPaths);
+        void writeDB(const std::string &filename);
         
         void initGrid();
         void initRoutingLayers(std::vector<RoutingLayer>& routingLayers);
         void initRoutingTracks(std::vector<RoutingTracks>& allRoutingTracks);
         void computeCapacities();
         void computeSpacingsAndMinWidth();
-        void initNetlist();
+        void initMasterGeometries();
+        void initNetlist(int numThreads = 1);
         void initObstacles();
 private:
+        // Routing shapes of a master in one orientation, relative to the
+        // instance origin. Instances of the master only translate them.
+        typedef struct {
+                std::map<odb::dbMTerm*, std::vector<std::vector<Box>>> _pins;  // shapes of each MPin of a MTerm
+                std::vector<Box> _obstructions;
+        } MASTER_GEOMETRY;
+        
+        // A LEF or DEF file read into the database, as it was when read.
+        // The key of a saved database is the list of its input files.
+        typedef struct {
+                std::string _path;
+                long long   _size;
+                long long   _mtime;
+        } INPUT_FILE;
+        
+        static bool getInputFile(const std::string &path, INPUT_FILE &input);
+        const MASTER_GEOMETRY& getMasterGeometry(odb::dbInst* inst);
+        void initNetPins(odb::dbNet* currNet, std::vector<Pin>& netPins);
+        
         int selectedMetal = 3;
 
         odb::dbDatabase *_db;
-        odb::dbChip     *_chip;
+        odb::dbChip     *_chip = nullptr;
         Netlist         *_netlist = nullptr;
         Grid            *_grid = nullptr;
         bool            _verbose = false;
+        std::map<std::pair<odb::dbMaster*, int>, MASTER_GEOMETRY> _masterGeometries;
+        std::vector<INPUT_FILE> _inputFiles;
 };
 
 }
@@ -43,8 +43,12 @@
 #include <utility>
 #include <fstream>
 #include <istream>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "FastRouteKernel.h"
+#include "ParallelFor.h"
+#include "TaskGraph.h"
 
 namespace FastRoute {
 
@@ -59,65 +63,21 @@ int FastRouteKernel::run() {
                 _fixLayer = 1;
         }
         
-        std::cout << "Initializing grid...\n";
-        initGrid();
-        std::cout << "Initializing grid... Done!\n";
-        
-        std::cout << "Initializing routing layers...\n";
-        initRoutingLayers();
-        std::cout << "Initializing routing layers... Done!\n";
-        
-        std::cout << "Initializing routing tracks...\n";
-        initRoutingTracks();
-        std::cout << "Initializing routing tracks... Done!\n";
-            
-        std::cout << "Setting capacities...\n";
-        setCapacities();
-        std::cout << "Setting capacities... Done!\n";
-        
-        std::cout << "Setting spacings and widths...\n";
-        setSpacingsAndMinWidths();
-        std::cout << "Setting spacings and widths... Done!\n";
-        
-        std::cout << "Initializing nets...\n";
-        initializeNets();
-        std::cout << "Initializing nets... Done!\n";
-        
-        std::cout << "Adjusting grid...\n";
-        computeGridAdjustments();
-        std::cout << "Adjusting grid... Done!\n";
-        
-        std::cout << "Computing track adjustments...\n";
-        computeTrackAdjustments();
-        std::cout << "Computing track adjustments... Done!\n";
-
-        std::cout << "Computing obstacles adjustments...\n";
-        computeObstaclesAdjustments();
-        std::cout << "Computing obstacles adjustments... Done!\n";
-                
-        std::cout << "Computing user defined global adjustments...\n";
-        computeUserGlobalAdjustments();
-        std::cout << "Computing user defined global adjustments... Done!\n";
-        
-        std::cout << "Computing user defined layers adjustments...\n";
-        computeUserLayerAdjustments();
-        std::cout << "Computing user defined layers adjustments... Done!\n";
-        
-        for (int i = 0; i < regionsReductionPercentage.size(); i++) {
-                if (regionsLayer[i] < 1)
-                        break;
-                
-                std::cout << "Adjusting specific region in layer " << regionsLayer[i] << "...\n";
-                Coordinate lowerLeft = Coordinate(regionsMinX[i], regionsMinY[i]);
-                Coordinate upperRight = Coordinate(regionsMaxX[i], regionsMaxY[i]);
-                computeRegionAdjustments(lowerLeft, upperRight, regionsLayer[i], regionsReductionPercentage[i]);
-        }
+        runInitStages(true);
 
+        _fastRoute.setNumThreads(_numThreads);
+        _fastRoute.setMaxRuntime(_maxRuntime);
+        _fastRoute.setMaxMazeRound(_maxMazeRound);
+        _fastRoute.setOverflowPlateau(_overflowPlateau);
+        _fastRoute.setMultiStart(_numVariants, _variantRounds);
+        _fastRoute.setHilbertNetOrder(_hilbertNetOrder);
+        _fastRoute.setVerificationLevel(_verificationLevel);
         _fastRoute.initAuxVar();
         
         std::cout << "Running FastRoute...\n";
         _fastRoute.run(_result);
         std::cout << "Running FastRoute... Done!\n";
+        printVerification();
         
         writeGuides();
         
@@ -125,60 +85,133 @@ int FastRouteKernel::run() {
 }
 
 void FastRouteKernel::startFastRoute() {
-        std::cout << "Initializing grid...\n";
-        initGrid();
-        std::cout << "Initializing grid... Done!\n";
-        
-        std::cout << "Initializing routing layers...\n";
-        initRoutingLayers();
-        std::cout << "Initializing routing layers... Done!\n";
-        
-        std::cout << "Initializing routing tracks...\n";
-        initRoutingTracks();
-        std::cout << "Initializing routing tracks... Done!\n";
-            
-        std::cout << "Setting capacities...\n";
-        setCapacities();
-        std::cout << "Setting capacities... Done!\n";
-        
-        std::cout << "Setting spacings and widths...\n";
-        setSpacingsAndMinWidths();
-        std::cout << "Setting spacings and widths... Done!\n";
-        
-        std::cout << "Initializing nets...\n";
-        initializeNets();
-        std::cout << "Initializing nets... Done!\n";
+        runInitStages(false);
+
+        _fastRoute.setNumThreads(_numThreads);
+        _fastRoute.setMaxRuntime(_maxRuntime);
+        _fastRoute.setMaxMazeRound(_maxMazeRound);
+        _fastRoute.setOverflowPlateau(_overflowPlateau);
+        _fastRoute.setMultiStart(_numVariants, _variantRounds);
+        _fastRoute.setHilbertNetOrder(_hilbertNetOrder);
+        _fastRoute.setVerificationLevel(_verificationLevel);
+        _fastRoute.initAuxVar();
+}
+
+// The initialization stages run as a task graph on set_num_threads threads.
+// Netlist extraction overlaps with the import of the obstacles and the
+// computation of the track adjustments; the edge capacities are adjusted in
+// the same order as a sequential run once the nets are in FastRoute. The
+// parallel stages split the threads the graph does not use at the time. A
+// stage that fails throws TaskFailure, and the process exits from here once
+// the running stages are done.
+void FastRouteKernel::runInitStages(bool layerAndRegionAdjustments) {
+        TaskGraph stages;
+        CapacityRaster obstaclesRaster(0, 0, 0);
+        std::vector<std::vector<EDGE_SPAN>> trackAdjustments;
+        
+        // FastRoute records its input until initAuxVar
+        if (!_recordingFile.empty()) {
+                _fastRoute.startRecording(_recordingFile.c_str());
+        }
         
-        std::cout << "Adjusting grid...\n";
-        computeGridAdjustments();
-        std::cout << "Adjusting grid... Done!\n";
+        int grid = stages.addTask("Initializing grid", [&]() { initGrid(); });
+        int layers = stages.addTask("Initializing routing layers", [&]() { initRoutingLayers(); }, {grid});
+        int tracks = stages.addTask("Initializing routing tracks", [&]() { initRoutingTracks(); });
+        int capacities = stages.addTask("Setting capacities", [&]() { setCapacities(); }, {grid, layers});
+        int spacings = stages.addTask("Setting spacings and widths", [&]() { setSpacingsAndMinWidths(); }, {capacities});
+        int masters = stages.addTask("Caching master geometries", [&]() { _dbWrapper.initMasterGeometries(); });
+        
+        int obstacles = stages.addTask("Initializing obstacles", [&]() {
+                _dbWrapper.initObstacles();
+                obstaclesRaster = CapacityRaster(_grid.getXGrids(), _grid.getYGrids(), _grid.getNumLayers());
+                computeObstaclesAdjustments(obstaclesRaster);
+        }, {grid, layers, masters});
+        
+        int trackPlan = stages.addParallelTask("Computing track adjustments", [&](int numThreads) {
+                trackAdjustments.resize(_routingLayers.size());
+                parallelFor(_routingLayers.size(), numThreads, [&](int begin, int end) {
+                        for (int i = begin; i < end; i++)
+                                computeTrackAdjustments(_routingLayers[i], trackAdjustments[i]);
+                });
+        }, {grid, layers, tracks});
+        
+        int netlist = stages.addParallelTask("Initializing netlist", [&](int numThreads) {
+                initNetlist(numThreads);
+        }, {masters});
+        int nets = stages.addParallelTask("Initializing nets", [&](int numThreads) {
+                initializeNets(numThreads);
+        }, {netlist, spacings});
+        
+        int adjustment = stages.addTask("Adjusting grid", [&]() { computeGridAdjustments(); }, {nets});
+        adjustment = stages.addTask("Applying track adjustments", [&]() {
+                for (const std::vector<EDGE_SPAN>& spans : trackAdjustments) {
+                        for (const EDGE_SPAN& span : spans) {
+                                _fastRoute.setEdgeCapacities(span._layer, span._horizontal, span._x1, span._y1,
+                                                             span._x2, span._y2, span._cap);
+                        }
+                }
+        }, {adjustment, trackPlan});
+        adjustment = stages.addParallelTask("Computing obstacles adjustments", [&](int numThreads) {
+                // Overlapping obstacles are resolved per edge, one layer per thread
+                obstaclesRaster.apply(_fastRoute, numThreads);
+        }, {adjustment, obstacles});
+        adjustment = stages.addTask("Computing user defined global adjustments", [&]() {
+                computeUserGlobalAdjustments();
+        }, {adjustment});
+        
+        if (layerAndRegionAdjustments) {
+                adjustment = stages.addTask("Computing user defined layers adjustments", [&]() {
+                        computeUserLayerAdjustments();
+                }, {adjustment});
+                stages.addParallelTask("Computing user defined region adjustments", [&](int numThreads) {
+                        CapacityRaster regionsRaster(_grid.getXGrids(), _grid.getYGrids(), _grid.getNumLayers());
+                        for (int i = 0; i < regionsReductionPercentage.size(); i++) {
+                                if (regionsLayer[i] < 1)
+                                        break;
+                                
+                                std::cout << "Adjusting specific region in layer " << regionsLayer[i] << "...\n";
+                                Coordinate lowerLeft = Coordinate(regionsMinX[i], regionsMinY[i]);
+                                Coordinate upperRight = Coordinate(regionsMaxX[i], regionsMaxY[i]);
+                                computeRegionAdjustments(regionsRaster, lowerLeft, upperRight, regionsLayer[i]);
+                        }
+                        regionsRaster.apply(_fastRoute, numThreads);
+                }, {adjustment});
+        }
         
-        std::cout << "Computing track adjustments...\n";
-        computeTrackAdjustments();
-        std::cout << "Computing track adjustments... Done!\n";
-
-        std::cout << "Computing obstacles adjustments...\n";
-        computeObstaclesAdjustments();
-        std::cout << "Computing obstacles adjustments... Done!\n";
-                
-        std::cout << "Computing user defined adjustments...\n";
-        computeUserGlobalAdjustments();
-        std::cout << "Computing user defined adjustments... Done!\n";
-
-        _fastRoute.initAuxVar();
+        try {
+                stages.run(_numThreads);
+        } catch (const TaskFailure& failure) {
+                std::exit(failure.getStatus());
+        }
+        stages.printTimeline();
 }
 
 void FastRouteKernel::runFastRoute() {
         std::cout << "Running FastRoute...\n";
         _fastRoute.run(_result);
         std::cout << "Running FastRoute... Done!\n";
+        printVerification();
+}
+
+// Summary of the checks FastRoute ran on the final routes
+void FastRouteKernel::printVerification() {
+        VERIFICATION verification = _fastRoute.getVerification();
+        if (verification.level == VERIFICATION_NONE)
+                return;
+        
+        std::cout << "Routes: wire length " << verification.length << ", " << verification.numVias
+                  << " vias, overflow " << verification.overflow << "\n";
+        if (verification.level == VERIFICATION_FULL &&
+            (verification.floatingPins > 0 || verification.brokenRoutes > 0)) {
+                std::cout << "[WARNING] " << verification.floatingPins << " floating pins and "
+                          << verification.brokenRoutes << " broken route ends, steps or layers\n";
+        }
 }
 
 void FastRouteKernel::initGrid() {        
         _dbWrapper.initGrid();
         _dbWrapper.computeCapacities();
         _dbWrapper.computeSpacingsAndMinWidth();
-        _dbWrapper.initObstacles();
         
         _fastRoute.setLowerLeft(_grid.getLowerLeftX(), _grid.getLowerLeftY());
         _fastRoute.setTileSize(_grid.getTileWidth(), _grid.getTileHeight());
@@ -214,78 +247,116 @@ void FastRouteKernel::setSpacingsAndMinWidths() {
         }
 }
 
-void FastRouteKernel::initializeNets() {
-        _dbWrapper.initNetlist();
+void FastRouteKernel::initNetlist(int numThreads) {
+        _dbWrapper.initNetlist(numThreads);
         
         std::cout << "----Checking pin placement...\n";
         checkPinPlacement();
         std::cout << "----Checking pin placement... Done!\n";
-        
+}
+
+void FastRouteKernel::initializeNets(int numThreads) {
         int idx = 0;
         _fastRoute.setNumberNets(_netlist.getNetCount());
         _fastRoute.setMaxNetDegree(_netlist.getMaxNetDegree());
         
-        for (Net net : _netlist.getNets()) {
-                if (net.getNumPins() == 1) {
-                        continue;
-                }
-                
-                if (_clockNetRouting && net.getSignalType() != "CLOCK") {
-                        continue;
-                }
-                
-                _netsDegree[net.getName()] = net.getNumPins();
+        const std::vector<Net>& nets = _netlist.getNets();
+        const int netsPerChunk = 4096;
+        std::vector<std::vector<FastRoute::PIN>> netPins(std::min((int)nets.size(), netsPerChunk));
+        std::vector<char> missingBoxes(netPins.size());
+        const std::vector<Box> noBoxes;
+        
+        // Pin positions on the grid are computed by the threads one chunk of
+        // nets at a time, the nets of the chunk are then added to FastRoute in
+        // the order of the netlist
+        for (int chunkBegin = 0; chunkBegin < nets.size(); chunkBegin += netsPerChunk) {
+                int chunkSize = std::min((int)nets.size() - chunkBegin, netsPerChunk);
                 
-                std::vector<FastRoute::PIN> pins;
-                for (Pin pin : net.getPins()) {
-                        Coordinate pinPosition;
-                        int topLayer = pin.getTopLayer();
-                        
-                        std::vector<Box> pinBoxes = pin.getBoxes()[topLayer];
-                        std::vector<Coordinate> pinPositionsOnGrid;
-                        Coordinate posOnGrid;
+                parallelFor(chunkSize, numThreads, [&](int begin, int end) {
+                        for (int i = begin; i < end; i++) {
+                                const Net& net = nets[chunkBegin + i];
+                                netPins[i].clear();
+                                missingBoxes[i] = false;
+                                if (net.getNumPins() == 1 ||
+                                    (_clockNetRouting && net.getSignalType() != "CLOCK")) {
+                                        continue;
+                                }
                                 
-                        for (Box pinBox : pinBoxes) {
-                                posOnGrid = _grid.getPositionOnGrid(pinBox.getMiddle());
-                                pinPositionsOnGrid.push_back(posOnGrid);
+                                netPins[i].reserve(net.getNumPins());
+                                for (const Pin& pin : net.getPins()) {
+                                        int topLayer = pin.getTopLayer();
+                                        std::map<int, std::vector<Box>>::const_iterator boxes =
+                                                pin.getBoxes().find(topLayer);
+                                        if (boxes == pin.getBoxes().end())
+                                                missingBoxes[i] = true;
+                                        
+                                        Coordinate pinPosition = getPinPositionOnGrid(
+                                                boxes != pin.getBoxes().end() ? boxes->second : noBoxes);
+                                        
+                                        FastRoute::PIN grPin;
+                                        grPin.x = pinPosition.getX();
+                                        grPin.y = pinPosition.getY();
+                                        grPin.layer = topLayer;
+                                        netPins[i].push_back(grPin);
+                                }
+                        }
+                });
+                
+                for (int i = 0; i < chunkSize; i++) {
+                        const Net& net = nets[chunkBegin + i];
+                        if (net.getNumPins() == 1) {
+                                continue;
                         }
                         
-                        int votes = -1;
+                        if (_clockNetRouting && net.getSignalType() != "CLOCK") {
+                                continue;
+                        }
                         
-                        for (Coordinate pos : pinPositionsOnGrid) {
-                                int equals = std::count(pinPositionsOnGrid.begin(),
-                                                        pinPositionsOnGrid.end(),
-                                                        pos);
-                                if (equals > votes) {
-                                        pinPosition = pos;
-                                        votes = equals;
+                        if (missingBoxes[i]) {
+                                for (const Pin& pin : net.getPins()) {
+                                        if (pin.getBoxes().count(pin.getTopLayer()) == 0) {
+                                                std::cout << "[WARNING] Pin " << pin.getName() << " of net "
+                                                          << net.getName() << " has no shapes on layer "
+                                                          << pin.getTopLayer() << "\n";
+                                        }
                                 }
                         }
                         
-                        FastRoute::PIN grPin;
-                        grPin.x = pinPosition.getX();
-                        grPin.y = pinPosition.getY();
-                        grPin.layer = topLayer;
-                        pins.push_back(grPin);
-                }
-                
-                FastRoute::PIN grPins[pins.size()];
-                char netName[net.getName().size() + 1];
-                strcpy(netName, net.getName().c_str());
-                int count = 0;
-                
-                for (FastRoute::PIN pin : pins) {
-                        grPins[count] = pin;
-                        count ++;
+                        _netsDegree[net.getName()] = net.getNumPins();
+                        
+                        _fastRoute.addNet(net.getName().c_str(), idx, 1, std::move(netPins[i]));
+                        idx++;
                 }
-                
-                _fastRoute.addNet(netName, idx, pins.size(), 1, grPins);
-                idx++;
         }
 
         _fastRoute.initEdges();
 }
 
+// The position of a pin is the gcell holding the most of its boxes, the first
+// one found wins ties
+Coordinate FastRouteKernel::getPinPositionOnGrid(const std::vector<Box>& pinBoxes) {
+        std::vector<Coordinate> pinPositionsOnGrid;
+        std::unordered_map<DBU, std::unordered_map<DBU, int>> votes;
+        Coordinate pinPosition;
+        int maxVotes = -1;
+        
+        for (const Box& pinBox : pinBoxes) {
+                Coordinate posOnGrid = _grid.getPositionOnGrid(pinBox.getMiddle());
+                pinPositionsOnGrid.push_back(posOnGrid);
+                votes[posOnGrid.getX()][posOnGrid.getY()]++;
+        }
+        
+        for (const Coordinate& pos : pinPositionsOnGrid) {
+                int equals = votes[pos.getX()][pos.getY()];
+                if (equals > maxVotes) {
+                        pinPosition = pos;
+                        maxVotes = equals;
+                }
+        }
+        
+        return pinPosition;
+}
+
 void FastRouteKernel::computeGridAdjustments() {
         Coordinate upperDieBounds = Coordinate(_grid.getUpperRightX(),
                                                _grid.getUpperRightY());
@@ -319,166 +390,102 @@ void FastRouteKernel::computeGridAdjustments() {
                         newVCapacity = std::floor((_grid.getTileWidth() + xExtra)/vSpace);
                 } else {
                     std::cout << "[ERROR] Layer spacing not found. Exiting...\n";
-                    std::exit(1);
+                    throw TaskFailure(1);
                 }
                 
-                int numAdjustments = 0;
-                for (int i = 1; i < yGrids; i++)
-                        numAdjustments++;
-                for (int i = 1; i < xGrids; i++)
-                        numAdjustments++;
-                _fastRoute.setNumAdjustments(numAdjustments);
-
-                if (!_grid.isPerfectRegularX()) {
-                        for (int i = 1; i < yGrids; i++) {
-                                _fastRoute.addAdjustment(xGrids - 1, i - 1, layer, xGrids - 1, i, layer, newVCapacity, false);
-                        }
+                if (!_grid.isPerfectRegularX()) {  // last column of vertical edges
+                        _fastRoute.setEdgeCapacities(layer, false, xGrids - 1, 0, xGrids - 1, yGrids - 2, newVCapacity, false);
                 }
-                if (!_grid.isPerfectRegularY()) {
-                        for (int i = 1; i < xGrids; i++) {
-                                _fastRoute.addAdjustment(i - 1, yGrids - 1, layer, i, yGrids - 1, layer, newHCapacity, false);
-                        }
+                if (!_grid.isPerfectRegularY()) {  // last row of horizontal edges
+                        _fastRoute.setEdgeCapacities(layer, true, 0, yGrids - 1, xGrids - 2, yGrids - 1, newHCapacity, false);
                 }
         }
 }
 
-void FastRouteKernel::computeTrackAdjustments() {
+// Edges before the first and after the last routing track of a layer lose
+// the tracks they do not have. The adjustments are returned as spans of
+// edges so the layers can be computed independently.
+void FastRouteKernel::computeTrackAdjustments(const RoutingLayer& layer, std::vector<EDGE_SPAN>& spans) {
         Coordinate upperDieBounds = Coordinate(_grid.getUpperRightX(),
                                                _grid.getUpperRightY());
-        for (RoutingLayer layer : _routingLayers) {
-                DBU trackLocation;
-                int numInitAdjustments = 0;
-                int numFinalAdjustments = 0;
-                DBU trackSpace;
-                int numTracks = 0;
+        DBU trackLocation;
+        DBU trackSpace;
+        int numTracks = 0;
+        
+        if (layer.getIndex() < _minRoutingLayer ||
+            (layer.getIndex() > _maxRoutingLayer && _maxRoutingLayer > 0))
+                return;
+        
+        if (layer.getPreferredDirection() == RoutingLayer::HORIZONTAL) {
+                RoutingTracks routingTracks = getRoutingTracksByIndex(layer.getIndex());
+                trackLocation = routingTracks.getLocation();
+                trackSpace = routingTracks.getSpace();
+                numTracks = routingTracks.getNumTracks();
                 
-                if (layer.getIndex() < _minRoutingLayer ||
-                    (layer.getIndex() > _maxRoutingLayer && _maxRoutingLayer > 0))
-                        continue;
+                if (numTracks > 0) {
+                        DBU finalTrackLocation = trackLocation + (trackSpace * (numTracks-1));
+                        DBU remainingFinalSpace = upperDieBounds.getY() - finalTrackLocation;
+                        DBU extraSpace = upperDieBounds.getY() - (_grid.getTileHeight() * _grid.getYGrids());
+                        
+                        int y = 0;
+                        while (trackLocation >= _grid.getTileHeight()){
+                                spans.push_back({layer.getIndex(), true, 0, y, _grid.getXGrids() - 2, y, 0});
+                                y++;
+                                trackLocation -= _grid.getTileHeight();
+                        }
+                        if (trackLocation > 0){
+                                DBU remainingTile = _grid.getTileHeight() - trackLocation;
+                                int newCapacity = std::floor((float)remainingTile/trackSpace);
+                                spans.push_back({layer.getIndex(), true, 0, y, _grid.getXGrids() - 2, y, newCapacity});
+                        }
+                        
+                        y = _grid.getYGrids() - 1;
+                        while (remainingFinalSpace >= _grid.getTileHeight() + extraSpace){
+                                spans.push_back({layer.getIndex(), true, 0, y, _grid.getXGrids() - 2, y, 0});
+                                y--;
+                                remainingFinalSpace -= (_grid.getTileHeight() + extraSpace);
+                                extraSpace = 0;
+                        }
+                        if (remainingFinalSpace > 0){
+                                DBU remainingTile = (_grid.getTileHeight() + extraSpace) - remainingFinalSpace;
+                                int newCapacity = std::floor((float)remainingTile/trackSpace);
+                                spans.push_back({layer.getIndex(), true, 0, y, _grid.getXGrids() - 2, y, newCapacity});
+                        }
+                }
+        } else {
+                RoutingTracks routingTracks = getRoutingTracksByIndex(layer.getIndex());
+                trackLocation = routingTracks.getLocation();
+                trackSpace = routingTracks.getSpace();
+                numTracks = routingTracks.getNumTracks();
                 
-                if (layer.getPreferredDirection() == RoutingLayer::HORIZONTAL) {
-                        RoutingTracks routingTracks = getRoutingTracksByIndex(layer.getIndex());
-                        trackLocation = routingTracks.getLocation();
-                        trackSpace = routingTracks.getSpace();
-                        numTracks = routingTracks.getNumTracks();
+                if (numTracks > 0) {
+                        DBU finalTrackLocation = trackLocation + (trackSpace * (numTracks-1));
+                        DBU remainingFinalSpace = upperDieBounds.getX() - finalTrackLocation;
+                        DBU extraSpace = upperDieBounds.getX() - (_grid.getTileWidth() * _grid.getXGrids());
                         
-                        if (numTracks > 0) {
-                                DBU finalTrackLocation = trackLocation + (trackSpace * (numTracks-1));
-                                DBU remainingFinalSpace = upperDieBounds.getY() - finalTrackLocation;
-                                DBU extraSpace = upperDieBounds.getY() - (_grid.getTileHeight() * _grid.getYGrids());
-                                if (_grid.isPerfectRegularY()) {
-                                        numFinalAdjustments = std::ceil((float)remainingFinalSpace/_grid.getTileHeight());
-                                } else {
-                                        if (remainingFinalSpace != 0){
-                                                DBU finalSpace = remainingFinalSpace - extraSpace;
-                                                if (finalSpace <= 0)
-                                                        numFinalAdjustments = 1;
-                                                else
-                                                        numFinalAdjustments = std::ceil((float)finalSpace/_grid.getTileHeight());
-                                        }
-                                        else
-                                                numFinalAdjustments = 0;
-                                }
-                                
-                                numFinalAdjustments *= _grid.getXGrids();
-                                numInitAdjustments = std::ceil((float)trackLocation/_grid.getTileHeight());
-                                numInitAdjustments *= _grid.getXGrids();
-                                _fastRoute.setNumAdjustments(numInitAdjustments + numFinalAdjustments);
-                                
-                                int y = 0;
-                                while (trackLocation >= _grid.getTileHeight()){
-                                        for (int x = 1; x < _grid.getXGrids(); x++){
-                                                _fastRoute.addAdjustment(x - 1, y, layer.getIndex(), x, y, layer.getIndex(), 0);
-                                        }
-                                        y++;
-                                        trackLocation -= _grid.getTileHeight();
-                                }
-                                if (trackLocation > 0){
-                                        DBU remainingTile = _grid.getTileHeight() - trackLocation;
-                                        int newCapacity = std::floor((float)remainingTile/trackSpace);
-                                        for (int x = 1; x < _grid.getXGrids(); x++){
-                                                _fastRoute.addAdjustment(x - 1, y, layer.getIndex(), x, y, layer.getIndex(), newCapacity);
-                                        }
-                                }
-                                
-                                y = _grid.getYGrids() - 1;
-                                while (remainingFinalSpace >= _grid.getTileHeight() + extraSpace){
-                                        for (int x = 1; x < _grid.getXGrids(); x++){
-                                                _fastRoute.addAdjustment(x - 1, y, layer.getIndex(), x, y, layer.getIndex(), 0);
-                                        }
-                                        y--;
-                                        remainingFinalSpace -= (_grid.getTileHeight() + extraSpace);
-                                        extraSpace = 0;
-                                }
-                                if (remainingFinalSpace > 0){
-                                        DBU remainingTile = (_grid.getTileHeight() + extraSpace) - remainingFinalSpace;
-                                        int newCapacity = std::floor((float)remainingTile/trackSpace);
-                                        for (int x = 1; x < _grid.getXGrids(); x++){
-                                                _fastRoute.addAdjustment(x - 1, y, layer.getIndex(), x, y, layer.getIndex(), newCapacity);
-                                        }
-                                }
+                        int x = 0;
+                        while (trackLocation >= _grid.getTileWidth()){
+                                spans.push_back({layer.getIndex(), false, x, 0, x, _grid.getYGrids() - 2, 0});
+                                x++;
+                                trackLocation -= _grid.getTileWidth();
+                        }
+                        if (trackLocation > 0){
+                                DBU remainingTile = _grid.getTileWidth() - trackLocation;
+                                int newCapacity = std::floor((float)remainingTile/trackSpace);
+                                spans.push_back({layer.getIndex(), false, x, 0, x, _grid.getYGrids() - 2, newCapacity});
                         }
-                } else {
-                        RoutingTracks routingTracks = getRoutingTracksByIndex(layer.getIndex());
-                        trackLocation = routingTracks.getLocation();
-                        trackSpace = routingTracks.getSpace();
-                        numTracks = routingTracks.getNumTracks();
                         
-                        if (numTracks > 0) {
-                                DBU finalTrackLocation = trackLocation + (trackSpace * (numTracks-1));
-                                DBU remainingFinalSpace = upperDieBounds.getX() - finalTrackLocation;
-                                DBU extraSpace = upperDieBounds.getX() - (_grid.getTileWidth() * _grid.getXGrids());
-                                if (_grid.isPerfectRegularX()) {
-                                        numFinalAdjustments = std::ceil((float)remainingFinalSpace/_grid.getTileWidth());
-                                } else {
-                                        if (remainingFinalSpace != 0){
-                                                DBU finalSpace = remainingFinalSpace - extraSpace;
-                                                if (finalSpace <= 0)
-                                                        numFinalAdjustments = 1;
-                                                else
-                                                        numFinalAdjustments = std::ceil((float)finalSpace/_grid.getTileWidth());
-                                        }
-                                        else
-                                                numFinalAdjustments = 0;
-                                }
-                                
-                                numFinalAdjustments *= _grid.getYGrids();
-                                numInitAdjustments = std::ceil((float)trackLocation/_grid.getTileWidth());
-                                numInitAdjustments *= _grid.getYGrids();
-                                _fastRoute.setNumAdjustments(numInitAdjustments + numFinalAdjustments);
-                                
-                                int x = 0;
-                                while (trackLocation >= _grid.getTileWidth()){
-                                        for (int y = 1; y < _grid.getYGrids(); y++){
-                                                _fastRoute.addAdjustment(x, y - 1, layer.getIndex(), x, y, layer.getIndex(), 0);
-                                        }
-                                        x++;
-                                        trackLocation -= _grid.getTileWidth();
-                                }
-                                if (trackLocation > 0){
-                                        DBU remainingTile = _grid.getTileWidth() - trackLocation;
-                                        int newCapacity = std::floor((float)remainingTile/trackSpace);
-                                        for (int y = 1; y < _grid.getYGrids(); y++) {
-                                                _fastRoute.addAdjustment(x, y - 1, layer.getIndex(), x, y, layer.getIndex(), newCapacity);
-                                        }
-                                }
-                                
-                                x = _grid.getXGrids() - 1;
-                                while (remainingFinalSpace >= _grid.getTileWidth() + extraSpace){
-                                        for (int y = 1; y < _grid.getYGrids(); y++){
-                                                _fastRoute.addAdjustment(x, y - 1, layer.getIndex(), x, y, layer.getIndex(), 0);
-                                        }
-                                        x--;
-                                        remainingFinalSpace -= (_grid.getTileWidth() + extraSpace);
-                                        extraSpace = 0;
-                                }
-                                if (remainingFinalSpace > 0){
-                                        DBU remainingTile = (_grid.getTileWidth() + extraSpace) - remainingFinalSpace;
-                                        int newCapacity = std::floor((float)remainingTile/trackSpace);
-                                        for (int y = 1; y < _grid.getYGrids(); y++){
-                                                _fastRoute.addAdjustment(x, y - 1, layer.getIndex(), x, y, layer.getIndex(), newCapacity);
-                                        }
-                                }
+                        x = _grid.getXGrids() - 1;
+                        while (remainingFinalSpace >= _grid.getTileWidth() + extraSpace){
+                                spans.push_back({layer.getIndex(), false, x, 0, x, _grid.getYGrids() - 2, 0});
+                                x--;
+                                remainingFinalSpace -= (_grid.getTileWidth() + extraSpace);
+                                extraSpace = 0;
+                        }
+                        if (remainingFinalSpace > 0){
+                                DBU remainingTile = (_grid.getTileWidth() + extraSpace) - remainingFinalSpace;
+                                int newCapacity = std::floor((float)remainingTile/trackSpace);
+                                spans.push_back({layer.getIndex(), false, x, 0, x, _grid.getYGrids() - 2, newCapacity});
                         }
                 }
         }
@@ -490,39 +497,15 @@ void FastRouteKernel::computeUserGlobalAdjustments() {
 
         int xGrids = _grid.getXGrids();
         int yGrids = _grid.getYGrids();
-        
-        int numAdjustments = 0;
-
-        for (int layer = 1; layer <= _grid.getNumLayers(); layer++) {
-                for (int y = 0; y < yGrids; y++) {
-                        for (int x = 0; x < xGrids; x++) {
-                                numAdjustments++;
-                        }
-                }
-        }
-
-        numAdjustments *= 2;
-        _fastRoute.setNumAdjustments(numAdjustments);
 
+        // The edges of the last row and column keep their capacity
         for (int layer = 1; layer <= _grid.getNumLayers(); layer++) {
                 if (_hCapacities[layer - 1] != 0) {
-                        for (int y = 1; y < yGrids; y++) {
-                                for (int x = 1; x < xGrids; x++) {
-                                        int edgeCap = _fastRoute.getEdgeCapacity(x - 1, y - 1, layer, x, y - 1, layer);
-                                        int newHCapacity = std::floor((float)edgeCap * (1 - _adjustment));
-                                        _fastRoute.addAdjustment(x - 1, y - 1, layer, x, y - 1, layer, newHCapacity);
-                                }
-                        }
+                        _fastRoute.scaleEdgeCapacities(layer, true, 0, 0, xGrids - 2, yGrids - 2, 1 - _adjustment);
                 }
 
                 if (_vCapacities[layer - 1] != 0) {
-                        for (int x = 1; x < xGrids; x++) {
-                                for (int y = 1; y < yGrids; y++) {
-                                        int edgeCap = _fastRoute.getEdgeCapacity(x - 1, y - 1, layer, x - 1, y, layer);
-                                        int newVCapacity = std::floor((float)edgeCap * (1 - _adjustment));
-                                        _fastRoute.addAdjustment(x - 1, y - 1, layer, x - 1, y, layer, newVCapacity);
-                                }
-                        }
+                        _fastRoute.scaleEdgeCapacities(layer, false, 0, 0, xGrids - 2, yGrids - 2, 1 - _adjustment);
                 }
         }
 }
@@ -530,47 +513,22 @@ void FastRouteKernel::computeUserGlobalAdjustments() {
 void FastRouteKernel::computeUserLayerAdjustments() {
         int xGrids = _grid.getXGrids();
         int yGrids = _grid.getYGrids();
-        
-        int numAdjustments = 0;
-
-        for (int layer = 0; layer < _layersToAdjust.size(); layer++) {
-                for (int y = 0; y < yGrids; y++) {
-                        for (int x = 0; x < xGrids; x++) {
-                                numAdjustments++;
-                        }
-                }
-        }
-
-        numAdjustments *= 2;
-        _fastRoute.setNumAdjustments(numAdjustments);
 
         for (int idx = 0; idx < _layersToAdjust.size(); idx++) {
                 int layer = _layersToAdjust[idx];
                 float adjustment = _layersReductionPercentage[idx];
                 if (_hCapacities[layer - 1] != 0) {
-                        for (int y = 1; y < yGrids; y++) {
-                                for (int x = 1; x < xGrids; x++) {
-                                        int edgeCap = _fastRoute.getEdgeCapacity(x - 1, y - 1, layer, x, y - 1, layer);
-                                        int newHCapacity = std::floor((float)edgeCap * (1 - adjustment));
-                                        _fastRoute.addAdjustment(x - 1, y - 1, layer, x, y - 1, layer, newHCapacity);
-                                }
-                        }
+                        _fastRoute.scaleEdgeCapacities(layer, true, 0, 0, xGrids - 2, yGrids - 2, 1 - adjustment);
                 }
 
                 if (_vCapacities[layer - 1] != 0) {
-                        for (int x = 1; x < xGrids; x++) {
-                                for (int y = 1; y < yGrids; y++) {
-                                        int edgeCap = _fastRoute.getEdgeCapacity(x - 1, y - 1, layer, x - 1, y, layer);
-                                        int newVCapacity = std::floor((float)edgeCap * (1 - adjustment));
-                                        _fastRoute.addAdjustment(x - 1, y - 1, layer, x - 1, y, layer, newVCapacity);
-                                }
-                        }
+                        _fastRoute.scaleEdgeCapacities(layer, false, 0, 0, xGrids - 2, yGrids - 2, 1 - adjustment);
                 }
         }
 }
 
-void FastRouteKernel::computeRegionAdjustments(Coordinate lowerBound, Coordinate upperBound,
-                                               int layer, float reductionPercentage) {
+void FastRouteKernel::computeRegionAdjustments(CapacityRaster &raster, Coordinate lowerBound,
+                                               Coordinate upperBound, int layer) {
         Box firstTileBox;
         Box lastTileBox;
         std::pair<Grid::TILE, Grid::TILE> tilesToAdjust;
@@ -583,7 +541,7 @@ void FastRouteKernel::computeRegionAdjustments(Coordinate lowerBound, Coordinate
                 std::cout << "ERROR: informed region is outside die area!\n";
                 std::cout << "Informed region: (" << lowerBound.getX() << ", " << lowerBound.getY() << "); ("
                           << upperBound.getX() << ", " << upperBound.getY() << ")\n";
-                std::exit(-1);
+                throw TaskFailure(-1);
         }
         
         RoutingLayer routingLayer = getRoutingLayerByIndex(layer);
@@ -601,59 +559,21 @@ void FastRouteKernel::computeRegionAdjustments(Coordinate lowerBound, Coordinate
 
         int lastTileReduce = _grid.computeTileReduce(regionToAdjust, lastTileBox, trackSpace, false, direction);
         
-        if (direction == RoutingLayer::HORIZONTAL) {                                          // If preferred direction is horizontal, only first and the last line will have specific adjustments
-                for (int x = firstTile._x; x <= lastTile._x; x++) {  // Setting capacities of edges completely inside the adjust region according the percentage of reduction
-                        for (int y = firstTile._y; y <= lastTile._y; y++) {
-                                int edgeCap = _fastRoute.getEdgeCapacity(x, y, layer, x + 1, y, layer);
-                                
-                                if (y == firstTile._y) {
-                                        edgeCap -= firstTileReduce;
-                                        if (edgeCap < 0)
-                                                edgeCap = 0;
-                                        _fastRoute.addAdjustment(x, y, layer, x + 1, y, layer, edgeCap);
-                                } else if (y == lastTile._y) {
-                                        edgeCap -= lastTileReduce;
-                                        if (edgeCap < 0)
-                                                edgeCap = 0;
-                                        _fastRoute.addAdjustment(x, y, layer, x + 1, y, layer, edgeCap);
-                                } else {
-                                        edgeCap -= edgeCap*reductionPercentage;
-                                        _fastRoute.addAdjustment(x, y, layer, x + 1, y, layer, 0);
-                                }
-                        }
-                }
-        } else {                                                   // If preferred direction is vertical, only first and last columns will have specific adjustments
-                for (int x = firstTile._x; x <= lastTile._x; x++) {  // Setting capacities of edges completely inside the adjust region according the percentage of reduction
-                        for (int y = firstTile._y; y <= lastTile._y; y++) {
-                                int edgeCap = _fastRoute.getEdgeCapacity(x, y, layer, x, y + 1, layer);
-                                
-                                if (x == firstTile._x) {
-                                        edgeCap -= firstTileReduce;
-                                        if (edgeCap < 0)
-                                                edgeCap = 0;
-                                        _fastRoute.addAdjustment(x, y, layer, x, y + 1, layer, edgeCap);
-                                } else if (x == lastTile._x) {
-                                        edgeCap -= lastTileReduce;
-                                        if (edgeCap < 0)
-                                                edgeCap = 0;
-                                        _fastRoute.addAdjustment(x, y, layer, x, y + 1, layer, edgeCap);
-                                } else {
-                                        edgeCap -= edgeCap*reductionPercentage;
-                                        _fastRoute.addAdjustment(x, y, layer, x, y + 1, layer, 0);
-                                }
-                        }
-                }
-        }
+        // Edges completely inside the region are blocked, the first and last
+        // lines in the preferred direction lose the tracks the region covers
+        raster.addBlockage(layer, direction, firstTile, lastTile, firstTileReduce, lastTileReduce);
 }
 
-void FastRouteKernel::computeObstaclesAdjustments() {
-        std::map<int, std::vector<Box>> obstacles = _grid.getAllObstacles();
+void FastRouteKernel::computeObstaclesAdjustments(CapacityRaster &raster) {
+        const std::map<int, std::vector<Box>>& obstacles = _grid.getAllObstacles();
         
         for (int layer = 1; layer <= _grid.getNumLayers(); layer++) {
-                std::vector<Box> layerObstacles = obstacles[layer];
-                if (layerObstacles.size() == 0)
+                std::map<int, std::vector<Box>>::const_iterator layerIter = obstacles.find(layer);
+                if (layerIter == obstacles.end() || layerIter->second.size() == 0)
                     continue;
                 
+                const std::vector<Box> &layerObstacles = layerIter->second;
+                
                 RoutingLayer routingLayer = getRoutingLayerByIndex(layer);
                 
                 std::pair<Grid::TILE, Grid::TILE> blockedTiles;
@@ -665,7 +585,7 @@ void FastRouteKernel::computeObstaclesAdjustments() {
                 
                 int trackSpace = _grid.getMinWidths()[layer-1];
                 
-                for (Box& obs : layerObstacles) {
+                for (const Box& obs : layerObstacles) {
                         Box firstTileBox;
                         Box lastTileBox;
                         
@@ -683,47 +603,7 @@ void FastRouteKernel::computeObstaclesAdjustments() {
 
                         int lastTileReduce = _grid.computeTileReduce(obs, lastTileBox, trackSpace, false, direction);
                         
-                        if (direction == RoutingLayer::HORIZONTAL) {
-                                for (int x = firstTile._x; x <= lastTile._x; x++) {  // Setting capacities of completely blocked edges to zero
-                                        for (int y = firstTile._y; y <= lastTile._y; y++) {
-                                                if (y == firstTile._y) {
-                                                        int edgeCap = _fastRoute.getEdgeCapacity(x, y, layer, x + 1, y, layer);
-                                                        edgeCap -= firstTileReduce;
-                                                        if (edgeCap < 0)
-                                                                edgeCap = 0;
-                                                        _fastRoute.addAdjustment(x, y, layer, x + 1, y, layer, edgeCap);
-                                                } else if (y == lastTile._y) {
-                                                        int edgeCap = _fastRoute.getEdgeCapacity(x, y, layer, x + 1, y, layer);
-                                                        edgeCap -= lastTileReduce;
-                                                        if (edgeCap < 0)
-                                                                edgeCap = 0;
-                                                        _fastRoute.addAdjustment(x, y, layer, x + 1, y, layer, edgeCap);
-                                                } else {
-                                                        _fastRoute.addAdjustment(x, y, layer, x + 1, y, layer, 0);
-                                                }
-                                        }
-                                }
-                        } else {
-                                for (int x = firstTile._x; x <= lastTile._x; x++) {  // Setting capacities of completely blocked edges to zero
-                                        for (int y = firstTile._y; y <= lastTile._y; y++) {
-                                                if (x == firstTile._x) {
-                                                        int edgeCap = _fastRoute.getEdgeCapacity(x, y, layer, x, y + 1, layer);
-                                                        edgeCap -= firstTileReduce;
-                                                        if (edgeCap < 0)
-                                                                edgeCap = 0;
-                                                        _fastRoute.addAdjustment(x, y, layer, x, y + 1, layer, edgeCap);
-                                                } else if (x == lastTile._x) {
-                                                        int edgeCap = _fastRoute.getEdgeCapacity(x, y, layer, x, y + 1, layer);
-                                                        edgeCap -= lastTileReduce;
-                                                        if (edgeCap < 0)
-                                                                edgeCap = 0;
-                                                        _fastRoute.addAdjustment(x, y, layer, x, y + 1, layer, edgeCap);
-                                                } else {
-                                                        _fastRoute.addAdjustment(x, y, layer, x, y + 1, layer, 0);
-                                                }
-                                        }
-                                }
-                        }
+                        raster.addBlockage(layer, direction, firstTile, lastTile, firstTileReduce, lastTileReduce);
                 }
         }
 }
@@ -1015,36 +895,51 @@ Box FastRouteKernel::globalRoutingToBox(const FastRoute::ROUTE &route) {
         return routeBds;
 }
 
+// Position of a port, two ports of a layer can not share one
+struct PortPosition {
+        DBU _layer;
+        DBU _x;
+        DBU _y;
+        
+        bool operator==(const PortPosition& other) const {
+                return _layer == other._layer && _x == other._x && _y == other._y;
+        }
+};
+
+struct PortPositionHash {
+        std::size_t operator()(const PortPosition& pos) const {
+                std::size_t hash = std::hash<DBU>()(pos._x);
+                hash ^= std::hash<DBU>()(pos._y) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+                hash ^= std::hash<DBU>()(pos._layer) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+                return hash;
+        }
+};
+
 void FastRouteKernel::checkPinPlacement() {
         bool invalid = false;
-        std::map<int, std::vector<Coordinate>> mapLayerToPositions;
+        std::unordered_set<PortPosition, PortPositionHash> usedPositions;
         
-        for (Pin port : _netlist.getAllPorts()) {
+        for (int p = 0; p < _netlist.getNumPorts(); p++) {
+                const Pin& port = _netlist.getPort(p);
                 if (port.getNumLayers() == 0) {
                         std::cout << "ERROR: pin " << port.getName() << " does "
                             "not have layer assignment\n";
-                        exit(1);
+                        throw TaskFailure(1);
                 }
                 DBU layer = port.getLayers()[0]; // port have only one layer
+                Coordinate pos = port.getPosition();
                 
-                if (mapLayerToPositions[layer].size() == 0) {
-                        mapLayerToPositions[layer].push_back(port.getPosition());
-                        continue;
-                }
-                
-                for (Coordinate pos : mapLayerToPositions[layer]) {
-                        if (pos == port.getPosition()) {
-                                std::cout << "ERROR: at least 2 pins in position ("
-                                          << pos.getX() << ", " << pos.getY()
-                                          << "), layer " << layer+1 << "\n";
-                                invalid = true;
-                        }
+                PortPosition portPosition = {layer, pos.getX(), pos.getY()};
+                if (!usedPositions.insert(portPosition).second) {
+                        std::cout << "ERROR: at least 2 pins in position ("
+                                  << pos.getX() << ", " << pos.getY()
+                                  << "), layer " << layer+1 << "\n";
+                        invalid = true;
                 }
-                mapLayerToPositions[layer].push_back(port.getPosition());
         }
         
         if (invalid) {
-                std::exit(-1);
+                throw TaskFailure(-1);
         }
 }
 
@@ -49,6 +49,7 @@
 
 #include "Coordinate.h"
 #include "Box.h"
+#include "CapacityRaster.h"
 #include "DBWrapper.h"
 #include "Grid.h"
 #include "Netlist.h"
@@ -69,6 +70,7 @@ private:
 	DBWrapper _dbWrapper;
         FT _fastRoute;
         std::string _outfile = "output.guide";
+        std::string _recordingFile;
         float _adjustment = 0.0;
         int _minRoutingLayer = 1;
         int _maxRoutingLayer = -1;
@@ -76,6 +78,14 @@ private:
         int _fixLayer;
         bool _interactiveMode;
         bool _clockNetRouting;
+        int _numThreads = 1;
+        float _maxRuntime = 0.0;
+        int _maxMazeRound = 500;
+        int _overflowPlateau = 0;
+        int _numVariants = 1;
+        int _variantRounds = 5;
+        bool _hilbertNetOrder = false;
+        int _verificationLevel = VERIFICATION_FULL;
         
         // Layer adjustment variables
         std::vector<int> _layersToAdjust;
@@ -94,19 +104,33 @@ private:
         std::vector<FastRoute::NET> _result;
         std::map<std::string, int> _netsDegree;
 
+        // Capacity of a range of edges of a layer, see FT::setEdgeCapacities
+        typedef struct {
+                int _layer;
+                bool _horizontal;
+                int _x1;
+                int _y1;
+                int _x2;
+                int _y2;
+                int _cap;
+        } EDGE_SPAN;
+
         // main functions
         void initGrid();
         void initRoutingLayers();
         void initRoutingTracks();
         void setCapacities();
         void setSpacingsAndMinWidths();
-        void initializeNets();
+        void initNetlist(int numThreads);
+        void initializeNets(int numThreads);
         void computeGridAdjustments();
-        void computeTrackAdjustments();
+        void computeTrackAdjustments(const RoutingLayer& layer, std::vector<EDGE_SPAN>& spans);
         void computeUserGlobalAdjustments();
         void computeUserLayerAdjustments();
-        void computeRegionAdjustments(Coordinate lowerBound, Coordinate upperBound, int layer, float reductionPercentage);
-        void computeObstaclesAdjustments();
+        void computeRegionAdjustments(CapacityRaster &raster, Coordinate lowerBound, Coordinate upperBound, int layer);
+        void computeObstaclesAdjustments(CapacityRaster &raster);
+        void runInitStages(bool layerAndRegionAdjustments);
+        void printVerification();
         
         // aux functions
         RoutingLayer getRoutingLayerByIndex(int index);
@@ -114,6 +138,7 @@ private:
         void addRemainingGuides(std::vector<FastRoute::NET> &globalRoute);
         void mergeBox(std::vector<Box>& guideBox);
         Box globalRoutingToBox(const FastRoute::ROUTE &route);
+        Coordinate getPinPositionOnGrid(const std::vector<Box>& pinBoxes);
         
         // check functions
         void checkPinPlacement();
@@ -123,13 +148,28 @@ public:
         
 	void parseLef(const std::string& file) { _dbWrapper.parseLEF(file); }
         void parseDef(const std::string& file) { _dbWrapper.parseDEF(file); }
+        bool readDB(const std::string& file, const std::vector<std::string>& inputs) {
+                return _dbWrapper.readDB(file, inputs);
+        }
+        void writeDB(const std::string& file) { _dbWrapper.writeDB(file); }
         
         void setAdjustment(const float adjustment) { _adjustment = adjustment; }
         void setMinRoutingLayer(const int minLayer) { _minRoutingLayer = minLayer; }
         void setMaxRoutingLayer(const int maxLayer) { _maxRoutingLayer = maxLayer; }
         void setUnidirectionalRoute(const bool unidirRoute) { _unidirectionalRoute = unidirRoute; }
         void setClockNetRouting(const bool clockNetRouting) { _clockNetRouting = clockNetRouting; }
+        void setNumThreads(const int numThreads) { _numThreads = numThreads; }
+        void setMaxRuntime(const float maxRuntime) { _maxRuntime = maxRuntime; }
+        void setMaxMazeRound(const int maxMazeRound) { _maxMazeRound = maxMazeRound; }
+        void setOverflowPlateau(const int overflowPlateau) { _overflowPlateau = overflowPlateau; }
+        void setMultiStart(const int numVariants, const int variantRounds) {
+                _numVariants = numVariants;
+                _variantRounds = variantRounds;
+        }
+        void setHilbertNetOrder(const bool hilbertNetOrder) { _hilbertNetOrder = hilbertNetOrder; }
+        void setVerificationLevel(const int verificationLevel) { _verificationLevel = verificationLevel; }
         void setOutputFile(const std::string& outfile) { _outfile = outfile; }
+        void setRecordingFile(const std::string& recordingFile) { _recordingFile = recordingFile; }
         void setPitchesInTile(const int pitchesInTile) { _grid.setPitchesInTile(pitchesInTile); }
         
         void addLayerAdjustment(int layer, float reductionPercentage) {
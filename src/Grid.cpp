@@ -37,6 +37,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "Grid.h"
+#include "TaskGraph.h"
 
 namespace FastRoute {
 
@@ -125,7 +126,7 @@ int Grid::computeTileReduce(const Box &obs, const Box &tile, int trackSpace, boo
 
         if (reduce < 0) {
                 std::cout << "Error!!!\n";
-                std::exit(0);
+                throw TaskFailure(0);
         }
         return reduce;
 }
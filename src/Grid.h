@@ -129,7 +129,7 @@ public:
         void addHorizontalCapacity(int value, int layer) { _horizontalEdgesCapacities[layer] = value; }
         void addVerticalCapacity(int value, int layer) { _verticalEdgesCapacities[layer] = value; }
         
-        std::map<int, std::vector<Box>> getAllObstacles() const { return _obstacles; }
+        const std::map<int, std::vector<Box>>& getAllObstacles() const { return _obstacles; }
         void addObstacle(int layer, Box obstacle) { _obstacles[layer].push_back(obstacle); }
         
         Coordinate getPositionOnGrid(const Coordinate& position);
@@ -43,6 +43,7 @@
 #include <functional>
 #include <limits>
 #include <iostream>
+#include <utility>
 
 #include "Coordinate.h"
 #include "Box.h"
@@ -58,13 +59,13 @@ private:
         
 public:
         Net() = default;
-        Net(const std::string name, const std::string signalType,
-            const std::vector<Pin> pins)
-            : _name(name), _signalType(signalType), _pins(pins) {}
+        Net(const std::string& name, const std::string& signalType,
+            std::vector<Pin> pins)
+            : _name(name), _signalType(signalType), _pins(std::move(pins)) {}
         
         std::string getName() const { return _name; }
         std::string getSignalType() const { return _signalType; }
-        std::vector<Pin> getPins() const { return _pins; }
+        const std::vector<Pin>& getPins() const { return _pins; }
         int getNumPins() const { return _pins.size(); }
 };
 
@@ -36,35 +36,41 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "Netlist.h"
+#include "TaskGraph.h"
 
 namespace FastRoute {
 
-Net Netlist::getNetByName(std::string name) {
-        Net choosenNet;
-        for (Net net : _nets) {
-                if (net.getName() == name) {
-                        choosenNet = net;
-                }
+const Net* Netlist::getNetByName(const std::string& name) const {
+        std::unordered_map<std::string, int>::const_iterator it = _netIds.find(name);
+        if (it == _netIds.end()) {
+                return nullptr;
         }
         
-        return choosenNet;
+        return &_nets[it->second];
 }
 
-void Netlist::addNet(const std::string& name, const std::string& signalType, const std::vector<Pin>& pins) {
-        Net net = Net(name, signalType, pins);
-        _nets.push_back(net);
+void Netlist::addNet(const std::string& name, const std::string& signalType, std::vector<Pin> pins) {
+        _nets.push_back(Net(name, signalType, std::move(pins)));
+        int netId = _nets.size() - 1;
+        _netIds[name] = netId;
+        const std::vector<Pin>& netPins = _nets.back().getPins();
+        for (int pin = 0; pin < netPins.size(); pin++) {
+                if (netPins[pin].isPort()) {
+                        _ports.push_back(std::make_pair(netId, pin));
+                }
+        }
         _netCount++;
 }
         
 int Netlist::getMaxNetDegree() {
         if (_nets.size() < 1) {
                 std::cout << "[ERROR] Netlist not initialized yet. Exiting...\n";
-                std::exit(1);
+                throw TaskFailure(1);
         }
     
         int maxDegree = -1;
         
-        for (Net net : _nets) {
+        for (const Net& net : _nets) {
                 int netDegree = net.getNumPins();
                 if (netDegree > maxDegree) {
                         maxDegree = netDegree;
@@ -74,17 +80,4 @@ int Netlist::getMaxNetDegree() {
         return maxDegree;
 }
 
-std::vector<Pin> Netlist::getAllPorts() {
-        std::vector<Pin> ports; 
-        for (Net net : _nets) {
-                for (Pin pin : net.getPins()) {
-                        if (pin.isPort()) {
-                                ports.push_back(pin);
-                        }
-                }
-        }
-        
-        return ports;
 }
-
-}
\ No newline at end of file
@@ -43,6 +43,8 @@
 #include <functional>
 #include <limits>
 #include <iostream>
+#include <unordered_map>
+#include <utility>
 
 #include "Coordinate.h"
 #include "Box.h"
@@ -54,22 +56,28 @@ namespace FastRoute {
 class Netlist {
 private:
         std::vector<Net> _nets;
+        std::vector<std::pair<int, int>> _ports;      // (net, pin) of the I/O pins of all nets, in net order
+        std::unordered_map<std::string, int> _netIds;  // position of each net in _nets
         int _netCount;
         
 public:
         Netlist()
             : _netCount(0) {};
         
-        std::vector<Net> getNets() const { return _nets; }
+        const std::vector<Net>& getNets() const { return _nets; }
         int getNetCount() const { return _netCount; }
-        Net getNetByName(std::string name);
+        // nullptr if there is no such net, valid until the next addNet
+        const Net* getNetByName(const std::string& name) const;
         
         
-        void addNet(const std::string& name, const std::string& signalType, const std::vector<Pin>& pins);
+        void addNet(const std::string& name, const std::string& signalType, std::vector<Pin> pins);
         
         int getMaxNetDegree();
         
-        std::vector<Pin> getAllPorts();
+        int getNumPorts() const { return _ports.size(); }
+        const Pin& getPort(int port) const {
+                return _nets[_ports[port].first].getPins()[_ports[port].second];
+        }
 };
 
 }
@@ -0,0 +1,66 @@
+
+////////////////////////////////////////////////////////////////////////////////
+// Authors: Vitor Bandeira, Mateus Fogaça, Eder Matheus Monteiro e Isadora
+// Oliveira
+//          (Advisor: Ricardo Reis)
+//
+// BSD 3-Clause License
+//
+// Copyright (c) 2019, Federal University of Rio Grande do Sul (UFRGS)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+
+#ifndef __PARALLELFOR_H_
+#define __PARALLELFOR_H_
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace FastRoute {
+
+// Splits [0, numItems) in contiguous chunks, one per thread, and calls
+// func(begin, end) on each of them. The calling thread takes the first chunk.
+template <typename Func>
+void parallelFor(int numItems, int numThreads, const Func& func) {
+        int numChunks = std::max(1, std::min(numThreads, numItems));
+        int chunkSize = (numItems + numChunks - 1) / numChunks;
+        std::vector<std::thread> workers;
+
+        for (int chunk = 1; chunk < numChunks; chunk++) {
+                int begin = std::min(chunk * chunkSize, numItems);
+                int end = std::min(begin + chunkSize, numItems);
+                workers.push_back(std::thread([&func, begin, end]() { func(begin, end); }));
+        }
+        func(0, std::min(chunkSize, numItems));
+        for (std::thread& worker : workers)
+                worker.join();
+}
+
+}
+
+#endif /* __PARALLELFOR_H_ */
@@ -44,6 +44,7 @@
 #include <limits>
 #include <iostream>
 #include <map>
+#include <utility>
 
 #include "Coordinate.h"
 #include "Box.h"
@@ -64,19 +65,19 @@ private:
 public:
         Pin() = default;
         Pin(const std::string& name, Coordinate position,
-            const std::vector<int> layers,
-            const std::map<int, std::vector<Box>>& boxesPerLayer,
+            std::vector<int> layers,
+            std::map<int, std::vector<Box>> boxesPerLayer,
             const std::string& netName, bool isPort)
-            : _name(name), _position(position), _layers(layers),
-            _boxesPerLayer(boxesPerLayer), _netName(netName),
+            : _name(name), _position(position), _layers(std::move(layers)),
+            _boxesPerLayer(std::move(boxesPerLayer)), _netName(netName),
             _isPort(isPort) { sortLayers(); }
         
         std::string getName() const { return _name; }
         Coordinate getPosition() const { return _position; }
-        std::vector<int> getLayers() const { return _layers; }
+        const std::vector<int>& getLayers() const { return _layers; }
         int getNumLayers() const { return _layers.size(); }
         int getTopLayer() const { return _layers.back(); }
-        std::map<int, std::vector<Box>> getBoxes() const { return _boxesPerLayer; }
+        const std::map<int, std::vector<Box>>& getBoxes() const { return _boxesPerLayer; }
         std::string getNetName() const { return _netName; }
         bool isPort() const { return _isPort; }
 };
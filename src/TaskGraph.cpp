@@ -0,0 +1,162 @@
+
+////////////////////////////////////////////////////////////////////////////////
+// Authors: Vitor Bandeira, Mateus Fogaça, Eder Matheus Monteiro e Isadora
+// Oliveira
+//          (Advisor: Ricardo Reis)
+//
+// BSD 3-Clause License
+//
+// Copyright (c) 2019, Federal University of Rio Grande do Sul (UFRGS)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "TaskGraph.h"
+
+namespace FastRoute {
+
+int TaskGraph::addTask(const std::string& name, const std::function<void()>& func,
+                       const std::vector<int>& dependencies) {
+        int id = addParallelTask(name, [func](int) { func(); }, dependencies);
+        _tasks[id]._parallel = false;
+        return id;
+}
+
+int TaskGraph::addParallelTask(const std::string& name, const std::function<void(int)>& func,
+                               const std::vector<int>& dependencies) {
+        TASK task;
+        task._name = name;
+        task._func = func;
+        task._numDependencies = dependencies.size();
+        task._parallel = true;
+        task._numThreads = 1;
+        task._start = 0;
+        task._end = 0;
+        _tasks.push_back(task);
+
+        int id = _tasks.size() - 1;
+        for (int dependency : dependencies) {
+                _tasks[dependency]._successors.push_back(id);
+        }
+
+        return id;
+}
+
+// Ready tasks are started in the order they became ready. A task prints
+// "<name>..." when it starts and "<name>... Done!" when it finishes. A
+// parallel task takes the free threads divided by the number of ready tasks,
+// the other tasks take one thread. The first exception thrown by a task stops
+// the graph and is thrown again here.
+void TaskGraph::run(int numThreads) {
+        std::mutex lock;
+        std::condition_variable wakeUp;
+        std::deque<int> ready;
+        std::exception_ptr failure;
+        int remaining = _tasks.size();
+        int freeThreads = std::max(numThreads, 1);
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+        for (int id = 0; id < _tasks.size(); id++) {
+                if (_tasks[id]._numDependencies == 0)
+                        ready.push_back(id);
+        }
+
+        auto worker = [&]() {
+                std::unique_lock<std::mutex> guard(lock);
+                while (true) {
+                        wakeUp.wait(guard, [&]() {
+                                return (!ready.empty() && freeThreads > 0) || remaining == 0 || failure;
+                        });
+                        if (remaining == 0 || failure)
+                                return;
+
+                        TASK& task = _tasks[ready.front()];
+                        task._numThreads = task._parallel ? std::max(1, freeThreads / (int)ready.size()) : 1;
+                        ready.pop_front();
+                        freeThreads -= task._numThreads;
+                        std::cout << task._name << "...\n";
+                        task._start = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                        guard.unlock();
+
+                        std::exception_ptr taskFailure;
+                        try {
+                                task._func(task._numThreads);
+                        } catch (...) {
+                                taskFailure = std::current_exception();
+                        }
+
+                        guard.lock();
+                        task._end = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                        freeThreads += task._numThreads;
+                        remaining--;
+                        wakeUp.notify_all();
+                        if (taskFailure) {
+                                std::cout << task._name << "... Failed!\n";
+                                if (!failure)
+                                        failure = taskFailure;
+                                continue;
+                        }
+                        std::cout << task._name << "... Done!\n";
+                        for (int successor : task._successors) {
+                                if (--_tasks[successor]._numDependencies == 0)
+                                        ready.push_back(successor);
+                        }
+                }
+        };
+
+        std::vector<std::thread> workers;
+        for (int i = 1; i < std::max(numThreads, 1); i++) {
+                workers.push_back(std::thread(worker));
+        }
+        worker();
+        for (std::thread& thread : workers) {
+                thread.join();
+        }
+        if (failure)
+                std::rethrow_exception(failure);
+}
+
+void TaskGraph::printTimeline() const {
+        std::cout << "Initialization timeline (s):\n";
+        for (const TASK& task : _tasks) {
+                char line[256];
+                std::snprintf(line, sizeof(line), "    %-45s %8.3f -> %8.3f (%.3f, %d thread%s)\n",
+                              task._name.c_str(), task._start, task._end, task._end - task._start,
+                              task._numThreads, task._numThreads > 1 ? "s" : "");
+                std::cout << line;
+        }
+}
+
+}
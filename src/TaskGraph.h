@@ -0,0 +1,90 @@
+
+////////////////////////////////////////////////////////////////////////////////
+// Authors: Vitor Bandeira, Mateus Fogaça, Eder Matheus Monteiro e Isadora
+// Oliveira
+//          (Advisor: Ricardo Reis)
+//
+// BSD 3-Clause License
+//
+// Copyright (c) 2019, Federal University of Rio Grande do Sul (UFRGS)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+
+#ifndef __TASKGRAPH_H_
+#define __TASKGRAPH_H_
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace FastRoute {
+
+// Thrown by a task that cannot go on, in place of exiting from a worker thread.
+// TaskGraph::run starts no other task and throws it again in the calling
+// thread once the running tasks are done.
+class TaskFailure {
+public:
+        explicit TaskFailure(int status) : _status(status) {}
+        int getStatus() const { return _status; }
+private:
+        int _status;
+};
+
+// Runs tasks on a pool of threads, each one as soon as the tasks it depends
+// on are done, and keeps the time each of them started and finished. A
+// parallel task gets a share of the threads not used by the running tasks,
+// so the tasks never use more threads than the graph together.
+class TaskGraph {
+private:
+        typedef struct {
+                std::string _name;
+                std::function<void(int)> _func;  // called with the thread budget
+                std::vector<int> _successors;
+                int _numDependencies;
+                bool _parallel;
+                int _numThreads;
+                double _start;  // seconds since the graph started
+                double _end;
+        } TASK;
+
+        std::vector<TASK> _tasks;
+
+public:
+        TaskGraph() = default;
+
+        int addTask(const std::string& name, const std::function<void()>& func,
+                    const std::vector<int>& dependencies = std::vector<int>());
+        int addParallelTask(const std::string& name, const std::function<void(int)>& func,
+                            const std::vector<int>& dependencies = std::vector<int>());
+        void run(int numThreads);
+        void printTimeline() const;
+};
+
+}
+
+#endif /* __TASKGRAPH_H_ */
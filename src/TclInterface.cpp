@@ -36,6 +36,9 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 #include "TclInterface.h"
 #include "FastRouteKernel.h"
 
@@ -46,12 +49,22 @@ extern FastRouteKernel* fastRouteKernel;
 void help() {
         std::cout << "Import LEF file:                         fr_import_lef \"path/to/file1.lef path/to/fileN.lef\"\n";
         std::cout << "Import DEF file:                         fr_import_def \"path/to/file1.def path/to/fileN.def\"\n";
+        std::cout << "Load a saved LEF/DEF database:           fr_read_db \"path/to/design.db\" \"path/to/file1.lef path/to/fileN.def\"\n";
+        std::cout << "Save the LEF/DEF database:               fr_write_db \"path/to/design.db\"\n";
         std::cout << "Set output file name:                    set_output_file \"path/to/output.guide\"\n";
+        std::cout << "Record the routing input:                set_recording_file \"path/to/input.frec\"\n";
         std::cout << "User defined global capacity adjustment: set_capacity_adjustment FLOAT\n";
+        std::cout << "Runtime budget in seconds:               set_max_runtime FLOAT\n";
+        std::cout << "Max number of maze routing rounds:       set_max_maze_rounds INTEGER\n";
+        std::cout << "Rounds without a better overflow:        set_overflow_plateau INTEGER\n";
+        std::cout << "Speculative variants and rounds:         set_multi_start INTEGER INTEGER\n";
+        std::cout << "Route the nets in Hilbert curve order:   set_hilbert_net_order BOOL\n";
+        std::cout << "Checks of the final routes:              set_verification_level none|fast|full\n";
         std::cout << "User defined region capacity adjustment: set_region_adjustment INTEGER INTEGER INTEGER INTEGER INTEGER FLOAT\n";
         std::cout << "User defined min routing layer:          set_min_layer INTEGER\n";
         std::cout << "User defined max routing layer:          set_max_layer INTEGER\n";
         std::cout << "Enable unidirection route:               set_unidirectional_routing BOOL\n";
+        std::cout << "Number of routing threads:               set_num_threads INTEGER\n";
         std::cout << "Initialize FastRoute4-lefdef structs:    start_fastroute\n";
         std::cout << "Run FastRoute4-lefdef:                   run_fastroute\n";
         std::cout << "Write output guides:                     write_guides\n";
@@ -68,10 +81,31 @@ void fr_import_def(const char* file) {
         fastRouteKernel->parseDef(file);
 }
 
+bool fr_read_db(const char* file, const char* inputs) {
+        std::cout << " > Reading database \"" << file << "\"\n";
+        
+        std::vector<std::string> inputPaths;
+        std::istringstream paths(inputs);
+        std::string path;
+        while (paths >> path) {
+                inputPaths.push_back(path);
+        }
+        return fastRouteKernel->readDB(file, inputPaths);
+}
+
+void fr_write_db(const char* file) {
+        std::cout << " > Writing database \"" << file << "\"\n";
+        fastRouteKernel->writeDB(file);
+}
+
 void set_output_file(const char * file) {
         fastRouteKernel->setOutputFile(file);
 }
 
+void set_recording_file(const char * file) {
+        fastRouteKernel->setRecordingFile(file);
+}
+
 void set_pitches_in_tile(int numPitches) {
         fastRouteKernel->setPitchesInTile(numPitches);
 }
@@ -80,6 +114,40 @@ void set_capacity_adjustment(float adjustment) {
         fastRouteKernel->setAdjustment(adjustment);
 }
 
+void set_max_runtime(float seconds) {
+        fastRouteKernel->setMaxRuntime(seconds);
+}
+
+void set_max_maze_rounds(int rounds) {
+        fastRouteKernel->setMaxMazeRound(rounds);
+}
+
+void set_overflow_plateau(int rounds) {
+        fastRouteKernel->setOverflowPlateau(rounds);
+}
+
+void set_multi_start(int numVariants, int rounds) {
+        fastRouteKernel->setMultiStart(numVariants, rounds);
+}
+
+void set_hilbert_net_order(bool hilbertNetOrder) {
+        fastRouteKernel->setHilbertNetOrder(hilbertNetOrder);
+}
+
+void set_verification_level(const char* level) {
+        std::string levelName = level;
+
+        if (levelName == "none") {
+                fastRouteKernel->setVerificationLevel(VERIFICATION_NONE);
+        } else if (levelName == "fast") {
+                fastRouteKernel->setVerificationLevel(VERIFICATION_FAST);
+        } else if (levelName == "full") {
+                fastRouteKernel->setVerificationLevel(VERIFICATION_FULL);
+        } else {
+                std::cout << "[WARNING] Unknown verification level \"" << level << "\", use none, fast or full\n";
+        }
+}
+
 extern void set_layer_adjustment(int layer, float reductionPercentage) {
         fastRouteKernel->addLayerAdjustment(layer, reductionPercentage);
 }
@@ -105,6 +173,10 @@ void set_clock_net_routing(bool clockNetRouting) {
         fastRouteKernel->setClockNetRouting(clockNetRouting);
 }
 
+void set_num_threads(int numThreads) {
+        fastRouteKernel->setNumThreads(numThreads);
+}
+
 void start_fastroute() {
         fastRouteKernel->startFastRoute();
 }
@@ -44,17 +44,27 @@ void help();
 // LEF/DEF/Guides interface
 void fr_import_lef(const char* file);
 void fr_import_def(const char* file);
+bool fr_read_db(const char* file, const char* inputs);
+void fr_write_db(const char* file);
 void set_output_file(const char * file);
+void set_recording_file(const char * file);
 
 // Parms interface
 void set_pitches_in_tile(int numPitches);
 void set_capacity_adjustment(float adjustment);
+void set_max_runtime(float seconds);
+void set_max_maze_rounds(int rounds);
+void set_overflow_plateau(int rounds);
+void set_multi_start(int numVariants, int rounds);
+void set_hilbert_net_order(bool hilbertNetOrder);
+void set_verification_level(const char* level);
 void set_layer_adjustment(int layer, float reductionPercentage);
 void set_region_adjustment(int minX, int minY, int maxX, int maxY, int layer, float reductionPercentage);
 void set_min_layer(int minLayer);
 void set_max_layer(int maxLayer);
 void set_unidirectional_routing(bool unidirRouting);
 void set_clock_net_routing(bool clockNetRouting);
+void set_num_threads(int numThreads);
 
 // Run
 void start_fastroute();
@@ -45,12 +45,28 @@ extern void fr_import_lef(const char* file);
 
 extern void fr_import_def(const char* file);
 
+extern bool fr_read_db(const char* file, const char* inputs);
+
+extern void fr_write_db(const char* file);
+
 extern void set_output_file(const char * file);
 
+extern void set_recording_file(const char * file);
+
 extern void set_pitches_in_tile(int numPitches);
 
 extern void set_capacity_adjustment(float adjustment);
 
+extern void set_max_runtime(float seconds);
+
+extern void set_max_maze_rounds(int rounds);
+
+extern void set_overflow_plateau(int rounds);
+
+extern void set_multi_start(int numVariants, int rounds);
+extern void set_hilbert_net_order(bool hilbertNetOrder);
+extern void set_verification_level(const char* level);
+
 extern void set_layer_adjustment(int layer, float reductionPercentage);
 
 extern void set_region_adjustment(int minX, int minY, int maxX, int maxY, int layer, float reductionPercentage);
@@ -63,6 +79,8 @@ extern void set_unidirectional_routing(bool unidirRouting);
 
 extern void set_clock_net_routing(bool clockNetRouting);
 
+extern void set_num_threads(int numThreads);
+
 extern void start_fastroute();
 
 extern void run_fastroute();
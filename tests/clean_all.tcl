@@ -52,6 +52,9 @@ proc clean_runs {{dir}} {
                 exec rm -f ${subdir}/input.log
                 exec rm -f ${subdir}/input.guide
                 exec rm -f ${subdir}/input.tcl
+                foreach runFile [glob -nocomplain ${subdir}/input_*] {
+                        exec rm -f $runFile
+                }
         }
 }
 
@@ -0,0 +1,106 @@
+#!/usr/bin/env tclsh
+
+################################################################################
+## Authors: Vitor Bandeira, Eder Matheus Monteiro e Isadora Oliveira
+##          (Advisor: Ricardo Reis)
+##
+## BSD 3-Clause License
+##
+## Copyright (c) 2019, Federal University of Rio Grande do Sul (UFRGS)
+## All rights reserved.
+##
+## Redistribution and use in source and binary forms, with or without
+## modification, are permitted provided that the following conditions are met:
+##
+## * Redistributions of source code must retain the above copyright notice, this
+##   list of conditions and the following disclaimer.
+##
+## * Redistributions in binary form must reproduce the above copyright notice,
+##   this list of conditions and the following disclaimer in the documentation
+##   and#or other materials provided with the distribution.
+##
+## * Neither the name of the copyright holder nor the names of its
+##   contributors may be used to endorse or promote products derived from
+##   this software without specific prior written permission.
+##
+## THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+## AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+## IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+## ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+## LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+## CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+## SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+## INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+## CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+## ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+## POSSIBILITY OF SUCH DAMAGE.
+################################################################################
+
+# Routes the design with a runtime budget and an overflow plateau. Limits that
+# are never reached keep the guides of a run without them, a budget that is
+# always exceeded skips post processing, and a plateau on a congested design
+# gives the same guides on every run, as it does not depend on the runtime.
+
+proc runWithLimits {testName testDir inputDir binFile runName adjustment maxRuntime plateau} {
+        set lefFile "${inputDir}/${testName}.lef"
+        set defFile "${inputDir}/${testName}.def"
+        set guideFile "$testDir/${testName}_${runName}.guide"
+        set logFile "$testDir/${testName}_${runName}.log"
+        set scriptFile "$testDir/${testName}_${runName}.tcl"
+
+        exec rm -f $guideFile
+        exec cp $testDir/routeDesign.tcl $scriptFile
+        exec sed -i s#_LEF_#$lefFile#g $scriptFile
+        exec sed -i s#_DEF_#$defFile#g $scriptFile
+        exec sed -i s#_GUIDE_#$guideFile#g $scriptFile
+        exec sed -i s#_ADJUSTMENT_#$adjustment#g $scriptFile
+        exec sed -i s#_MAX_RUNTIME_#$maxRuntime#g $scriptFile
+        exec sed -i s#_PLATEAU_#$plateau#g $scriptFile
+        catch {exec $binFile -c 1 < $scriptFile > $logFile}
+
+        if {![file exists $guideFile]} {
+                _err "Run $runName did not finish, see $logFile"
+        }
+        return $guideFile
+}
+
+proc checkSameGuides {goldFile outFile} {
+        set status [catch {exec diff $goldFile $outFile} result]
+        if {$status != 0} {
+                _puts stderr "Files are different"
+                _puts stderr "********************************************************************************"
+                _puts stderr $result
+                _puts stderr "********************************************************************************"
+                _err "files are different: $goldFile and $outFile... "
+        }
+}
+
+set test_name "input"
+
+set base_dir [pwd]
+set tests_dir "${base_dir}/tests"
+set src_dir "${tests_dir}/src"
+set inputs_dir "${tests_dir}/input"
+set bin_file "$base_dir/FastRoute"
+
+set curr_test "${src_dir}/test_budget"
+
+set gold_guides "${src_dir}/test_guides/golden.guide"
+
+_puts "--Compare guides with limits that are not reached..."
+set output_file [runWithLimits $test_name $curr_test $inputs_dir $bin_file "loose" 0.0 3600 1000]
+checkSameGuides $gold_guides $output_file
+_puts "--Compare guides with limits that are not reached: Success!"
+
+_puts "--Check a runtime budget that is exceeded..."
+runWithLimits $test_name $curr_test $inputs_dir $bin_file "budget" 0.0 0.000001 0
+if {[catch {exec grep -q "skipping post processing" $curr_test/${test_name}_budget.log}]} {
+        _err "Post processing ran past the runtime budget, see $curr_test/${test_name}_budget.log"
+}
+_puts "--Check a runtime budget that is exceeded: Success!"
+
+_puts "--Compare guides of two runs with an overflow plateau..."
+set plateau_guides [runWithLimits $test_name $curr_test $inputs_dir $bin_file "plateau1" 0.5 0 2]
+set output_file [runWithLimits $test_name $curr_test $inputs_dir $bin_file "plateau2" 0.5 0 2]
+checkSameGuides $plateau_guides $output_file
+_puts "--Compare guides of two runs with an overflow plateau: Success!"
@@ -0,0 +1,126 @@
+#!/usr/bin/env tclsh
+
+################################################################################
+## Authors: Vitor Bandeira, Eder Matheus Monteiro e Isadora Oliveira
+##          (Advisor: Ricardo Reis)
+##
+## BSD 3-Clause License
+##
+## Copyright (c) 2019, Federal University of Rio Grande do Sul (UFRGS)
+## All rights reserved.
+##
+## Redistribution and use in source and binary forms, with or without
+## modification, are permitted provided that the following conditions are met:
+##
+## * Redistributions of source code must retain the above copyright notice, this
+##   list of conditions and the following disclaimer.
+##
+## * Redistributions in binary form must reproduce the above copyright notice,
+##   this list of conditions and the following disclaimer in the documentation
+##   and#or other materials provided with the distribution.
+##
+## * Neither the name of the copyright holder nor the names of its
+##   contributors may be used to endorse or promote products derived from
+##   this software without specific prior written permission.
+##
+## THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+## AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+## IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+## ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+## LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+## CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+## SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+## INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+## CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+## ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+## POSSIBILITY OF SUCH DAMAGE.
+################################################################################
+# Saves the design in a database and reads it back. The database is used only
+# when it was saved from the same LEF and DEF files, listed in the same order,
+# and none of them changed since; otherwise the script imports the files again.
+# Both ways must give the guides of a run without a database.
+
+proc runWithDB {testName testDir lefFile defFile dbFile dbInputs binFile runName} {
+        set guideFile "$testDir/${testName}_${runName}.guide"
+        set logFile "$testDir/${testName}_${runName}.log"
+        set scriptFile "$testDir/${testName}_${runName}.tcl"
+
+        exec rm -f $guideFile
+        exec cp $testDir/routeDesign.tcl $scriptFile
+        exec sed -i s#_LEF_#$lefFile#g $scriptFile
+        exec sed -i s#_DEF_#$defFile#g $scriptFile
+        exec sed -i s#_DB_#$dbFile#g $scriptFile
+        exec sed -i "s#_INPUTS_#$dbInputs#g" $scriptFile
+        exec sed -i s#_GUIDE_#$guideFile#g $scriptFile
+        catch {exec $binFile -c 1 < $scriptFile > $logFile}
+
+        if {![file exists $guideFile]} {
+                _err "Run $runName did not finish, see $logFile"
+        }
+        return $guideFile
+}
+
+proc checkDatabase {testDir testName runName expected} {
+        set logFile "$testDir/${testName}_${runName}.log"
+        if {[catch {exec grep -q "Database $expected" $logFile}]} {
+                _err "Run $runName expected a database $expected, see $logFile"
+        }
+}
+
+proc checkSameGuides {goldFile outFile} {
+        set status [catch {exec diff $goldFile $outFile} result]
+        if {$status != 0} {
+                _puts stderr "Files are different"
+                _puts stderr "********************************************************************************"
+                _puts stderr $result
+                _puts stderr "********************************************************************************"
+                _err "files are different: $goldFile and $outFile... "
+        }
+}
+
+set test_name "input"
+
+set base_dir [pwd]
+set tests_dir "${base_dir}/tests"
+set src_dir "${tests_dir}/src"
+set inputs_dir "${tests_dir}/input"
+set bin_file "$base_dir/FastRoute"
+
+set curr_test "${src_dir}/test_db"
+
+set gold_guides "${src_dir}/test_guides/golden.guide"
+
+# the inputs are copied, so the test can change them
+set lef_file "$curr_test/${test_name}_design.lef"
+set def_file "$curr_test/${test_name}_design.def"
+set db_file "$curr_test/${test_name}_design.db"
+exec cp "${inputs_dir}/${test_name}.lef" $lef_file
+exec cp "${inputs_dir}/${test_name}.def" $def_file
+exec rm -f $db_file
+
+_puts "--Write a database and read it back..."
+set output_file [runWithDB $test_name $curr_test $lef_file $def_file $db_file "$lef_file $def_file" $bin_file "write"]
+checkDatabase $curr_test $test_name "write" "miss"
+checkSameGuides $gold_guides $output_file
+set output_file [runWithDB $test_name $curr_test $lef_file $def_file $db_file "$lef_file $def_file" $bin_file "read"]
+checkDatabase $curr_test $test_name "read" "hit"
+checkSameGuides $gold_guides $output_file
+_puts "--Write a database and read it back: Success!"
+
+_puts "--Read a database with other input files..."
+set output_file [runWithDB $test_name $curr_test $lef_file $def_file $db_file "$def_file $lef_file" $bin_file "order"]
+checkDatabase $curr_test $test_name "order" "miss"
+checkSameGuides $gold_guides $output_file
+set output_file [runWithDB $test_name $curr_test $lef_file $def_file $db_file "$lef_file" $bin_file "missing"]
+checkDatabase $curr_test $test_name "missing" "miss"
+checkSameGuides $gold_guides $output_file
+_puts "--Read a database with other input files: Success!"
+
+_puts "--Read a database after an input file changed..."
+set def_channel [open $def_file a]
+_puts $def_channel ""
+close $def_channel
+set output_file [runWithDB $test_name $curr_test $lef_file $def_file $db_file "$lef_file $def_file" $bin_file "changed"]
+checkDatabase $curr_test $test_name "changed" "miss"
+checkSameGuides $gold_guides $output_file
+_puts "--Read a database after an input file changed: Success!"
@@ -0,0 +1,114 @@
+#!/usr/bin/env tclsh
+
+################################################################################
+## Authors: Vitor Bandeira, Eder Matheus Monteiro e Isadora Oliveira
+##          (Advisor: Ricardo Reis)
+##
+## BSD 3-Clause License
+##
+## Copyright (c) 2019, Federal University of Rio Grande do Sul (UFRGS)
+## All rights reserved.
+##
+## Redistribution and use in source and binary forms, with or without
+## modification, are permitted provided that the following conditions are met:
+##
+## * Redistributions of source code must retain the above copyright notice, this
+##   list of conditions and the following disclaimer.
+##
+## * Redistributions in binary form must reproduce the above copyright notice,
+##   this list of conditions and the following disclaimer in the documentation
+##   and#or other materials provided with the distribution.
+##
+## * Neither the name of the copyright holder nor the names of its
+##   contributors may be used to endorse or promote products derived from
+##   this software without specific prior written permission.
+##
+## THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+## AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+## IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+## ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+## LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+## CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+## SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+## INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+## CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+## ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+## POSSIBILITY OF SUCH DAMAGE.
+################################################################################
+# Records the routing input of the design and routes the recording again with
+# Replay, without the LEF and DEF files. The replay must report the wire length
+# and the vias of the recorded run, which gives the guides of test_guides.
+
+proc reportedLine {logFile pattern} {
+        if {[catch {exec grep $pattern $logFile} result]} {
+                _err "No \"$pattern\" in $logFile"
+        }
+        return $result
+}
+
+proc checkSameGuides {goldFile outFile} {
+        set status [catch {exec diff $goldFile $outFile} result]
+        if {$status != 0} {
+                _puts stderr "Files are different"
+                _puts stderr "********************************************************************************"
+                _puts stderr $result
+                _puts stderr "********************************************************************************"
+                _err "files are different: $goldFile and $outFile... "
+        }
+}
+
+set test_name "input"
+
+set base_dir [pwd]
+set tests_dir "${base_dir}/tests"
+set src_dir "${tests_dir}/src"
+set inputs_dir "${tests_dir}/input"
+set bin_file "$base_dir/FastRoute"
+set replay_file "$base_dir/Replay"
+
+set curr_test "${src_dir}/test_replay"
+
+set gold_guides "${src_dir}/test_guides/golden.guide"
+set gold_wl "${src_dir}/test_wl/golden.wl"
+
+if {![file exists $replay_file]} {
+        _err "$replay_file not found, build the Replay target of third_party/fastroute"
+}
+
+set run_name "${test_name}_record"
+set guide_file "$curr_test/$run_name.guide"
+set record_file "$curr_test/$run_name.frec"
+set record_log "$curr_test/$run_name.log"
+set replay_log "$curr_test/${test_name}_replay.log"
+
+_puts "--Record the routing input..."
+exec rm -f $guide_file $record_file
+exec cp $curr_test/routeDesign.tcl $curr_test/$run_name.tcl
+exec sed -i s#_LEF_#${inputs_dir}/${test_name}.lef#g $curr_test/$run_name.tcl
+exec sed -i s#_DEF_#${inputs_dir}/${test_name}.def#g $curr_test/$run_name.tcl
+exec sed -i s#_GUIDE_#$guide_file#g $curr_test/$run_name.tcl
+exec sed -i s#_RECORDING_#$record_file#g $curr_test/$run_name.tcl
+catch {exec $bin_file -c 1 < $curr_test/$run_name.tcl > $record_log}
+
+if {![file exists $guide_file] || ![file exists $record_file]} {
+        _err "Recorded run did not finish, see $record_log"
+}
+checkSameGuides $gold_guides $guide_file
+_puts "--Record the routing input: Success!"
+
+_puts "--Compare the replay with the recorded run..."
+if {[catch {exec $replay_file $record_file 1 > $replay_log}]} {
+        _err "Replay of $record_file failed, see $replay_log"
+}
+foreach pattern {"Final routing length" "Final number of via"} {
+        set recorded [reportedLine $record_log $pattern]
+        set replayed [reportedLine $replay_log $pattern]
+        if {$recorded != $replayed} {
+                _err "Replay reported \"$replayed\" instead of \"$recorded\""
+        }
+}
+set replayed [reportedLine $replay_log "Final routing length"]
+if {[catch {exec grep -q $replayed $gold_wl}]} {
+        _err "Replay did not report the wire length of $gold_wl"
+}
+_puts "--Compare the replay with the recorded run: Success!"
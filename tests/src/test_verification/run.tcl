@@ -0,0 +1,102 @@
+#!/usr/bin/env tclsh
+
+################################################################################
+## Authors: Vitor Bandeira, Eder Matheus Monteiro e Isadora Oliveira
+##          (Advisor: Ricardo Reis)
+##
+## BSD 3-Clause License
+##
+## Copyright (c) 2019, Federal University of Rio Grande do Sul (UFRGS)
+## All rights reserved.
+##
+## Redistribution and use in source and binary forms, with or without
+## modification, are permitted provided that the following conditions are met:
+##
+## * Redistributions of source code must retain the above copyright notice, this
+##   list of conditions and the following disclaimer.
+##
+## * Redistributions in binary form must reproduce the above copyright notice,
+##   this list of conditions and the following disclaimer in the documentation
+##   and#or other materials provided with the distribution.
+##
+## * Neither the name of the copyright holder nor the names of its
+##   contributors may be used to endorse or promote products derived from
+##   this software without specific prior written permission.
+##
+## THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+## AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+## IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+## ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+## LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+## CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+## SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+## INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+## CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+## ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+## POSSIBILITY OF SUCH DAMAGE.
+################################################################################
+
+# Routes the design with each verification level. The guides must not depend
+# on the level; fast and full report the wire length of test_wl and none
+# reports nothing.
+
+proc runWithLevel {testName testDir inputDir binFile level} {
+        set runName "${testName}_${level}"
+        set lefFile "${inputDir}/${testName}.lef"
+        set defFile "${inputDir}/${testName}.def"
+        set guideFile "$testDir/$runName.guide"
+
+        exec rm -f $guideFile
+        exec cp $testDir/routeDesign.tcl $testDir/$runName.tcl
+        exec sed -i s#_LEF_#$lefFile#g $testDir/$runName.tcl
+        exec sed -i s#_DEF_#$defFile#g $testDir/$runName.tcl
+        exec sed -i s#_GUIDE_#$guideFile#g $testDir/$runName.tcl
+        exec sed -i s#_LEVEL_#$level#g $testDir/$runName.tcl
+        catch {exec $binFile -c 1 < $testDir/$runName.tcl > $testDir/$runName.log}
+
+        if {![file exists $guideFile]} {
+                _err "Run with verification level $level did not finish, see $testDir/$runName.log"
+        }
+        return $guideFile
+}
+
+proc checkSameGuides {goldFile outFile} {
+        set status [catch {exec diff $goldFile $outFile} result]
+        if {$status != 0} {
+                _puts stderr "Files are different"
+                _puts stderr "********************************************************************************"
+                _puts stderr $result
+                _puts stderr "********************************************************************************"
+                _err "files are different: $goldFile and $outFile... "
+        }
+}
+
+set test_name "input"
+
+set base_dir [pwd]
+set tests_dir "${base_dir}/tests"
+set src_dir "${tests_dir}/src"
+set inputs_dir "${tests_dir}/input"
+set bin_file "$base_dir/FastRoute"
+
+set curr_test "${src_dir}/test_verification"
+
+set gold_guides "${src_dir}/test_guides/golden.guide"
+set gold_wl "${src_dir}/test_wl/golden.wl"
+
+foreach level {none fast full} {
+        _puts "--Check verification level $level..."
+        set output_file [runWithLevel $test_name $curr_test $inputs_dir $bin_file $level]
+        checkSameGuides $gold_guides $output_file
+
+        set output_log "$curr_test/${test_name}_${level}.log"
+        set status [catch {exec grep "Final routing length" $output_log} result]
+        if {$level == "none"} {
+                if {$status == 0} {
+                        _err "Verification level none reported \"$result\""
+                }
+        } elseif {$status != 0 || [catch {exec grep -q $result $gold_wl}]} {
+                _err "Verification level $level did not report the wire length of $gold_wl"
+        }
+        _puts "--Check verification level $level: Success!"
+}
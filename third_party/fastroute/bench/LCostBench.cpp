@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, Iowa State University All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software
+// without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+// Microbenchmark of the L-route cost kernels (LCost.cpp). Times every kernel
+// supported by the cpu on random segments of several lengths over a grid with
+// random usage, and checks that all kernels return the same costs.
+// Usage: LCostBench [grid size] [segments per length]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include "DataType.h"
+#include "flute.h"
+#include "DataProc.h"
+#include "LCost.h"
+
+using namespace FastRoute;
+
+static const char *kernelNames[] = {"scalar", "avx2", "avx512"};
+
+static void initEdges(Edge *edges, int numEdges, unsigned *seed) {
+        int i;
+
+        for (i = 0; i < numEdges; i++) {
+                edges[i].cap = 10;
+                edges[i].usage = 0;
+                edges[i].red = rand_r(seed) % 4;
+                edges[i].last_usage = 0;
+                edges[i].congCNT = 0;
+                // not only multiples of 0.5, so a reordered float sum would differ
+                edges[i].est_usage = 0.01f * (rand_r(seed) % 1200);
+        }
+}
+
+int main(int argc, char **argv) {
+        int gridSize = argc > 1 ? atoi(argv[1]) : 1000;
+        int numSegs = argc > 2 ? atoi(argv[2]) : 200000;
+        int lengths[] = {1, 2, 4, 8, 16, 32, 64, 128, 256, 512};
+        int numLengths = sizeof(lengths) / sizeof(lengths[0]);
+        int i, k, l, len, dx;
+        unsigned seed = 1;
+        LCostKernel kernel, best = bestLCostKernel();
+
+        xGrid = yGrid = gridSize;
+        hCapacity_lb = vCapacity_lb = 0.9 * 10;
+        h_edges = (Edge *)malloc(yGrid * (xGrid - 1) * sizeof(Edge));
+        v_edges = (Edge *)malloc((yGrid - 1) * xGrid * sizeof(Edge));
+        initEdges(h_edges, yGrid * (xGrid - 1), &seed);
+        initEdges(v_edges, (yGrid - 1) * xGrid, &seed);
+
+        printf("grid %dx%d, %d segments per length, best kernel %s\n", xGrid, yGrid, numSegs, kernelNames[best]);
+        printf("%8s", "length");
+        for (k = LCOST_SCALAR; k <= best; k++)
+                printf("%14s", kernelNames[k]);
+        printf("   (ns per segment)\n");
+
+        for (l = 0; l < numLengths; l++) {
+                len = std::min(lengths[l], gridSize - 1);
+                std::vector<int> x1(numSegs), y1(numSegs), x2(numSegs), y2(numSegs);
+                std::vector<float> ref1(numSegs), ref2(numSegs);
+
+                // half of the length in x and half in y, random position and orientation
+                for (i = 0; i < numSegs; i++) {
+                        dx = std::max(1, len / 2);
+                        x1[i] = rand_r(&seed) % (xGrid - dx);
+                        x2[i] = x1[i] + dx;
+                        y1[i] = rand_r(&seed) % (yGrid - (len - dx) - 1);
+                        y2[i] = y1[i] + std::max(1, len - dx);
+                        if (rand_r(&seed) % 2)
+                                std::swap(y1[i], y2[i]);
+                }
+
+                printf("%8d", len);
+                for (k = LCOST_SCALAR; k <= best; k++) {
+                        kernel = (LCostKernel)k;
+                        setLCostKernel(kernel);
+
+                        float costL1, costL2;
+                        int mismatches = 0;
+                        auto start = std::chrono::steady_clock::now();
+                        for (i = 0; i < numSegs; i++) {
+                                costL1 = costL2 = 0;
+                                evalLCost(x1[i], y1[i], x2[i], y2[i], &costL1, &costL2);
+                                if (kernel == LCOST_SCALAR) {
+                                        ref1[i] = costL1;
+                                        ref2[i] = costL2;
+                                } else if (costL1 != ref1[i] || costL2 != ref2[i]) {
+                                        mismatches++;
+                                }
+                        }
+                        auto stop = std::chrono::steady_clock::now();
+                        double ns = std::chrono::duration<double, std::nano>(stop - start).count() / numSegs;
+
+                        printf("%14.1f", ns);
+                        if (mismatches > 0)
+                                printf(" (%d mismatches)", mismatches);
+                }
+                printf("\n");
+        }
+
+        free(h_edges);
+        free(v_edges);
+        return 0;
+}
@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, Iowa State University All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software
+// without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+// Microbenchmark of the layer assignment DP kernels (LayerDP.cpp). Times the
+// via relaxation and the capacity gather of every kernel supported by the cpu
+// on random grid steps for several numbers of layers, and checks that all
+// kernels give the results of the scalar one.
+// Usage: LayerDPBench [grid steps] [rounds]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "DataType.h"
+#include "flute.h"
+#include "DataProc.h"
+#include "LCost.h"
+#include "LayerDP.h"
+
+using namespace FastRoute;
+
+static const char *kernelNames[] = {"scalar", "avx2", "avx512"};
+
+int main(int argc, char **argv) {
+        int numSteps = argc > 1 ? atoi(argv[1]) : 100000;
+        int rounds = argc > 2 ? atoi(argv[2]) : 10;
+        int layerCounts[] = {2, 4, 6, 10, 14, MAXLAYER};
+        int numCounts = sizeof(layerCounts) / sizeof(layerCounts[0]);
+        int c, k, l, r, s, numLayers, stride = 1013;
+        unsigned seed = 1;
+        LCostKernel best = bestLCostKernel();
+
+        std::vector<int> dist0(numSteps * MAXLAYER), dist(numSteps * MAXLAYER), link(numSteps * MAXLAYER);
+        std::vector<int> cap(numSteps * MAXLAYER), refDist, refLink, refCap;
+        std::vector<Edge3D> edges(MAXLAYER * stride);
+
+        // costs of one or a few blocked edges (BIG_INT) and small costs, like in assignEdge
+        for (s = 0; s < numSteps * MAXLAYER; s++)
+                dist0[s] = (rand_r(&seed) % 8 == 0 ? BIG_INT * (1 + rand_r(&seed) % 3) : 0) + rand_r(&seed) % 50;
+        for (s = 0; s < MAXLAYER * stride; s++) {
+                edges[s].cap = rand_r(&seed) % 16;
+                edges[s].usage = rand_r(&seed) % 20;
+                edges[s].red = 0;
+        }
+
+        printf("%d grid steps, %d rounds, best kernel %s\n", numSteps, rounds, kernelNames[best]);
+        printf("%8s %8s %14s %14s   (ns per grid step)\n", "layers", "kernel", "relax", "capacity");
+        for (c = 0; c < numCounts; c++) {
+                numLayers = layerCounts[c];
+                for (k = LCOST_SCALAR; k <= best; k++) {
+                        int mismatches = 0;
+                        double relaxTime = 0, capTime = 0;
+                        setLCostKernel((LCostKernel)k);
+
+                        for (r = 0; r < rounds; r++) {
+                                std::copy(dist0.begin(), dist0.end(), dist.begin());
+                                std::fill(link.begin(), link.end(), BIG_INT);
+                                auto start = std::chrono::steady_clock::now();
+                                for (s = 0; s < numSteps; s++)
+                                        relaxVias(&dist[s * MAXLAYER], &link[s * MAXLAYER], numLayers, 1 + s % 3);
+                                auto mid = std::chrono::steady_clock::now();
+                                for (s = 0; s < numSteps; s++)
+                                        layerCapacity(&edges[s % stride], stride, numLayers, &cap[s * MAXLAYER]);
+                                auto stop = std::chrono::steady_clock::now();
+                                relaxTime += std::chrono::duration<double, std::nano>(mid - start).count();
+                                capTime += std::chrono::duration<double, std::nano>(stop - mid).count();
+                        }
+
+                        if (k == LCOST_SCALAR) {
+                                refDist = dist;
+                                refLink = link;
+                                refCap = cap;
+                        } else {
+                                for (s = 0; s < numSteps; s++) {
+                                        for (l = 0; l < numLayers; l++) {
+                                                if (dist[s * MAXLAYER + l] != refDist[s * MAXLAYER + l] ||
+                                                    link[s * MAXLAYER + l] != refLink[s * MAXLAYER + l] ||
+                                                    cap[s * MAXLAYER + l] != refCap[s * MAXLAYER + l])
+                                                        mismatches++;
+                                        }
+                                }
+                        }
+
+                        printf("%8d %8s %14.2f %14.2f", numLayers, kernelNames[k], relaxTime / rounds / numSteps,
+                               capTime / rounds / numSteps);
+                        if (mismatches > 0)
+                                printf(" (%d results differ)", mismatches);
+                        printf("\n");
+                }
+        }
+
+        return 0;
+}
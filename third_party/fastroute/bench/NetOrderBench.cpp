@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, Iowa State University All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software
+// without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+// Benchmark of the net ordering. Routes the same random design with the nets in
+// input order and renumbered along a Hilbert curve (setHilbertNetOrder), and
+// reports the runtime and the cache references and misses of FT::run from the
+// hardware counters, when the kernel lets us read them. Each run is done in a
+// child process, as FastRoute keeps its state in globals.
+// Usage: NetOrderBench [grid size] [# nets] [capacity]
+
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <vector>
+#include "FastRoute.h"
+
+using namespace FastRoute;
+
+static const char *orderNames[] = {"input", "hilbert"};
+
+static int openCounter(unsigned long long config) {
+        struct perf_event_attr attr;
+
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1;  // count the worker threads too
+        return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static long long readCounter(int fd) {
+        long long count;
+
+        if (fd < 0 || read(fd, &count, sizeof(count)) != sizeof(count))
+                return -1;
+        return count;
+}
+
+static void route(int gridSize, int numNets, int cap, bool hilbert) {
+        const int numLayers = 4, tile = 10;
+        unsigned seed = 1;
+        int n, p, l, deg, span, cx, cy, maxDeg = 2, refs, misses;
+        long long numSegments = 0;
+        std::vector<std::vector<PIN>> pins(numNets);
+        std::vector<NET> result;
+        FT fr;
+
+        fr.setLowerLeft(0, 0);
+        fr.setTileSize(tile, tile);
+        fr.setGridsAndLayers(gridSize, gridSize, numLayers);
+        for (l = 1; l <= numLayers; l++) {
+                fr.addHCapacity(l % 2 ? cap : 0, l);
+                fr.addVCapacity(l % 2 ? 0 : cap, l);
+                fr.addMinWidth(1, l);
+                fr.addMinSpacing(1, l);
+                fr.addViaSpacing(1, l);
+        }
+        fr.setLayerOrientation(0);
+        fr.setNumberNets(numNets + 1);
+        fr.setHilbertNetOrder(hilbert);
+
+        // nets of 2 to 6 pins around random centers, in random order like the
+        // nets of a database
+        for (n = 0; n < numNets; n++) {
+                deg = 2 + rand_r(&seed) % 5;
+                span = 2 + rand_r(&seed) % 10;
+                cx = rand_r(&seed) % gridSize;
+                cy = rand_r(&seed) % gridSize;
+                for (p = 0; p < deg; p++) {
+                        PIN pin;
+                        pin.x = std::min(std::max(cx + rand_r(&seed) % (2 * span + 1) - span, 0), gridSize - 1) * tile + tile / 2;
+                        pin.y = std::min(std::max(cy + rand_r(&seed) % (2 * span + 1) - span, 0), gridSize - 1) * tile + tile / 2;
+                        pin.layer = 1 + rand_r(&seed) % 2;
+                        pins[n].push_back(pin);
+                }
+                maxDeg = std::max(maxDeg, deg);
+        }
+        fr.setMaxNetDegree(maxDeg);
+        for (n = 0; n < numNets; n++) {
+                char name[32];
+                sprintf(name, "net%d", n);
+                fr.addNet(name, n, pins[n].size(), 1, pins[n].data());
+        }
+        fr.initEdges();
+        fr.initAuxVar();
+
+        refs = openCounter(PERF_COUNT_HW_CACHE_REFERENCES);
+        misses = openCounter(PERF_COUNT_HW_CACHE_MISSES);
+        ioctl(refs, PERF_EVENT_IOC_ENABLE, 0);
+        ioctl(misses, PERF_EVENT_IOC_ENABLE, 0);
+        auto start = std::chrono::steady_clock::now();
+        fr.run(result);
+        auto stop = std::chrono::steady_clock::now();
+        ioctl(refs, PERF_EVENT_IOC_DISABLE, 0);
+        ioctl(misses, PERF_EVENT_IOC_DISABLE, 0);
+
+        for (NET &net : result)
+                numSegments += net.route.size();
+
+        long long numRefs = readCounter(refs), numMisses = readCounter(misses);
+        fprintf(stderr, "%8s %12.1f %16lld", orderNames[hilbert], std::chrono::duration<double, std::milli>(stop - start).count(),
+                numSegments);
+        if (numRefs >= 0 && numMisses >= 0) {
+                fprintf(stderr, " %16lld %16lld %9.2f%%\n", numRefs, numMisses, numRefs > 0 ? 100.0 * numMisses / numRefs : 0.0);
+        } else {
+                fprintf(stderr, " %16s %16s %10s\n", "n/a", "n/a", "n/a");
+        }
+}
+
+int main(int argc, char **argv) {
+        int gridSize = argc > 1 ? atoi(argv[1]) : 300;
+        int numNets = argc > 2 ? atoi(argv[2]) : 30000;
+        int cap = argc > 3 ? atoi(argv[3]) : 16;
+        int order, status;
+        pid_t pid;
+
+        fprintf(stderr, "grid %dx%d, %d nets, capacity %d\n", gridSize, gridSize, numNets, cap);
+        fprintf(stderr, "%8s %12s %16s %16s %16s %10s\n", "order", "run (ms)", "segments", "cache refs", "cache misses", "miss rate");
+        for (order = 0; order < 2; order++) {
+                fflush(stderr);
+                pid = fork();
+                if (pid == 0) {
+                        // the router log goes to stdout
+                        if (freopen("/dev/null", "w", stdout) == NULL)
+                                return 1;
+                        route(gridSize, numNets, cap, order == 1);
+                        return 0;
+                }
+                waitpid(pid, &status, 0);
+                if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                        fprintf(stderr, "%8s failed\n", orderNames[order]);
+        }
+        return 0;
+}
@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, Iowa State University All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software
+// without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+// Microbenchmark of the per-round bookkeeping kernels (Overflow.cpp). Times
+// the overflow statistics of getOverflow2Dmaze and the congestion history
+// update of updateCongestionHistory on a random grid, for every SIMD kernel
+// supported by the cpu and 1 to the given number of threads, and checks the
+// results against the first run.
+// Usage: OverflowBench [grid size] [max threads] [rounds]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "DataType.h"
+#include "flute.h"
+#include "DataProc.h"
+#include "LCost.h"
+#include "Overflow.h"
+
+using namespace FastRoute;
+
+static const char *kernelNames[] = {"scalar", "avx2", "avx512"};
+
+static void initEdges(Edge *edges, int numEdges, unsigned *seed) {
+        int i;
+
+        for (i = 0; i < numEdges; i++) {
+                edges[i].cap = 8 + rand_r(seed) % 8;
+                edges[i].usage = rand_r(seed) % 20;
+                edges[i].red = 0;
+                edges[i].last_usage = rand_r(seed) % 50;
+                edges[i].congCNT = rand_r(seed) % 4;
+                edges[i].est_usage = 0;
+        }
+}
+
+int main(int argc, char **argv) {
+        int gridSize = argc > 1 ? atoi(argv[1]) : 1000;
+        int maxThreads = argc > 2 ? atoi(argv[2]) : 4;
+        int rounds = argc > 3 ? atoi(argv[3]) : 20;
+        int numH, numV, r, k, t, upType, maxlimit, refMax = -1;
+        unsigned seed = 1;
+        OverflowStats h, v, refH, refV;
+        LCostKernel best = bestLCostKernel();
+
+        xGrid = yGrid = gridSize;
+        numH = yGrid * (xGrid - 1);
+        numV = (yGrid - 1) * xGrid;
+        h_edges = (Edge *)malloc(numH * sizeof(Edge));
+        v_edges = (Edge *)malloc(numV * sizeof(Edge));
+        initEdges(h_edges, numH, &seed);
+        initEdges(v_edges, numV, &seed);
+
+        std::vector<Edge> h0(h_edges, h_edges + numH), v0(v_edges, v_edges + numV);
+        std::vector<Edge> hRef, vRef;
+
+        printf("grid %dx%d, %d rounds, best kernel %s\n", xGrid, yGrid, rounds, kernelNames[best]);
+        printf("%8s %8s %14s %14s   (ms per round)\n", "kernel", "threads", "overflow", "history");
+
+        memset(&refH, 0, sizeof(refH));
+        memset(&refV, 0, sizeof(refV));
+        for (k = LCOST_SCALAR; k <= best; k++) {
+                setLCostKernel((LCostKernel)k);
+                for (t = 1; t <= maxThreads; t *= 2) {
+                        int mismatches = 0;
+                        numThreads = t;
+
+                        auto start = std::chrono::steady_clock::now();
+                        for (r = 0; r < rounds; r++) {
+                                sumOverflow(h_edges, numH, &h);
+                                sumOverflow(v_edges, numV, &v);
+                        }
+                        auto mid = std::chrono::steady_clock::now();
+
+                        // the history kernel does not depend on the SIMD kernel, run it from the same grid every time
+                        std::copy(h0.begin(), h0.end(), h_edges);
+                        std::copy(v0.begin(), v0.end(), v_edges);
+                        auto histStart = std::chrono::steady_clock::now();
+                        for (r = 0; r < rounds; r++) {
+                                upType = 1 + r % 4;
+                                maxlimit = std::max(updateHistory(h_edges, numH, upType, FALSE, TRUE),
+                                                    updateHistory(v_edges, numV, upType, FALSE, FALSE));
+                        }
+                        auto stop = std::chrono::steady_clock::now();
+
+                        if (refMax < 0) {
+                                refH = h;
+                                refV = v;
+                                refMax = maxlimit;
+                                hRef.assign(h_edges, h_edges + numH);
+                                vRef.assign(v_edges, v_edges + numV);
+                        } else {
+                                if (memcmp(&h, &refH, sizeof(h)) || memcmp(&v, &refV, sizeof(v)))
+                                        mismatches++;
+                                if (maxlimit != refMax || memcmp(h_edges, hRef.data(), numH * sizeof(Edge)) ||
+                                    memcmp(v_edges, vRef.data(), numV * sizeof(Edge)))
+                                        mismatches++;
+                        }
+
+                        printf("%8s %8d %14.3f %14.3f", kernelNames[k], t,
+                               std::chrono::duration<double, std::milli>(mid - start).count() / rounds,
+                               std::chrono::duration<double, std::milli>(stop - histStart).count() / rounds);
+                        if (mismatches > 0)
+                                printf(" (results differ)");
+                        printf("\n");
+
+                        // restore the grid for the next overflow run
+                        std::copy(h0.begin(), h0.end(), h_edges);
+                        std::copy(v0.begin(), v0.end(), v_edges);
+                }
+        }
+        printf("overflow H %d (max %d, %d edges) V %d (max %d, %d edges), usage %d, cap %d\n", refH.overflow,
+               refH.maxOverflow, refH.numOverflow, refV.overflow, refV.maxOverflow, refV.numOverflow,
+               refH.usage + refV.usage, refH.cap + refV.cap);
+
+        free(h_edges);
+        free(v_edges);
+        return 0;
+}
@@ -0,0 +1,210 @@
+////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, Iowa State University All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software
+// without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+// Replay of a recording of the routing input (FT::startRecording, Recording.h).
+// Feeds the recorded calls to FT, routes the design and reports the runtime and
+// the statistics of the routes, without the database the recording was made
+// from. The routes can be written to a file, one net per line, to compare runs.
+// Usage: Replay <recording> [# threads] [routes file]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+#include "FastRoute.h"
+#include "Recording.h"
+
+using namespace FastRoute;
+
+// feed the records to fr up to REC_INIT_AUX_VAR. Returns false on a truncated
+// or unknown record
+static bool replay(FILE *file, FT &fr) {
+        std::vector<int> args;
+        std::vector<PIN> pins;
+        std::string bytes;
+        int op, p;
+
+        while ((op = readRecord(file, args, bytes)) != 0) {
+                const int *a = args.data();
+                switch (op) {
+                        case REC_GRIDS_AND_LAYERS:
+                                fr.setGridsAndLayers(a[0], a[1], a[2]);
+                                break;
+                        case REC_V_CAPACITY:
+                                fr.addVCapacity(a[0], a[1]);
+                                break;
+                        case REC_H_CAPACITY:
+                                fr.addHCapacity(a[0], a[1]);
+                                break;
+                        case REC_MIN_WIDTH:
+                                fr.addMinWidth(a[0], a[1]);
+                                break;
+                        case REC_MIN_SPACING:
+                                fr.addMinSpacing(a[0], a[1]);
+                                break;
+                        case REC_VIA_SPACING:
+                                fr.addViaSpacing(a[0], a[1]);
+                                break;
+                        case REC_NUMBER_NETS:
+                                fr.setNumberNets(a[0]);
+                                break;
+                        case REC_LOWER_LEFT:
+                                fr.setLowerLeft(a[0], a[1]);
+                                break;
+                        case REC_TILE_SIZE:
+                                fr.setTileSize(a[0], a[1]);
+                                break;
+                        case REC_LAYER_ORIENTATION:
+                                fr.setLayerOrientation(a[0]);
+                                break;
+                        case REC_MAX_NET_DEGREE:
+                                fr.setMaxNetDegree(a[0]);
+                                break;
+                        case REC_NET:
+                                pins.resize((args.size() - 2) / 3);
+                                for (p = 0; p < (int)pins.size(); p++) {
+                                        pins[p].x = a[2 + 3 * p];
+                                        pins[p].y = a[3 + 3 * p];
+                                        pins[p].layer = a[4 + 3 * p];
+                                }
+                                fr.addNet(bytes.c_str(), a[0], a[1], std::move(pins));
+                                break;
+                        case REC_INIT_EDGES:
+                                fr.initEdges();
+                                break;
+                        case REC_ADJUSTMENT:
+                                fr.addAdjustment(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+                                break;
+                        case REC_EDGE_CAPACITIES:
+                                fr.setEdgeCapacities(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+                                break;
+                        case REC_SCALE_EDGE_CAPACITIES:
+                                fr.scaleEdgeCapacities(a[0], a[1], a[2], a[3], a[4], a[5], bitsFloat(a[6]));
+                                break;
+                        case REC_LAYER_CAPACITIES:
+                                fr.setLayerCapacities(a[0], a[1], a + 3, a[2]);
+                                break;
+                        case REC_NUM_THREADS:
+                                fr.setNumThreads(a[0]);
+                                break;
+                        case REC_MAX_RUNTIME:
+                                fr.setMaxRuntime(bitsFloat(a[0]));
+                                break;
+                        case REC_MAX_MAZE_ROUND:
+                                fr.setMaxMazeRound(a[0]);
+                                break;
+                        case REC_OVERFLOW_PLATEAU:
+                                fr.setOverflowPlateau(a[0]);
+                                break;
+                        case REC_MULTI_START:
+                                fr.setMultiStart(a[0], a[1]);
+                                break;
+                        case REC_HILBERT_NET_ORDER:
+                                fr.setHilbertNetOrder(a[0]);
+                                break;
+                        case REC_VERIFICATION_LEVEL:
+                                fr.setVerificationLevel(a[0]);
+                                break;
+                        case REC_INIT_AUX_VAR:
+                                fr.initAuxVar();
+                                return true;
+                        default:
+                                printf("Unknown record %d\n", op);
+                                return false;
+                }
+        }
+        printf("The recording ends before initAuxVar\n");
+        return false;
+}
+
+int main(int argc, char **argv) {
+        std::vector<NET> result;
+        VERIFICATION stats;
+        FILE *file;
+        FT fr;
+
+        if (argc < 2) {
+                printf("Usage: %s <recording> [# threads] [routes file]\n", argv[0]);
+                return 1;
+        }
+
+        file = fopen(argv[1], "rb");
+        if (file == NULL) {
+                printf("Error opening %s\n", argv[1]);
+                return 1;
+        }
+        if (!readRecordingHeader(file)) {
+                printf("%s is not a recording of version %d\n", argv[1], RECORDING_VERSION);
+                fclose(file);
+                return 1;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        bool complete = replay(file, fr);
+        fclose(file);
+        if (!complete)
+                return 1;
+        auto loaded = std::chrono::steady_clock::now();
+
+        // the recorded number of threads, unless given
+        if (argc > 2)
+                fr.setNumThreads(atoi(argv[2]));
+        fr.run(result);
+        auto routed = std::chrono::steady_clock::now();
+
+        stats = fr.getVerification();
+        printf("replay %.3f s, routing %.3f s, %d nets\n",
+               std::chrono::duration<double>(loaded - start).count(),
+               std::chrono::duration<double>(routed - loaded).count(), (int)result.size());
+        if (stats.level != VERIFICATION_NONE)
+                printf("length %d, vias %d, overflow %d\n", stats.length, stats.numVias, stats.overflow);
+
+        if (argc > 3) {
+                file = fopen(argv[3], "w");
+                if (file == NULL) {
+                        printf("Error opening %s\n", argv[3]);
+                        return 1;
+                }
+                for (const NET &net : result) {
+                        fprintf(file, "%s", net.name.c_str());
+                        for (const ROUTE &route : net.route) {
+                                fprintf(file, " %ld,%ld,%d-%ld,%ld,%d", route.initX, route.initY, route.initLayer,
+                                        route.finalX, route.finalY, route.finalLayer);
+                        }
+                        fprintf(file, "\n");
+                }
+                fclose(file);
+        }
+
+        return 0;
+}
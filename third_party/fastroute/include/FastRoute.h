@@ -63,13 +63,26 @@ typedef struct {
         std::vector<ROUTE> route;
 } NET;
 
-std::map<std::string, std::vector<PIN>> allNets;
-int maxNetDegree;
+// verification levels of the final routes: none, statistics (length, vias and
+// overflow) or statistics and route connectivity
+enum { VERIFICATION_NONE,
+       VERIFICATION_FAST,
+       VERIFICATION_FULL };
+
+typedef struct {
+        int level;
+        int length;        // wire length in gcell edges
+        int numVias;
+        int overflow;      // total overflow of the 3D edges
+        int floatingPins;  // pins that do not reach the first layer
+        int brokenRoutes;  // route ends, steps and layers that do not connect the tree
+} VERIFICATION;
 
 class FT {
        public:
         FT() = default;
 
+        void startRecording(const char *fileName);
         void setGridsAndLayers(int x, int y, int nLayers);
         void addVCapacity(int verticalCapacity, int layer);
         void addHCapacity(int horizontalCapacity, int layer);
@@ -80,10 +93,14 @@ class FT {
         void setLowerLeft(int x, int y);
         void setTileSize(int width, int height);
         void setLayerOrientation(int x);
-        void addNet(char *name, int netIdx, int nPIns, int minWIdth, PIN pins[]);
+        void addNet(const char *name, int netIdx, int nPIns, int minWIdth, const PIN pins[]);
+        void addNet(const char *name, int netIdx, int minWidth, std::vector<PIN> &&pins);
         void initEdges();
-        void setNumAdjustments(int nAdjustements);
         void addAdjustment(long x1, long y1, int l1, long x2, long y2, int l2, int reducedCap, bool isReduce = true);
+        void setEdgeCapacities(int layer, bool horizontal, long x1, long y1, long x2, long y2, int cap, bool isReduce = true);
+        void scaleEdgeCapacities(int layer, bool horizontal, long x1, long y1, long x2, long y2, float factor);
+        void getLayerCapacities(int layer, bool horizontal, int *caps);
+        void setLayerCapacities(int layer, bool horizontal, const int *caps, bool isReduce = true);
         void initAuxVar();
         int run(std::vector<NET> &);
         std::vector<NET> getResults();
@@ -91,6 +108,20 @@ class FT {
         int getEdgeCapacity(long x1, long y1, int l1, long x2, long y2, int l2);
         std::map<std::string, std::vector<PIN>> getNets();
         void setMaxNetDegree(int);
+        void setNumThreads(int);
+        void setMaxRuntime(float);
+        void setMaxMazeRound(int);
+        void setOverflowPlateau(int);
+        void setMultiStart(int, int);
+        void setHilbertNetOrder(bool);
+        void setVerificationLevel(int);
+        VERIFICATION getVerification();
+
+       private:
+        // gcells of the distinct pins of the net being added and the record
+        // of the net, reused across nets
+        std::vector<int> pinXarray, pinYarray, pinLarray;
+        std::vector<int> netRecord;
 };
 }  // namespace FastRoute
 #endif /* __FASTROUTE_API__ */
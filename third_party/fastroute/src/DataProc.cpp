@@ -50,6 +50,14 @@ int numLayers;
 int totalNumSeg;    // total # segments
 int totalOverflow;  // total # overflow
 int mazeThreshold;  // the wirelen threshold to do maze routing
+int numThreads = 1;  // # threads used by the parallel passes
+float maxRuntime = 0;  // wall-clock budget of FT::run in seconds, 0 for none
+int maxMazeRound = 500;  // max # 2D maze rounds
+int plateauRound = 0;  // # rounds without a better overflow before stopping, 0 for none
+int numVariants = 1;  // # speculative variants of the maze rounds, 1 for none
+int variantRound = 5;  // # maze rounds of each speculative phase
+Bool hilbertOrder = FALSE;  // renumber the nets along a Hilbert curve before routing
+VerifyLevel verifyLevel = VERIFY_FULL;  // checks of the final 3D routes
 Net** nets;
 Edge *h_edges, *v_edges;
 float d1[YRANGE][XRANGE];
@@ -94,9 +102,10 @@ OrderTree* treeOrderCong;
 int numTreeedges;
 int viacost;
 
-int layerGrid[MAXLAYER][MAXLEN];
-int gridD[MAXLAYER][MAXLEN];
-int viaLink[MAXLAYER][MAXLEN];
+// layer assignment DP of a tree edge, the layers of a grid step are contiguous
+int layerGrid[MAXLEN][MAXLAYER];
+int gridD[MAXLEN][MAXLAYER];
+int viaLink[MAXLEN][MAXLAYER];
 
 int d13D[MAXLAYER][YRANGE][XRANGE];
 short d23D[MAXLAYER][YRANGE][XRANGE];
@@ -116,9 +125,9 @@ short** heap23D;
 float *h_costTable, *v_costTable;
 Bool stopDEC, errorPRONE;
 OrderNetEdge *netEO;
-int *xcor, *ycor, *dcor;
 
 StTree* sttreesBK;
+int *bkNets, numBkNets;
 
 short **parentX1, **parentY1, **parentX3, **parentY3;
 
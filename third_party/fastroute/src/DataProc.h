@@ -58,6 +58,14 @@ extern int numLayers;
 extern int totalNumSeg;    // total # segments
 extern int totalOverflow;  // total # overflow
 extern int mazeThreshold;  // the wirelen threshold to do maze routing
+extern int numThreads;     // # threads used by the parallel passes
+extern float maxRuntime;   // wall-clock budget of FT::run in seconds, 0 for none
+extern int maxMazeRound;   // max # 2D maze rounds
+extern int plateauRound;   // # rounds without a better overflow before stopping, 0 for none
+extern int numVariants;    // # speculative variants of the maze rounds, 1 for none
+extern int variantRound;   // # maze rounds of each speculative phase
+extern Bool hilbertOrder;  // renumber the nets along a Hilbert curve before routing
+extern VerifyLevel verifyLevel;  // checks of the final 3D routes
 extern Net **nets;
 extern Edge *h_edges, *v_edges;
 
@@ -103,9 +111,10 @@ extern int viacost;
 extern Edge3D *h_edges3D;
 extern Edge3D *v_edges3D;
 
-extern int layerGrid[MAXLAYER][MAXLEN];
-extern int gridD[MAXLAYER][MAXLEN];
-extern int viaLink[MAXLAYER][MAXLEN];
+// layer assignment DP of a tree edge, the layers of a grid step are contiguous
+extern int layerGrid[MAXLEN][MAXLAYER];
+extern int gridD[MAXLEN][MAXLAYER];
+extern int viaLink[MAXLEN][MAXLAYER];
 
 extern int d13D[MAXLAYER][YRANGE][XRANGE];
 extern short d23D[MAXLAYER][YRANGE][XRANGE];
@@ -127,9 +136,8 @@ extern float *h_costTable, *v_costTable;
 extern Bool stopDEC, errorPRONE;
 extern OrderNetEdge *netEO;
 
-extern int *xcor, *ycor, *dcor;
-
-extern StTree *sttreesBK;
+extern StTree *sttreesBK;  // trees of the nets rerouted since the best solution (copyRS), as they were then
+extern int *bkNets, numBkNets;  // the nets saved in sttreesBK
 
 extern short **parentX1, **parentY1, **parentX3, **parentY3;
 
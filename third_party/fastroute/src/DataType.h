@@ -59,8 +59,8 @@ typedef struct
 {
         char name[200];  // net name
         int netIDorg;   // orginal net ID in the input file
-        short numPins;  // number of pins in the net
-        short deg;      // net degree (number of MazePoints connecting by the net, pins in same MazePoints count only 1)
+        int numPins;    // number of pins in the net
+        int deg;        // net degree (number of MazePoints connecting by the net, pins in same MazePoints count only 1)
         short *pinX;    // array of X coordinates of pins
         short *pinY;    // array of Y coordinates of pins
         short *pinL;    // array of L coordinates of pins
@@ -95,8 +95,8 @@ typedef struct
         short heights[6];
 
         short x, y;     // position in the grid graph
-        short nbr[3];   // three neighbors
-        short edge[3];  // three adjacent edges
+        int nbr[3];     // three neighbors
+        int edge[3];    // three adjacent edges
         int hID;
         int lID;
         int eID[6];
@@ -181,6 +181,20 @@ typedef enum { NONE,
                VERT,
                BID } viaST;
 
+// checks of the final 3D routes in FT::run, see checkRoutes3D
+typedef enum { VERIFY_NONE,
+               VERIFY_FAST,
+               VERIFY_FULL } VerifyLevel;
+
+typedef struct
+{
+        int numVia;       // # layer changes along the routes
+        int floatPins;    // pin nodes that do not reach the first layer
+        int badEnds;      // routes that do not start and end at the nodes of their tree edge
+        int badSteps;     // route steps between grid points that are not adjacent
+        int badLayers;    // route points on a negative layer
+} RouteCheck;
+
 }  // namespace FastRoute
 
 #endif /* __DATATYPE_H__ */
@@ -32,6 +32,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <algorithm>
+#include <vector>
 
 #include "DataType.h"
 #include "flute.h"
@@ -44,12 +45,96 @@ namespace FastRoute {
 #define HORIZONTAL 1
 #define VERTICAL 0
 
+// Row and column sums of est_usage inside the bounding box of a tree, built
+// lazily the first time a row or a column is used. est_usage does not change
+// while the tree is shifted, and the shifts stay inside the bounding box, so
+// every segment cost is one subtraction. The usages are truncated to int
+// before they are summed, which is what the int accumulation did.
+typedef struct
+{
+        int xMin, yMin, w, h;
+        std::vector<int> hRow;  // start of the prefix of row y - yMin in sums, -1 if not built
+        std::vector<int> vCol;  // start of the prefix of column x - xMin in sums, -1 if not built
+        std::vector<int> sums;  // a row has w entries, sum[i] = usage of h-edges [xMin, xMin+i), a column h entries
+} ShiftCost;
+
+static void initShiftCost(ShiftCost *sc, Flute::Tree *t) {
+        int i, xMax, yMax;
+
+        sc->xMin = xMax = t->branch[0].x;
+        sc->yMin = yMax = t->branch[0].y;
+        for (i = 1; i < 2 * t->deg - 2; i++) {
+                sc->xMin = std::min(sc->xMin, (int)t->branch[i].x);
+                sc->yMin = std::min(sc->yMin, (int)t->branch[i].y);
+                xMax = std::max(xMax, (int)t->branch[i].x);
+                yMax = std::max(yMax, (int)t->branch[i].y);
+        }
+        sc->w = xMax - sc->xMin + 1;
+        sc->h = yMax - sc->yMin + 1;
+        sc->hRow.assign(sc->h, -1);
+        sc->vCol.assign(sc->w, -1);
+}
+
+// usage of the h-edges [x1, x2) in row y
+static int hCost(ShiftCost *sc, int y, int x1, int x2) {
+        int i, grid, r;
+        int *sum;
+
+        r = y - sc->yMin;
+        if (sc->hRow[r] < 0) {
+                sc->hRow[r] = sc->sums.size();
+                sc->sums.resize(sc->sums.size() + sc->w);
+                sum = &sc->sums[sc->hRow[r]];
+                grid = y * (xGrid - 1) + sc->xMin;
+                sum[0] = 0;
+                for (i = 1; i < sc->w; i++)
+                        sum[i] = sum[i - 1] + (int)h_edges[grid + i - 1].est_usage;
+        }
+        sum = &sc->sums[sc->hRow[r]];
+        return sum[x2 - sc->xMin] - sum[x1 - sc->xMin];
+}
+
+// usage of the v-edges [y1, y2) in column x
+static int vCost(ShiftCost *sc, int x, int y1, int y2) {
+        int i, grid, c;
+        int *sum;
+
+        c = x - sc->xMin;
+        if (sc->vCol[c] < 0) {
+                sc->vCol[c] = sc->sums.size();
+                sc->sums.resize(sc->sums.size() + sc->h);
+                sum = &sc->sums[sc->vCol[c]];
+                grid = sc->yMin * xGrid + x;
+                sum[0] = 0;
+                for (i = 1; i < sc->h; i++) {
+                        sum[i] = sum[i - 1] + (int)v_edges[grid].est_usage;
+                        grid += xGrid;
+                }
+        }
+        sum = &sc->sums[sc->vCol[c]];
+        return sum[y2 - sc->yMin] - sum[y1 - sc->yMin];
+}
+
+// usage of the cheaper L connection between (xa, ya) and (xb, yb)
+static int lCost(ShiftCost *sc, int xa, int ya, int xb, int yb) {
+        int smallX, bigX, smallY, bigY, cost1, cost2;
+
+        smallX = std::min(xa, xb);
+        bigX = std::max(xa, xb);
+        smallY = std::min(ya, yb);
+        bigY = std::max(ya, yb);
+        cost1 = hCost(sc, smallY, smallX, bigX) + vCost(sc, bigX, smallY, bigY);
+        cost2 = hCost(sc, bigY, smallX, bigX) + vCost(sc, smallX, smallY, bigY);
+        return std::min(cost1, cost2);
+}
+
 int edgeShift(Flute::Tree *t, int net) {
-        int i, j, k, l, m, deg, root, x, y, n, n1, n2, n3;
-        int maxX, minX, maxY, minY, maxX1, minX1, maxY1, minY1, maxX2, minX2, maxY2, minY2, bigX, smallX, bigY, smallY, grid, grid1, grid2;
+        int i, j, l, deg, root, x, y, n, n1, n2, n3;
+        int maxX, minX, maxY, minY, maxX1, minX1, maxY1, minY1, maxX2, minX2, maxY2, minY2;
         int pairCnt;
         int benefit, bestBenefit, bestCost;
-        int cost1, cost2, bestPair, Pos, bestPos, numShift = 0;
+        int bestPair, Pos, bestPos, numShift = 0;
+        ShiftCost sc;
 
         // TODO: check this size
         const int sizeV = 2 * nets[net]->numPins;
@@ -61,6 +146,7 @@ int edgeShift(Flute::Tree *t, int net) {
         int costV[xGrid];
 
         deg = t->deg;
+        initShiftCost(&sc, t);
         // find root of the tree
         for (i = deg; i < 2 * deg - 2; i++) {
                 if (t->branch[i].n == i) {
@@ -158,81 +244,19 @@ int edgeShift(Flute::Tree *t, int net) {
                                 if (minY < maxY)  // more than 1 possible positions
                                 {
                                         for (j = minY; j <= maxY; j++) {
-                                                costH[j] = 0;
-                                                grid = j * (xGrid - 1);
-                                                for (k = t->branch[n1].x; k < t->branch[n2].x; k++) {
-                                                        costH[j] += h_edges[grid + k].est_usage;
-                                                }
+                                                costH[j] = hCost(&sc, j, t->branch[n1].x, t->branch[n2].x);
                                                 // add the cost of all edges adjacent to the two steiner nodes
                                                 for (l = 0; l < nbrCnt[n1]; l++) {
                                                         n3 = nbr[n1][l];
                                                         if (n3 != n2)  // exclude current edge n1-n2
-                                                        {
-                                                                cost1 = cost2 = 0;
-                                                                if (t->branch[n1].x < t->branch[n3].x) {
-                                                                        smallX = t->branch[n1].x;
-                                                                        bigX = t->branch[n3].x;
-                                                                } else {
-                                                                        smallX = t->branch[n3].x;
-                                                                        bigX = t->branch[n1].x;
-                                                                }
-                                                                if (j < t->branch[n3].y) {
-                                                                        smallY = j;
-                                                                        bigY = t->branch[n3].y;
-                                                                } else {
-                                                                        smallY = t->branch[n3].y;
-                                                                        bigY = j;
-                                                                }
-                                                                grid1 = smallY * (xGrid - 1);
-                                                                grid2 = bigY * (xGrid - 1);
-                                                                for (m = smallX; m < bigX; m++) {
-                                                                        cost1 += h_edges[grid1 + m].est_usage;
-                                                                        cost2 += h_edges[grid2 + m].est_usage;
-                                                                }
-                                                                grid1 = smallY * xGrid;
-                                                                for (m = smallY; m < bigY; m++) {
-                                                                        cost1 += v_edges[grid1 + bigX].est_usage;
-                                                                        cost2 += v_edges[grid1 + smallX].est_usage;
-                                                                        grid1 += xGrid;
-                                                                }
-                                                                costH[j] += std::min(cost1, cost2);
-                                                        }  // if(n3!=n2)
-                                                }          // loop l
+                                                                costH[j] += lCost(&sc, t->branch[n1].x, j, t->branch[n3].x, t->branch[n3].y);
+                                                }
                                                 for (l = 0; l < nbrCnt[n2]; l++) {
                                                         n3 = nbr[n2][l];
                                                         if (n3 != n1)  // exclude current edge n1-n2
-                                                        {
-                                                                cost1 = cost2 = 0;
-                                                                if (t->branch[n2].x < t->branch[n3].x) {
-                                                                        smallX = t->branch[n2].x;
-                                                                        bigX = t->branch[n3].x;
-                                                                } else {
-                                                                        smallX = t->branch[n3].x;
-                                                                        bigX = t->branch[n2].x;
-                                                                }
-                                                                if (j < t->branch[n3].y) {
-                                                                        smallY = j;
-                                                                        bigY = t->branch[n3].y;
-                                                                } else {
-                                                                        smallY = t->branch[n3].y;
-                                                                        bigY = j;
-                                                                }
-                                                                grid1 = smallY * (xGrid - 1);
-                                                                grid2 = bigY * (xGrid - 1);
-                                                                for (m = smallX; m < bigX; m++) {
-                                                                        cost1 += h_edges[grid1 + m].est_usage;
-                                                                        cost2 += h_edges[grid2 + m].est_usage;
-                                                                }
-                                                                grid1 = smallY * xGrid;
-                                                                for (m = smallY; m < bigY; m++) {
-                                                                        cost1 += v_edges[grid1 + bigX].est_usage;
-                                                                        cost2 += v_edges[grid1 + smallX].est_usage;
-                                                                        grid1 += xGrid;
-                                                                }
-                                                                costH[j] += std::min(cost1, cost2);
-                                                        }  //if(n3!=n1)
-                                                }          // loop l
-                                        }                  // loop j
+                                                                costH[j] += lCost(&sc, t->branch[n2].x, j, t->branch[n3].x, t->branch[n3].y);
+                                                }
+                                        }  // loop j
                                         bestCost = BIG_INT;
                                         Pos = t->branch[n1].y;
                                         for (j = minY; j <= maxY; j++) {
@@ -278,80 +302,19 @@ int edgeShift(Flute::Tree *t, int net) {
                                 if (minX < maxX)  // more than 1 possible positions
                                 {
                                         for (j = minX; j <= maxX; j++) {
-                                                costV[j] = 0;
-                                                for (k = t->branch[n1].y; k < t->branch[n2].y; k++) {
-                                                        costV[j] += v_edges[k * xGrid + j].est_usage;
-                                                }
+                                                costV[j] = vCost(&sc, j, t->branch[n1].y, t->branch[n2].y);
                                                 // add the cost of all edges adjacent to the two steiner nodes
                                                 for (l = 0; l < nbrCnt[n1]; l++) {
                                                         n3 = nbr[n1][l];
                                                         if (n3 != n2)  // exclude current edge n1-n2
-                                                        {
-                                                                cost1 = cost2 = 0;
-                                                                if (j < t->branch[n3].x) {
-                                                                        smallX = j;
-                                                                        bigX = t->branch[n3].x;
-                                                                } else {
-                                                                        smallX = t->branch[n3].x;
-                                                                        bigX = j;
-                                                                }
-                                                                if (t->branch[n1].y < t->branch[n3].y) {
-                                                                        smallY = t->branch[n1].y;
-                                                                        bigY = t->branch[n3].y;
-                                                                } else {
-                                                                        smallY = t->branch[n3].y;
-                                                                        bigY = t->branch[n1].y;
-                                                                }
-                                                                grid1 = smallY * (xGrid - 1);
-                                                                grid2 = bigY * (xGrid - 1);
-                                                                for (m = smallX; m < bigX; m++) {
-                                                                        cost1 += h_edges[grid1 + m].est_usage;
-                                                                        cost2 += h_edges[grid2 + m].est_usage;
-                                                                }
-                                                                grid1 = smallY * xGrid;
-                                                                for (m = smallY; m < bigY; m++) {
-                                                                        cost1 += v_edges[grid1 + bigX].est_usage;
-                                                                        cost2 += v_edges[grid1 + smallX].est_usage;
-                                                                        grid1 += xGrid;
-                                                                }
-                                                                costV[j] += std::min(cost1, cost2);
-                                                        }  // if(n3!=n2)
-                                                }          // loop l
+                                                                costV[j] += lCost(&sc, j, t->branch[n1].y, t->branch[n3].x, t->branch[n3].y);
+                                                }
                                                 for (l = 0; l < nbrCnt[n2]; l++) {
                                                         n3 = nbr[n2][l];
                                                         if (n3 != n1)  // exclude current edge n1-n2
-                                                        {
-                                                                cost1 = cost2 = 0;
-                                                                if (j < t->branch[n3].x) {
-                                                                        smallX = j;
-                                                                        bigX = t->branch[n3].x;
-                                                                } else {
-                                                                        smallX = t->branch[n3].x;
-                                                                        bigX = j;
-                                                                }
-                                                                if (t->branch[n2].y < t->branch[n3].y) {
-                                                                        smallY = t->branch[n2].y;
-                                                                        bigY = t->branch[n3].y;
-                                                                } else {
-                                                                        smallY = t->branch[n3].y;
-                                                                        bigY = t->branch[n2].y;
-                                                                }
-                                                                grid1 = smallY * (xGrid - 1);
-                                                                grid2 = bigY * (xGrid - 1);
-                                                                for (m = smallX; m < bigX; m++) {
-                                                                        cost1 += h_edges[grid1 + m].est_usage;
-                                                                        cost2 += h_edges[grid2 + m].est_usage;
-                                                                }
-                                                                grid1 = smallY * xGrid;
-                                                                for (m = smallY; m < bigY; m++) {
-                                                                        cost1 += v_edges[grid1 + bigX].est_usage;
-                                                                        cost2 += v_edges[grid1 + smallX].est_usage;
-                                                                        grid1 += xGrid;
-                                                                }
-                                                                costV[j] += std::min(cost1, cost2);
-                                                        }  //if(n3!=n1)
-                                                }          // loop l
-                                        }                  // loop j
+                                                                costV[j] += lCost(&sc, j, t->branch[n2].y, t->branch[n3].x, t->branch[n3].y);
+                                                }
+                                        }  // loop j
                                         bestCost = BIG_INT;
                                         Pos = t->branch[n1].x;
                                         for (j = minX; j <= maxX; j++) {
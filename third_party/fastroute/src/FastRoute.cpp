@@ -40,6 +40,9 @@
 #include <math.h>
 #include <time.h>
 #include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
 #include "DataType.h"
 #include "flute.h"
 #include "DataProc.h"
@@ -50,6 +53,8 @@
 #include "RipUp.h"
 #include "route.h"
 #include "maze3D.h"
+#include "MultiStart.h"
+#include "Recording.h"
 #include <iostream>
 
 namespace FastRoute {
@@ -57,12 +62,23 @@ namespace FastRoute {
 int newnetID = 0;
 int segcount = 0;
 int pinInd;
-int numAdjust;
 int vCapacity = 0;
 int hCapacity = 0;
 int MD = 0;
+VERIFICATION verification;  // checks of the last run
+std::map<std::string, std::vector<PIN>> allNets;
+int maxNetDegree;
+
+// the calls until initAuxVar are recorded in fileName, see Recording.h
+void FT::startRecording(const char *fileName) {
+        if (openRecording(fileName))
+                printf("Recording the routing input in %s\n", fileName);
+}
 
 void FT::setGridsAndLayers(int x, int y, int nLayers) {
+        int args[] = {x, y, nLayers};
+        record(REC_GRIDS_AND_LAYERS, args, 3);
+
         xGrid = x;
         yGrid = y;
         numLayers = nLayers;
@@ -70,58 +86,92 @@ void FT::setGridsAndLayers(int x, int y, int nLayers) {
 }
 
 void FT::addVCapacity(int verticalCapacity, int layer) {
+        int args[] = {verticalCapacity, layer};
+        record(REC_V_CAPACITY, args, 2);
+
         vCapacity3D[layer - 1] = verticalCapacity;
         vCapacity += vCapacity3D[layer - 1];
 }
 
 void FT::addHCapacity(int horizontalCapacity, int layer) {
+        int args[] = {horizontalCapacity, layer};
+        record(REC_H_CAPACITY, args, 2);
+
         hCapacity3D[layer - 1] = horizontalCapacity;
         hCapacity += hCapacity3D[layer - 1];
 }
 
 void FT::addMinWidth(int width, int layer) {
+        int args[] = {width, layer};
+        record(REC_MIN_WIDTH, args, 2);
+
         MinWidth[layer - 1] = width;
 }
 
 void FT::addMinSpacing(int spacing, int layer) {
+        int args[] = {spacing, layer};
+        record(REC_MIN_SPACING, args, 2);
+
         MinSpacing[layer - 1] = spacing;
 }
 
 void FT::addViaSpacing(int spacing, int layer) {
+        int args[] = {spacing, layer};
+        record(REC_VIA_SPACING, args, 2);
+
         ViaSpacing[layer - 1] = spacing;
 }
 
 void FT::setNumberNets(int nNets) {
+        int arg = nNets;
+        record(REC_NUMBER_NETS, &arg, 1);
+
         numNets = nNets;
 }
 
 void FT::setLowerLeft(int x, int y) {
+        int args[] = {x, y};
+        record(REC_LOWER_LEFT, args, 2);
+
         xcorner = x;
         ycorner = y;
 }
 
 void FT::setTileSize(int width, int height) {
+        int args[] = {width, height};
+        record(REC_TILE_SIZE, args, 2);
+
         wTile = width;
         hTile = height;
 }
 
 void FT::setLayerOrientation(int x) {
+        int arg = x;
+        record(REC_LAYER_ORIENTATION, &arg, 1);
+
         printf("layerOrientation = %d\n", layerOrientation);
         layerOrientation = x;
         printf("layerOrientation = %d\n", layerOrientation);
 }
 
-void FT::addNet(char *name, int netIdx, int nPins, int minWidth, PIN pins[]) {
+void FT::addNet(const char *name, int netIdx, int nPins, int minWidth, const PIN pins[]) {
+        addNet(name, netIdx, minWidth, std::vector<PIN>(pins, pins + nPins));
+}
+
+// The pins are kept for getNets, so they are moved in instead of copied
+void FT::addNet(const char *name, int netIdx, int minWidth, std::vector<PIN> &&pins) {
         int TD;
         int i, j, k;
         int pinX, pinY, pinL, netID, numPins, minwidth;
         long pinX_in, pinY_in;
         Bool remove;
 
-        // TODO: check this size
-        int pinXarray[nPins];
-        int pinYarray[nPins];
-        int pinLarray[nPins];
+        numPins = pins.size();
+        if ((int)pinXarray.size() < numPins) {
+                pinXarray.resize(numPins);
+                pinYarray.resize(numPins);
+                pinLarray.resize(numPins);
+        }
 
         if (nets == NULL) {
                 nets = (Net **)malloc(numNets * sizeof(Net *));
@@ -131,17 +181,20 @@ void FT::addNet(char *name, int netIdx, int nPins, int minWidth, PIN pins[]) {
         }
 
         netID = netIdx;
-        numPins = nPins;
         minwidth = minWidth;
 
-        std::string netName(name);
-        std::vector<PIN> netPins;
-        for (int p = 0; p < numPins; p++) {
-                netPins.push_back(pins[p]);
+        if (isRecording()) {
+                netRecord.resize(2 + 3 * numPins);
+                netRecord[0] = netIdx;
+                netRecord[1] = minWidth;
+                for (j = 0; j < numPins; j++) {
+                        netRecord[2 + 3 * j] = pins[j].x;
+                        netRecord[3 + 3 * j] = pins[j].y;
+                        netRecord[4 + 3 * j] = pins[j].layer;
+                }
+                record(REC_NET, netRecord.data(), netRecord.size(), name, strlen(name));
         }
 
-        allNets[netName] = netPins;
-
         // TODO: check this, there was an if pinInd < 2000
         pinInd = 0;
         for (j = 0; j < numPins; j++) {
@@ -188,6 +241,8 @@ void FT::addNet(char *name, int netIdx, int nPins, int minWidth, PIN pins[]) {
                 newnetID++;
                 segcount += 2 * pinInd - 3;  // at most (2*numPins-2) nodes, (2*numPins-3) nets for a net
         }                                    // if
+
+        allNets[name] = std::move(pins);
 }
 
 std::map<std::string, std::vector<PIN>> FT::getNets() {
@@ -195,6 +250,8 @@ std::map<std::string, std::vector<PIN>> FT::getNets() {
 }
 
 void FT::initEdges() {
+        record(REC_INIT_EDGES, NULL, 0);
+
         LB = 0.9;
         UB = 1.3;
         int grid, j, k, i;
@@ -263,59 +320,116 @@ void FT::initEdges() {
         }
 }
 
-void FT::setNumAdjustments(int nAdjustments) {
-        numAdjust = nAdjustments;
+// sets the capacity of a 3D edge and takes the reduction from its 2D edge
+static void adjustEdge(Edge3D *edge3D, Edge *edge, int reducedCap, bool isReduce) {
+        int reduce, cap;
+
+        cap = edge3D->cap;
+
+        if ((cap - reducedCap) < 0) {
+                if (isReduce) {
+                        std::cout << "Warning: underflow in reduce\n";
+                        std::cout << "cap, reducedCap: " << cap << ", " << reducedCap << "\n";
+                }
+                reduce = 0;
+        } else {
+                reduce = cap - reducedCap;
+        }
+
+        edge3D->cap = reducedCap;
+        edge3D->red = reduce;
+        edge->cap -= reduce;
+        edge->red += reduce;
 }
 
 void FT::addAdjustment(long x1, long y1, int l1, long x2, long y2, int l2, int reducedCap, bool isReduce) {
         int grid, k;
-        int reduce, cap;
-        reducedCap = reducedCap;
+        int args[] = {(int)x1, (int)y1, l1, (int)x2, (int)y2, l2, reducedCap, isReduce};
+
+        record(REC_ADJUSTMENT, args, 8);
 
         k = l1 - 1;
 
         if (y1 == y2)  //horizontal edge
         {
-                grid = y1 * (xGrid - 1) + x1 + k * (xGrid - 1) * yGrid;
-                cap = h_edges3D[grid].cap;
-
-                if (((int)cap - reducedCap) < 0) {
-                        if (isReduce) {
-                                std::cout << "Warning: underflow in reduce\n";
-                                std::cout << "cap, reducedCap: " << cap << ", " << reducedCap << "\n";
-                        }
-                        reduce = 0;
-                } else {
-                        reduce = cap - reducedCap;
-                }
-
-                h_edges3D[grid].cap = reducedCap;
-                h_edges3D[grid].red = reduce;
                 grid = y1 * (xGrid - 1) + x1;
-                h_edges[grid].cap -= reduce;
-                h_edges[grid].red += reduce;
-
+                adjustEdge(&h_edges3D[grid + k * (xGrid - 1) * yGrid], &h_edges[grid], reducedCap, isReduce);
         } else if (x1 == x2)  //vertical edge
         {
-                grid = y1 * xGrid + x1 + k * xGrid * (yGrid - 1);
-                cap = v_edges3D[grid].cap;
-                reduce = cap - reducedCap;
+                grid = y1 * xGrid + x1;
+                adjustEdge(&v_edges3D[grid + k * xGrid * (yGrid - 1)], &v_edges[grid], reducedCap, isReduce);
+        }
+}
 
-                if (((int)cap - reducedCap) < 0) {
-                        if (isReduce) {
-                                std::cout << "Warning: underflow in reduce\n";
-                                std::cout << "cap, reducedCap: " << cap << ", " << reducedCap << "\n";
-                        }
-                        reduce = 0;
-                } else {
-                        reduce = cap - reducedCap;
+// The bulk adjustments below work on the horizontal or vertical edges of a
+// layer. An edge is named by its lower left gcell, as in addAdjustment, and
+// the ranges include both ends. Rows of edges are walked in memory order and
+// the 2D edges are updated in the same pass.
+
+// sets the capacity of the edges in [x1, x2] x [y1, y2]
+void FT::setEdgeCapacities(int layer, bool horizontal, long x1, long y1, long x2, long y2, int cap, bool isReduce) {
+        int width = horizontal ? xGrid - 1 : xGrid;
+        Edge3D *edges3D = horizontal ? &h_edges3D[(layer - 1) * (xGrid - 1) * yGrid] : &v_edges3D[(layer - 1) * xGrid * (yGrid - 1)];
+        Edge *edges = horizontal ? h_edges : v_edges;
+        long x, y;
+        int args[] = {layer, horizontal, (int)x1, (int)y1, (int)x2, (int)y2, cap, isReduce};
+
+        record(REC_EDGE_CAPACITIES, args, 8);
+        for (y = y1; y <= y2; y++) {
+                for (x = x1; x <= x2; x++)
+                        adjustEdge(&edges3D[y * width + x], &edges[y * width + x], cap, isReduce);
+        }
+}
+
+// multiplies the capacity of the edges in [x1, x2] x [y1, y2] by factor, rounding down
+void FT::scaleEdgeCapacities(int layer, bool horizontal, long x1, long y1, long x2, long y2, float factor) {
+        int width = horizontal ? xGrid - 1 : xGrid;
+        Edge3D *edges3D = horizontal ? &h_edges3D[(layer - 1) * (xGrid - 1) * yGrid] : &v_edges3D[(layer - 1) * xGrid * (yGrid - 1)];
+        Edge *edges = horizontal ? h_edges : v_edges;
+        long x, y;
+        int grid;
+        int args[] = {layer, horizontal, (int)x1, (int)y1, (int)x2, (int)y2, floatBits(factor)};
+
+        record(REC_SCALE_EDGE_CAPACITIES, args, 7);
+        for (y = y1; y <= y2; y++) {
+                for (x = x1; x <= x2; x++) {
+                        grid = y * width + x;
+                        adjustEdge(&edges3D[grid], &edges[grid], floor((float)edges3D[grid].cap * factor), true);
                 }
+        }
+}
 
-                v_edges3D[grid].cap = reducedCap;
-                v_edges3D[grid].red = reduce;
-                grid = y1 * xGrid + x1;
-                v_edges[grid].cap -= reduce;
-                v_edges[grid].red += reduce;
+// copies the capacities of the edges of a layer to caps, row by row: yGrid rows
+// of xGrid - 1 horizontal edges or yGrid - 1 rows of xGrid vertical edges
+void FT::getLayerCapacities(int layer, bool horizontal, int *caps) {
+        int numEdges = horizontal ? (xGrid - 1) * yGrid : xGrid * (yGrid - 1);
+        Edge3D *edges3D = horizontal ? &h_edges3D[(layer - 1) * numEdges] : &v_edges3D[(layer - 1) * numEdges];
+        int grid;
+
+        for (grid = 0; grid < numEdges; grid++)
+                caps[grid] = edges3D[grid].cap;
+}
+
+// sets the capacities of the edges of a layer from caps, laid out as in
+// getLayerCapacities; the edges whose capacity does not change are skipped
+void FT::setLayerCapacities(int layer, bool horizontal, const int *caps, bool isReduce) {
+        int numEdges = horizontal ? (xGrid - 1) * yGrid : xGrid * (yGrid - 1);
+        Edge3D *edges3D = horizontal ? &h_edges3D[(layer - 1) * numEdges] : &v_edges3D[(layer - 1) * numEdges];
+        Edge *edges = horizontal ? h_edges : v_edges;
+        int grid;
+
+        if (isRecording()) {
+                std::vector<int> args(3 + numEdges);
+                args[0] = layer;
+                args[1] = horizontal;
+                args[2] = isReduce;
+                std::copy(caps, caps + numEdges, args.begin() + 3);
+                record(REC_LAYER_CAPACITIES, args.data(), args.size());
+        }
+
+        for (grid = 0; grid < numEdges; grid++) {
+                if (caps[grid] != edges3D[grid].cap)
+                        adjustEdge(&edges3D[grid], &edges[grid], caps[grid], isReduce);
         }
 }
 
@@ -339,14 +453,158 @@ int FT::getEdgeCapacity(long x1, long y1, int l1, long x2, long y2, int l2) {
 }
 
 void FT::setMaxNetDegree(int deg) {
+        int arg = deg;
+        record(REC_MAX_NET_DEGREE, &arg, 1);
+
         maxNetDegree = deg;
 }
 
+void FT::setNumThreads(int nThreads) {
+        int arg = nThreads;
+        record(REC_NUM_THREADS, &arg, 1);
+
+        if (nThreads < 1)
+                nThreads = 1;
+        numThreads = nThreads;
+}
+
+void FT::setMaxRuntime(float seconds) {
+        int arg = floatBits(seconds);
+        record(REC_MAX_RUNTIME, &arg, 1);
+
+        maxRuntime = std::max<float>(seconds, 0);
+}
+
+void FT::setMaxMazeRound(int rounds) {
+        int arg = rounds;
+        record(REC_MAX_MAZE_ROUND, &arg, 1);
+
+        maxMazeRound = std::max(rounds, 1);
+}
+
+void FT::setOverflowPlateau(int rounds) {
+        int arg = rounds;
+        record(REC_OVERFLOW_PLATEAU, &arg, 1);
+
+        plateauRound = std::max(rounds, 0);
+}
+
+// cost parameters of the speculative variants, relative to the current ones;
+// variant 0 keeps them. L < 0 keeps the current L
+typedef struct
+{
+        float costheight;
+        float logisCof;
+        int enlarge;
+        int L;
+} VariantCost;
+
+static const VariantCost variantCosts[] = {
+    {1.0, 1.0, 0, -1},
+    {2.0, 1.0, 0, -1},
+    {1.0, 1.5, 0, -1},
+    {1.0, 1.0, 10, -1},
+    {1.0, 1.0, 0, 0},
+    {0.5, 1.0, 0, -1},
+    {1.0, 0.75, 5, -1},
+    {2.0, 1.5, 10, 0},
+};
+
+#define NUM_VARIANTS (int)(sizeof(variantCosts) / sizeof(VariantCost))
+
+void FT::setMultiStart(int variants, int rounds) {
+        int args[] = {variants, rounds};
+        record(REC_MULTI_START, args, 2);
+
+        numVariants = std::min(std::max(variants, 1), NUM_VARIANTS);
+        variantRound = std::max(rounds, 1);
+}
+
+void FT::setHilbertNetOrder(bool enable) {
+        int arg = enable;
+        record(REC_HILBERT_NET_ORDER, &arg, 1);
+
+        hilbertOrder = enable;
+}
+
+void FT::setVerificationLevel(int level) {
+        int arg = level;
+        record(REC_VERIFICATION_LEVEL, &arg, 1);
+
+        verifyLevel = (VerifyLevel)std::min(std::max(level, (int)VERIFY_NONE), (int)VERIFY_FULL);
+}
+
+VERIFICATION FT::getVerification() {
+        return verification;
+}
+
+// position of (x, y) along the Hilbert curve that fills a 2^16 x 2^16 grid
+static long long hilbertIndex(int x, int y) {
+        int s, rx, ry, t;
+        long long d = 0;
+
+        for (s = 1 << 15; s > 0; s >>= 1) {
+                rx = (x & s) > 0;
+                ry = (y & s) > 0;
+                d += (long long)s * s * ((3 * rx) ^ ry);
+                if (ry == 0) {
+                        if (rx == 1) {
+                                x = (1 << 16) - 1 - x;
+                                y = (1 << 16) - 1 - y;
+                        }
+                        t = x;
+                        x = y;
+                        y = t;
+                }
+        }
+        return d;
+}
+
+// renumber the valid nets by the Hilbert index of the center of their bounding
+// box, so that nets routed one after the other use nearby edges
+static void sortNetsHilbert() {
+        int i, j, minX, minY, maxX, maxY;
+        std::vector<long long> key(numValidNets);
+        std::vector<int> order(numValidNets);
+        std::vector<Net *> sorted(numValidNets);
+
+        for (i = 0; i < numValidNets; i++) {
+                minX = maxX = nets[i]->pinX[0];
+                minY = maxY = nets[i]->pinY[0];
+                for (j = 1; j < nets[i]->deg; j++) {
+                        minX = std::min(minX, (int)nets[i]->pinX[j]);
+                        maxX = std::max(maxX, (int)nets[i]->pinX[j]);
+                        minY = std::min(minY, (int)nets[i]->pinY[j]);
+                        maxY = std::max(maxY, (int)nets[i]->pinY[j]);
+                }
+                key[i] = hilbertIndex((minX + maxX) / 2, (minY + maxY) / 2);
+                order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&key](int a, int b) {
+                return key[a] < key[b];
+        });
+
+        for (i = 0; i < numValidNets; i++)
+                sorted[i] = nets[order[i]];
+        for (i = 0; i < numValidNets; i++) {
+                nets[i] = sorted[i];
+                seglistIndex[i] = (i == 0) ? 0 : seglistIndex[i - 1] + 2 * nets[i - 1]->deg - 3;
+        }
+}
+
 void FT::initAuxVar() {
         int k, i;
+
+        record(REC_INIT_AUX_VAR, NULL, 0);
+        closeRecording();
+
         treeOrderCong = NULL;
         stopDEC = FALSE;
 
+        if (hilbertOrder) {
+                sortNetsHilbert();
+        }
+
         seglistCnt = (int *)malloc(numValidNets * sizeof(int));
         seglist = (Segment *)malloc(segcount * sizeof(Segment));
         trees = (Flute::Tree *)malloc(numValidNets * sizeof(Flute::Tree));
@@ -399,7 +657,7 @@ std::vector<NET> FT::getResults() {
                 NET currentNet;
                 std::string netName(nets[netID]->name);
                 currentNet.name = netName;
-                currentNet.id = netID;
+                currentNet.id = nets[netID]->netIDorg;
                 treeedges = sttrees[netID].edges;
                 deg = sttrees[netID].deg;
 
@@ -436,16 +694,39 @@ std::vector<NET> FT::getResults() {
                 netsOut.push_back(currentNet);
         }
 
+        // back to the input order of the nets
+        if (hilbertOrder) {
+                std::stable_sort(netsOut.begin(), netsOut.end(), [](const NET &a, const NET &b) {
+                        return a.id < b.id;
+                });
+        }
+
         return netsOut;
 }
 
+// loop state of the maze rounds, saved with the routing solution at the start
+// of a speculative phase and at the end of every variant
+typedef struct
+{
+        int enlarge, ripup_threshold, upType, cost_type, healingTrigger;
+        int past_cong, last_cong, maxOverflow, tUsage, bmfl, bwcnt;
+        int costheight, THRESH_M, mazeedge_Threshold, VIA, slope, SLOPE, L, max_adj, totalOverflow;
+        float LOGIS_COF;
+        Bool stopDEC;
+} LoopState;
+
+// wall-clock seconds since start
+static float wallTime(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+}
+
 int FT::run(std::vector<NET> &result) {
         //    char benchFile[FILESTRLEN];
         char routingFile[STRINGLEN];
         char degreeFile[STRINGLEN];
         char optionS[STRINGLEN];
         clock_t t1, t2, t3, t4;
-        float gen_brk_Time, reading_Time, P1_Time, P2_Time, P3_Time, maze_Time, totalTime, congestionmap_time;
+        float gen_brk_Time, elapsed, reading_Time, P1_Time, P2_Time, P3_Time, maze_Time, totalTime, congestionmap_time;
         int iter, last_totalOverflow, diff_totalOverflow, enlarge, ripup_threshold;
         int i, j, past_overflow, cur_overflow;
         int L_afterSTOP;
@@ -453,17 +734,19 @@ int FT::run(std::vector<NET> &result) {
         int ESTEP2, CSTEP2, thStep2;
         int ESTEP3, CSTEP3, thStep3, tUsage, CSTEP4;
         int Ripvalue, LVIter, cost_step;
-        int maxOverflow, past_cong, last_cong, finallength, numVia, ripupTH3D, newTH, healingTrigger;
+        int maxOverflow, past_cong, last_cong = 0, finallength = 0, numVia = 0, ripupTH3D, newTH, healingTrigger;
         int updateType, minofl, minoflrnd, mazeRound, upType, cost_type, bmfl, bwcnt;
-        Bool goingLV, healingNeed, noADJ, extremeNeeded, needOUTPUT;
+        int variant, variantEnd, phaseStart;
+        RouteCheck routeCheck;
+        Bool goingLV, healingNeed, noADJ, extremeNeeded, needOUTPUT, keepBest;
+        LoopState st;
+        std::chrono::steady_clock::time_point runStart = std::chrono::steady_clock::now();
 
-        // TODO: check this size
-        int maxPin = maxNetDegree;
-        maxPin = 2* maxPin;
-        xcor = (int*)calloc(maxPin, sizeof(*xcor));
-        ycor = (int*)calloc(maxPin, sizeof(*ycor));
-        dcor = (int*)calloc(maxPin, sizeof(*dcor));
-        netEO = (OrderNetEdge*)calloc(maxPin, sizeof(*netEO));
+        // edge order of one tree (2*deg-3 edges), sized from the largest valid net
+        int maxDeg = 2;
+        for (i = 0; i < numValidNets; i++)
+                maxDeg = std::max(maxDeg, nets[i]->deg);
+        netEO = (OrderNetEdge*)calloc(2 * maxDeg - 3, sizeof(*netEO));
 
 
         Bool input, WriteOut;
@@ -496,7 +779,7 @@ int FT::run(std::vector<NET> &result) {
         updateType = 0;
         LVIter = 3;
         extremeNeeded = FALSE;
-        mazeRound = 500;
+        mazeRound = maxMazeRound;
         bmfl = BIG_INT;
         minofl = BIG_INT;
 
@@ -572,14 +855,91 @@ int FT::run(std::vector<NET> &result) {
         ripup_threshold = Ripvalue;
 
         minofl = totalOverflow;
+        minoflrnd = 0;
         stopDEC = FALSE;
 
+        // with a runtime budget or a plateau the rounds can stop at any point,
+        // and a speculative phase can jump to another solution, so the starting
+        // solution and every new minimal overflow are saved to be restored at
+        // the end
+        keepBest = (maxRuntime > 0 || plateauRound > 0 || numVariants > 1);
+        if (keepBest) {
+                copyRS();
+        }
+        variant = 0;
+        variantEnd = phaseStart = i;
+
+        auto saveLoopState = [&]() {
+                st.enlarge = enlarge;
+                st.ripup_threshold = ripup_threshold;
+                st.upType = upType;
+                st.cost_type = cost_type;
+                st.healingTrigger = healingTrigger;
+                st.past_cong = past_cong;
+                st.last_cong = last_cong;
+                st.maxOverflow = maxOverflow;
+                st.tUsage = tUsage;
+                st.bmfl = bmfl;
+                st.bwcnt = bwcnt;
+                st.costheight = costheight;
+                st.THRESH_M = THRESH_M;
+                st.mazeedge_Threshold = mazeedge_Threshold;
+                st.VIA = VIA;
+                st.slope = slope;
+                st.SLOPE = SLOPE;
+                st.L = L;
+                st.max_adj = max_adj;
+                st.totalOverflow = totalOverflow;
+                st.LOGIS_COF = LOGIS_COF;
+                st.stopDEC = stopDEC;
+        };
+        auto loadLoopState = [&]() {
+                enlarge = st.enlarge;
+                ripup_threshold = st.ripup_threshold;
+                upType = st.upType;
+                cost_type = st.cost_type;
+                healingTrigger = st.healingTrigger;
+                past_cong = st.past_cong;
+                last_cong = st.last_cong;
+                maxOverflow = st.maxOverflow;
+                tUsage = st.tUsage;
+                bmfl = st.bmfl;
+                bwcnt = st.bwcnt;
+                costheight = st.costheight;
+                THRESH_M = st.THRESH_M;
+                mazeedge_Threshold = st.mazeedge_Threshold;
+                VIA = st.VIA;
+                slope = st.slope;
+                SLOPE = st.SLOPE;
+                L = st.L;
+                max_adj = st.max_adj;
+                totalOverflow = st.totalOverflow;
+                LOGIS_COF = st.LOGIS_COF;
+                stopDEC = st.stopDEC;
+        };
+
         slope = 20;
         L = 1;
         cost_type = 1;
 
         InitLastUsage(upType);
         while (totalOverflow > 0) {
+                if (maxRuntime > 0 && wallTime(runStart) > maxRuntime) {
+                        printf("Runtime budget of %.2f sec reached at round %d\n", maxRuntime, i);
+                        break;
+                }
+
+                // start a speculative phase: every variant runs the next
+                // variantRound rounds from here, variant 0 with the current
+                // cost parameters
+                if (numVariants > 1 && i >= variantEnd) {
+                        phaseStart = i;
+                        variantEnd = i + variantRound;
+                        variant = 0;
+                        saveLoopState();
+                        saveVariantStart(&st, sizeof(st));
+                }
+
                 if (THRESH_M > 15) {
                         THRESH_M -= thStep1;
                 } else if (THRESH_M >= 2) {
@@ -663,6 +1023,9 @@ int FT::run(std::vector<NET> &result) {
                 if (minofl > past_cong) {
                         minofl = past_cong;
                         minoflrnd = i;
+                        if (keepBest) {
+                                copyRS();
+                        }
                 }
 
                 if (i == 8) {
@@ -720,7 +1083,9 @@ int FT::run(std::vector<NET> &result) {
                 if (past_cong < bmfl) {
                         bwcnt = 0;
                         if (i > 140 || (i > 80 && past_cong < 20)) {
-                                copyRS();
+                                if (!keepBest) {
+                                        copyRS();
+                                }
                                 bmfl = past_cong;
 
                                 L = 0;
@@ -729,7 +1094,9 @@ int FT::run(std::vector<NET> &result) {
                                 last_cong = past_cong;
                                 past_cong = getOverflow2Dmaze(&maxOverflow, &tUsage);
                                 if (past_cong < last_cong) {
-                                        copyRS();
+                                        if (!keepBest) {
+                                                copyRS();
+                                        }
                                         bmfl = past_cong;
                                 }
                                 L = 1;
@@ -737,6 +1104,9 @@ int FT::run(std::vector<NET> &result) {
                                 if (minofl > past_cong) {
                                         minofl = past_cong;
                                         minoflrnd = i;
+                                        if (keepBest) {
+                                                copyRS();
+                                        }
                                 }
                         }
                 } else {
@@ -760,8 +1130,38 @@ int FT::run(std::vector<NET> &result) {
                         getOverflow2Dmaze(&maxOverflow, &tUsage);
                         break;
                 }
+
+                if (plateauRound > 0 && i - 1 - minoflrnd >= plateauRound) {
+                        printf("No better overflow in the last %d rounds\n", plateauRound);
+                        break;
+                }
+
+                // end of a variant: run the next one from the start of the
+                // phase, or continue from the one with the lowest overflow; no
+                // variant beats an overflow of 0
+                if (numVariants > 1 && i >= variantEnd) {
+                        saveLoopState();
+                        if (variant + 1 < numVariants && past_cong > 0) {
+                                endVariant(variant, past_cong, &st, sizeof(st));
+                                restoreVariantStart(&st, sizeof(st));
+                                loadLoopState();
+                                i = phaseStart;
+                                variant++;
+                                costheight = (int)(costheight * variantCosts[variant].costheight);
+                                LOGIS_COF *= variantCosts[variant].logisCof;
+                                enlarge += variantCosts[variant].enlarge;
+                                if (variantCosts[variant].L >= 0) {
+                                        L = variantCosts[variant].L;
+                                }
+                        } else if (adoptBestVariant(variant, past_cong, &st, sizeof(st)) != variant) {
+                                loadLoopState();
+                        }
+                }
         }
 
+        // the rounds stopped inside a speculative phase
+        freeVariants();
+
         if (minofl > 0) {
                 printf("\n\n minimal ofl %d, occuring at round %d\n\n", minofl, minoflrnd);
                 copyBR();
@@ -784,9 +1184,12 @@ int FT::run(std::vector<NET> &result) {
         newLA();
         printf("layer assignment finished\n");
 
-        t2 = clock();
+        // the ripupTH3D thresholds use the clock() time of the original code,
+        // the runtime budget the wall-clock time (clock() adds up the time of
+        // all the threads), so only the budget depends on the machine load
         gen_brk_Time = (float)(t2 - t1) / CLOCKS_PER_SEC;
-        printf("2D + Layer Assignment Runtime: %f sec\n", gen_brk_Time);
+        elapsed = wallTime(runStart);
+        printf("2D + Layer Assignment Runtime: %f sec\n", elapsed);
 
         costheight = 3;
         viacost = 1;
@@ -799,7 +1202,9 @@ int FT::run(std::vector<NET> &result) {
                 ripupTH3D = 20;
         }
 
-        if (goingLV && past_cong == 0) {
+        if (maxRuntime > 0 && elapsed > maxRuntime) {
+                printf("Runtime budget reached, skipping post processing\n");
+        } else if (goingLV && past_cong == 0) {
                 printf("Post Processing Begins \n");
                 mazeRouteMSMDOrder3D(enlarge, 0, ripupTH3D);
 
@@ -811,9 +1216,24 @@ int FT::run(std::vector<NET> &result) {
         }
 
         fillVIA();
-        finallength = getOverflow3D();
-        numVia = threeDVIA();
-        checkRoute3D();
+
+        verification = VERIFICATION();
+        verification.level = verifyLevel;
+        if (verifyLevel != VERIFY_NONE) {
+                finallength = getOverflow3D();
+                checkRoutes3D(verifyLevel, &routeCheck);
+                numVia = routeCheck.numVia;
+
+                verification.length = finallength;
+                verification.numVias = numVia;
+                verification.overflow = totalOverflow;
+                verification.floatingPins = routeCheck.floatPins;
+                verification.brokenRoutes = routeCheck.badEnds + routeCheck.badSteps + routeCheck.badLayers;
+                // the serial check prints where the defects are
+                if (verification.floatingPins > 0 || verification.brokenRoutes > 0) {
+                        checkRoute3D();
+                }
+        }
 
         if (needOUTPUT) {
                 writeRoute3D(routingFile);
@@ -821,10 +1241,16 @@ int FT::run(std::vector<NET> &result) {
 
         t4 = clock();
         maze_Time = (float)(t4 - t1) / CLOCKS_PER_SEC;
-        printf("Final routing length : %d\n", finallength);
-        printf("Final number of via  : %d\n", numVia);
-        printf("Final total length 1 : %d\n", finallength + numVia);
-        printf("Final total length 3 : %d\n", (finallength + 3 * numVia));
+        if (verifyLevel != VERIFY_NONE) {
+                printf("Final routing length : %d\n", finallength);
+                printf("Final number of via  : %d\n", numVia);
+                printf("Final total length 1 : %d\n", finallength + numVia);
+                printf("Final total length 3 : %d\n", (finallength + 3 * numVia));
+        }
+        if (verifyLevel == VERIFY_FULL) {
+                printf("Route check: %d floating pins, %d bad route ends, %d bad route steps, %d negative layers\n",
+                       routeCheck.floatPins, routeCheck.badEnds, routeCheck.badSteps, routeCheck.badLayers);
+        }
         printf("3D runtime: %f sec\n", maze_Time);
 
         std::cout << "Getting results...\n";
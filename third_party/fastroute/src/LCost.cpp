@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, Iowa State University All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software
+// without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "DataType.h"
+#include "flute.h"
+#include "DataProc.h"
+#include "LCost.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LCOST_X86
+#include <immintrin.h>
+#endif
+
+namespace FastRoute {
+
+// Sum of the positive edge costs (est_usage - cap_lb + red) of n edges
+// starting at edge and stride Edges apart, added to cost. The scalar kernel
+// accumulates in edge order like the original loops. The SIMD kernels gather
+// est_usage and red from the Edge structs and compute the costs of 8 or 16
+// edges at once, but still add them to cost one at a time in edge order, so
+// the float sums are the ones of the scalar kernel.
+typedef float (*RunCostFn)(const Edge *edge, int stride, int n, float capLb, float cost);
+
+static float runCostScalar(const Edge *edge, int stride, int n, float capLb, float cost) {
+        int i;
+        float tmp;
+
+        for (i = 0; i < n; i++, edge += stride) {
+                tmp = edge->est_usage - capLb + edge->red;
+                if (tmp > 0)
+                        cost += tmp;
+        }
+        return cost;
+}
+
+#ifdef LCOST_X86
+// red is gathered as the 32-bit word starting at it and masked to its 16 bits
+static_assert(sizeof(Edge) % sizeof(int) == 0, "Edge must be a whole number of 32-bit words");
+
+// The AVX-512 kernel uses the masked forms of gather, cvtepi32 and max with
+// a zero source: GCC 12 implements the unmasked ones on an uninitialized
+// source vector and warns
+#define ALL_LANES ((__mmask16)0xffff)
+
+__attribute__((target("avx2"))) static float runCostAVX2(const Edge *edge, int stride, int n, float capLb, float cost) {
+        int i, k, step = stride * (int)(sizeof(Edge) / sizeof(int));
+        float lanes[8];
+        __m256i idx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(step));
+        __m256i redMask = _mm256_set1_epi32(0xffff);
+        __m256 cap = _mm256_set1_ps(capLb);
+        __m256 zero = _mm256_setzero_ps();
+        __m256 est, red, tmp;
+
+        if (n < 8)
+                return runCostScalar(edge, stride, n, capLb, cost);
+
+        for (i = 0; i + 8 <= n; i += 8, edge += 8 * stride) {
+                est = _mm256_i32gather_ps(&edge->est_usage, idx, 4);
+                red = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_i32gather_epi32((const int *)&edge->red, idx, 4), redMask));
+                tmp = _mm256_add_ps(_mm256_sub_ps(est, cap), red);
+                _mm256_storeu_ps(lanes, _mm256_max_ps(tmp, zero));
+                for (k = 0; k < 8; k++)
+                        cost += lanes[k];
+        }
+
+        return runCostScalar(edge, stride, n - i, capLb, cost);
+}
+
+__attribute__((target("avx512f"))) static float runCostAVX512(const Edge *edge, int stride, int n, float capLb, float cost) {
+        int i, k, step = stride * (int)(sizeof(Edge) / sizeof(int));
+        float lanes[16];
+        __m512i idx = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(step));
+        __m512i redMask = _mm512_set1_epi32(0xffff);
+        __m512 cap = _mm512_set1_ps(capLb);
+        __m512 zero = _mm512_setzero_ps();
+        __m512 est, red, tmp;
+
+        if (n < 16)
+                return runCostAVX2(edge, stride, n, capLb, cost);
+
+        for (i = 0; i + 16 <= n; i += 16, edge += 16 * stride) {
+                est = _mm512_mask_i32gather_ps(zero, ALL_LANES, idx, &edge->est_usage, 4);
+                red = _mm512_maskz_cvtepi32_ps(ALL_LANES, _mm512_and_si512(_mm512_mask_i32gather_epi32(_mm512_setzero_si512(), ALL_LANES, idx, (const int *)&edge->red, 4), redMask));
+                tmp = _mm512_add_ps(_mm512_sub_ps(est, cap), red);
+                _mm512_storeu_ps(lanes, _mm512_maskz_max_ps(ALL_LANES, tmp, zero));
+                for (k = 0; k < 16; k++)
+                        cost += lanes[k];
+        }
+
+        return runCostAVX2(edge, stride, n - i, capLb, cost);
+}
+#endif
+
+LCostKernel bestLCostKernel() {
+#ifdef LCOST_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+                return LCOST_AVX512;
+        if (__builtin_cpu_supports("avx2"))
+                return LCOST_AVX2;
+#endif
+        return LCOST_SCALAR;
+}
+
+static LCostKernel lcostKernel = bestLCostKernel();
+
+void setLCostKernel(LCostKernel kernel) {
+        if (kernel > bestLCostKernel()) {
+                printf("L cost kernel %d is not supported by this cpu, using %d\n", kernel, bestLCostKernel());
+                kernel = bestLCostKernel();
+        }
+        lcostKernel = kernel;
+}
+
+LCostKernel getLCostKernel() {
+        return lcostKernel;
+}
+
+static RunCostFn selectRunCost() {
+#ifdef LCOST_X86
+        if (lcostKernel == LCOST_AVX512)
+                return runCostAVX512;
+        if (lcostKernel == LCOST_AVX2)
+                return runCostAVX2;
+#endif
+        return runCostScalar;
+}
+
+void evalLCost(int x1, int y1, int x2, int y2, float *costL1, float *costL2) {
+        int ymin, ymax;
+        RunCostFn run = selectRunCost();
+
+        if (y1 < y2) {
+                ymin = y1;
+                ymax = y2;
+        } else {
+                ymin = y2;
+                ymax = y1;
+        }
+
+        // (x1, y1)-(x1, y2)-(x2, y2)
+        *costL1 = run(v_edges + ymin * xGrid + x1, xGrid, ymax - ymin, vCapacity_lb, *costL1);
+        *costL1 = run(h_edges + y2 * (xGrid - 1) + x1, 1, x2 - x1, hCapacity_lb, *costL1);
+        // (x1, y1)-(x2, y1)-(x2, y2)
+        *costL2 = run(v_edges + ymin * xGrid + x2, xGrid, ymax - ymin, vCapacity_lb, *costL2);
+        *costL2 = run(h_edges + y1 * (xGrid - 1) + x1, 1, x2 - x1, hCapacity_lb, *costL2);
+}
+
+}  // namespace FastRoute
@@ -0,0 +1,55 @@
+////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, Iowa State University All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software
+// without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __LCOST_H__
+#define __LCOST_H__
+
+namespace FastRoute {
+
+// kernels used to sum the edge costs of the two L shapes of a segment
+typedef enum {
+        LCOST_SCALAR,
+        LCOST_AVX2,
+        LCOST_AVX512
+} LCostKernel;
+
+// widest kernel supported by the running cpu
+extern LCostKernel bestLCostKernel();
+// kernel used by evalLCost, bestLCostKernel() until changed
+extern void setLCostKernel(LCostKernel kernel);
+extern LCostKernel getLCostKernel();
+// adds the congestion costs of the L shapes of the segment (x1, y1)-(x2, y2), x1 <= x2,
+// to costL1 (vertical at x1, horizontal at y2) and costL2 (horizontal at y1, vertical at x2)
+extern void evalLCost(int x1, int y1, int x2, int y2, float *costL1, float *costL2);
+
+}  // namespace FastRoute
+
+#endif /* __LCOST_H__ */
@@ -0,0 +1,201 @@
+////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, Iowa State University All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software
+// without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "DataType.h"
+#include "flute.h"
+#include "DataProc.h"
+#include "LCost.h"
+#include "LayerDP.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LAYERDP_X86
+#include <immintrin.h>
+#endif
+
+namespace FastRoute {
+
+static void relaxScalar(int *dist, int *link, int numLayers, int viaCost) {
+        int i, l;
+
+        for (l = 0; l < numLayers; l++) {
+                for (i = 0; i < numLayers; i++) {
+                        if (l != i) {
+                                if (dist[i] > dist[l] + ADIFF(i, l) * viaCost) {
+                                        dist[i] = dist[l] + ADIFF(i, l) * viaCost;
+                                        link[i] = l;
+                                }
+                        }
+                }
+        }
+}
+
+static void capacityScalar(const Edge3D *edges, int stride, int numLayers, int *cap) {
+        int l;
+
+        for (l = 0; l < numLayers; l++)
+                cap[l] = edges[l * stride].cap - edges[l * stride].usage;
+}
+
+#ifdef LAYERDP_X86
+static_assert(MAXLAYER <= 24, "the AVX2 kernels hold the layers in 3 vectors");
+static_assert(offsetof(Edge3D, usage) == offsetof(Edge3D, cap) + sizeof(short), "Edge3D usage must follow cap");
+
+// The AVX-512 kernels use the zero-masked forms of abs and srli: GCC 12
+// implements the unmasked ones on an uninitialized source vector and warns
+#define ALL_LANES ((__mmask16)0xffff)
+
+// The layers are held in vectors of 8 (AVX2) or 16 (AVX-512) lanes. The lanes
+// past numLayers hold INT_MIN, so they are never relaxed. For i == l the
+// candidate is dist[l] itself, which is not smaller, so that lane is left as
+// the scalar loop leaves it. The source dist[l] is read back from buf, as it
+// may have been relaxed by a smaller l.
+__attribute__((target("avx2"))) static void relaxAVX2(int *dist, int *link, int numLayers, int viaCost) {
+        int j, l, numVecs = (numLayers + 7) / 8;
+        __m256i layer[3], valid[3], d[3], lk[3], cand, src, better, cost = _mm256_set1_epi32(viaCost);
+        int buf[24];
+
+        for (j = 0; j < numVecs; j++) {
+                layer[j] = _mm256_setr_epi32(8 * j, 8 * j + 1, 8 * j + 2, 8 * j + 3, 8 * j + 4, 8 * j + 5, 8 * j + 6, 8 * j + 7);
+                valid[j] = _mm256_cmpgt_epi32(_mm256_set1_epi32(numLayers), layer[j]);
+                d[j] = _mm256_blendv_epi8(_mm256_set1_epi32(INT_MIN), _mm256_maskload_epi32(dist + 8 * j, valid[j]), valid[j]);
+                lk[j] = _mm256_maskload_epi32(link + 8 * j, valid[j]);
+                _mm256_storeu_si256((__m256i *)(buf + 8 * j), d[j]);
+        }
+        for (l = 0; l < numLayers; l++) {
+                src = _mm256_set1_epi32(buf[l]);
+                for (j = 0; j < numVecs; j++) {
+                        cand = _mm256_add_epi32(src, _mm256_mullo_epi32(_mm256_abs_epi32(_mm256_sub_epi32(layer[j], _mm256_set1_epi32(l))), cost));
+                        better = _mm256_cmpgt_epi32(d[j], cand);
+                        d[j] = _mm256_blendv_epi8(d[j], cand, better);
+                        lk[j] = _mm256_blendv_epi8(lk[j], _mm256_set1_epi32(l), better);
+                        _mm256_storeu_si256((__m256i *)(buf + 8 * j), d[j]);
+                }
+        }
+        for (j = 0; j < numVecs; j++) {
+                _mm256_maskstore_epi32(dist + 8 * j, valid[j], d[j]);
+                _mm256_maskstore_epi32(link + 8 * j, valid[j], lk[j]);
+        }
+}
+
+__attribute__((target("avx512f"))) static void relaxAVX512(int *dist, int *link, int numLayers, int viaCost) {
+        int j, l, numVecs = (numLayers + 15) / 16;
+        __m512i layer[2], d[2], lk[2], cand, src, cost = _mm512_set1_epi32(viaCost);
+        __mmask16 valid[2], better;
+        int buf[32];
+
+        for (j = 0; j < numVecs; j++) {
+                layer[j] = _mm512_add_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(16 * j));
+                valid[j] = _mm512_cmpgt_epi32_mask(_mm512_set1_epi32(numLayers), layer[j]);
+                d[j] = _mm512_mask_loadu_epi32(_mm512_set1_epi32(INT_MIN), valid[j], dist + 16 * j);
+                lk[j] = _mm512_maskz_loadu_epi32(valid[j], link + 16 * j);
+                _mm512_storeu_si512(buf + 16 * j, d[j]);
+        }
+        for (l = 0; l < numLayers; l++) {
+                src = _mm512_set1_epi32(buf[l]);
+                for (j = 0; j < numVecs; j++) {
+                        cand = _mm512_add_epi32(src, _mm512_mullo_epi32(_mm512_maskz_abs_epi32(ALL_LANES, _mm512_sub_epi32(layer[j], _mm512_set1_epi32(l))), cost));
+                        better = _mm512_cmpgt_epi32_mask(d[j], cand);
+                        d[j] = _mm512_mask_mov_epi32(d[j], better, cand);
+                        lk[j] = _mm512_mask_mov_epi32(lk[j], better, _mm512_set1_epi32(l));
+                        _mm512_storeu_si512(buf + 16 * j, d[j]);
+                }
+        }
+        for (j = 0; j < numVecs; j++) {
+                _mm512_mask_storeu_epi32(dist + 16 * j, valid[j], d[j]);
+                _mm512_mask_storeu_epi32(link + 16 * j, valid[j], lk[j]);
+        }
+}
+
+// cap and usage are read as one 32-bit word, cap in the low half; stride is
+// converted to 16-bit words for the gather
+__attribute__((target("avx2"))) static void capacityAVX2(const Edge3D *edges, int stride, int numLayers, int *cap) {
+        int j;
+        __m256i idx, valid, word, low = _mm256_set1_epi32(0xffff);
+
+        stride *= sizeof(Edge3D) / sizeof(short);
+        for (j = 0; j < numLayers; j += 8) {
+                idx = _mm256_setr_epi32(j, j + 1, j + 2, j + 3, j + 4, j + 5, j + 6, j + 7);
+                valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(numLayers), idx);
+                idx = _mm256_mullo_epi32(idx, _mm256_set1_epi32(stride));
+                word = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int *)&edges->cap, idx, valid, 2);
+                _mm256_maskstore_epi32(cap + j, valid, _mm256_sub_epi32(_mm256_and_si256(word, low), _mm256_srli_epi32(word, 16)));
+        }
+}
+
+__attribute__((target("avx512f"))) static void capacityAVX512(const Edge3D *edges, int stride, int numLayers, int *cap) {
+        int j;
+        __m512i idx, word, low = _mm512_set1_epi32(0xffff);
+        __mmask16 valid;
+
+        stride *= sizeof(Edge3D) / sizeof(short);
+        for (j = 0; j < numLayers; j += 16) {
+                idx = _mm512_add_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(j));
+                valid = _mm512_cmpgt_epi32_mask(_mm512_set1_epi32(numLayers), idx);
+                idx = _mm512_mullo_epi32(idx, _mm512_set1_epi32(stride));
+                word = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), valid, idx, (const int *)&edges->cap, 2);
+                _mm512_mask_storeu_epi32(cap + j, valid, _mm512_sub_epi32(_mm512_and_si512(word, low), _mm512_maskz_srli_epi32(ALL_LANES, word, 16)));
+        }
+}
+#endif
+
+void relaxVias(int *dist, int *link, int numLayers, int viaCost) {
+#ifdef LAYERDP_X86
+        if (getLCostKernel() == LCOST_AVX512) {
+                relaxAVX512(dist, link, numLayers, viaCost);
+                return;
+        }
+        if (getLCostKernel() == LCOST_AVX2) {
+                relaxAVX2(dist, link, numLayers, viaCost);
+                return;
+        }
+#endif
+        relaxScalar(dist, link, numLayers, viaCost);
+}
+
+void layerCapacity(const Edge3D *edges, int stride, int numLayers, int *cap) {
+#ifdef LAYERDP_X86
+        if (getLCostKernel() == LCOST_AVX512) {
+                capacityAVX512(edges, stride, numLayers, cap);
+                return;
+        }
+        if (getLCostKernel() == LCOST_AVX2) {
+                capacityAVX2(edges, stride, numLayers, cap);
+                return;
+        }
+#endif
+        capacityScalar(edges, stride, numLayers, cap);
+}
+
+}  // namespace FastRoute
@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, Iowa State University All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software
+// without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "DataType.h"
+#include "flute.h"
+#include "DataProc.h"
+#include "utility.h"
+#include "MultiStart.h"
+
+namespace FastRoute {
+
+// a routing solution with its loop state
+typedef struct
+{
+        std::vector<Edge> hEdges, vEdges;
+        std::vector<StTree> trees;  // empty when nothing is saved
+        std::vector<char> loopState;
+} Snapshot;
+
+static Snapshot phaseStart, bestVariant;
+static int bestIndex = -1, bestOverflow;
+
+static void freeSnapshot(Snapshot *snap) {
+        if (!snap->trees.empty()) {
+                freeRS(snap->trees.data());
+                snap->trees.clear();
+        }
+}
+
+static void saveSnapshot(Snapshot *snap, const void *loopState, size_t size) {
+        freeSnapshot(snap);
+        snap->hEdges.resize((xGrid - 1) * yGrid);
+        snap->vEdges.resize(xGrid * (yGrid - 1));
+        snap->trees.resize(numValidNets);
+        saveRS(snap->hEdges.data(), snap->vEdges.data(), snap->trees.data());
+        snap->loopState.assign((const char *)loopState, (const char *)loopState + size);
+}
+
+static void restoreSnapshot(const Snapshot *snap, void *loopState, size_t size) {
+        restoreRS(snap->hEdges.data(), snap->vEdges.data(), snap->trees.data());
+        memcpy(loopState, snap->loopState.data(), size);
+}
+
+void saveVariantStart(const void *loopState, size_t size) {
+        saveSnapshot(&phaseStart, loopState, size);
+        bestIndex = -1;
+}
+
+void restoreVariantStart(void *loopState, size_t size) {
+        restoreSnapshot(&phaseStart, loopState, size);
+}
+
+void endVariant(int variant, int overflow, const void *loopState, size_t size) {
+        printf("Variant %d overflow %d\n", variant, overflow);
+        if (bestIndex < 0 || overflow < bestOverflow) {
+                bestIndex = variant;
+                bestOverflow = overflow;
+                saveSnapshot(&bestVariant, loopState, size);
+        }
+}
+
+int adoptBestVariant(int variant, int overflow, void *loopState, size_t size) {
+        printf("Variant %d overflow %d\n", variant, overflow);
+        if (bestIndex >= 0 && bestOverflow <= overflow) {
+                restoreSnapshot(&bestVariant, loopState, size);
+        } else {
+                bestIndex = variant;
+        }
+        freeVariants();
+        return bestIndex;
+}
+
+void freeVariants() {
+        freeSnapshot(&phaseStart);
+        freeSnapshot(&bestVariant);
+}
+
+}  // namespace FastRoute
@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, Iowa State University All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software
+// without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __MULTISTART_H__
+#define __MULTISTART_H__
+
+#include <stddef.h>
+
+namespace FastRoute {
+
+// Speculative negotiation rounds. The routing solution and the loop state are
+// saved at the start of a phase; the variants then run the phase one after the
+// other from that start, each one with its own cost parameters, and the router
+// continues from the variant with the lowest overflow.
+
+// save the routing solution and size bytes of loop state as the start of a phase
+extern void saveVariantStart(const void *loopState, size_t size);
+// go back to the routing solution and the loop state of the start of the phase
+extern void restoreVariantStart(void *loopState, size_t size);
+// a variant other than the last one ended the phase with overflow: save its
+// routing solution and its loop state if it has the lowest overflow so far
+extern void endVariant(int variant, int overflow, const void *loopState, size_t size);
+// the last variant ended the phase with overflow: restore the routing solution
+// and the loop state of the variant with the lowest overflow, the first one on
+// a tie, unless it is the last one. Returns its index
+extern int adoptBestVariant(int variant, int overflow, void *loopState, size_t size);
+// free the saved solutions when the rounds stop inside a phase
+extern void freeVariants();
+
+}  // namespace FastRoute
+
+#endif /* __MULTISTART_H__ */
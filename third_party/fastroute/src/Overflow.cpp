@@ -0,0 +1,253 @@
+////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, Iowa State University All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software
+// without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include "DataType.h"
+#include "flute.h"
+#include "DataProc.h"
+#include "LCost.h"
+#include "Overflow.h"
+#include "route.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OVERFLOW_X86
+#include <immintrin.h>
+#endif
+
+namespace FastRoute {
+
+#define MIN_EDGES_PER_THREAD 65536  // smaller grids are swept by the calling thread
+
+static void addStats(OverflowStats *stats, const OverflowStats *part) {
+        stats->overflow += part->overflow;
+        stats->maxOverflow = std::max(stats->maxOverflow, part->maxOverflow);
+        stats->numOverflow += part->numOverflow;
+        stats->usage += part->usage;
+        stats->cap += part->cap;
+}
+
+// The kernels read cap and usage as one 32-bit word, cap in the low half. All
+// the statistics are integer, so the SIMD kernels give the scalar results.
+// stride is the size of an edge in 16-bit words.
+static void overflowScalar(const unsigned short *capUsage, int stride, int n, OverflowStats *stats) {
+        int i, overflow;
+
+        for (i = 0; i < n; i++, capUsage += stride) {
+                overflow = capUsage[1] - capUsage[0];
+                stats->usage += capUsage[1];
+                stats->cap += capUsage[0];
+                if (overflow > 0) {
+                        stats->overflow += overflow;
+                        stats->maxOverflow = std::max(stats->maxOverflow, overflow);
+                        stats->numOverflow++;
+                }
+        }
+}
+
+#ifdef OVERFLOW_X86
+static_assert(offsetof(Edge, usage) == offsetof(Edge, cap) + sizeof(short), "Edge usage must follow cap");
+static_assert(offsetof(Edge3D, usage) == offsetof(Edge3D, cap) + sizeof(short), "Edge3D usage must follow cap");
+
+__attribute__((target("avx2"))) static int hsumAVX2(__m256i v) {
+        int lanes[8], k, sum = 0;
+
+        _mm256_storeu_si256((__m256i *)lanes, v);
+        for (k = 0; k < 8; k++)
+                sum += lanes[k];
+        return sum;
+}
+
+__attribute__((target("avx2"))) static int hmaxAVX2(__m256i v) {
+        int lanes[8], k, max = 0;
+
+        _mm256_storeu_si256((__m256i *)lanes, v);
+        for (k = 0; k < 8; k++)
+                max = std::max(max, lanes[k]);
+        return max;
+}
+
+__attribute__((target("avx2"))) static void overflowAVX2(const unsigned short *capUsage, int stride, int n, OverflowStats *stats) {
+        int i;
+        __m256i idx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+        __m256i low = _mm256_set1_epi32(0xffff);
+        __m256i zero = _mm256_setzero_si256();
+        __m256i sumOverflow = zero, maxOverflow = zero, numOverflow = zero, sumUsage = zero, sumCap = zero;
+        __m256i word, cap, usage, overflow;
+
+        for (i = 0; i + 8 <= n; i += 8, capUsage += 8 * stride) {
+                word = _mm256_i32gather_epi32((const int *)capUsage, idx, 2);
+                cap = _mm256_and_si256(word, low);
+                usage = _mm256_srli_epi32(word, 16);
+                overflow = _mm256_max_epi32(_mm256_sub_epi32(usage, cap), zero);
+                sumOverflow = _mm256_add_epi32(sumOverflow, overflow);
+                maxOverflow = _mm256_max_epi32(maxOverflow, overflow);
+                numOverflow = _mm256_sub_epi32(numOverflow, _mm256_cmpgt_epi32(overflow, zero));
+                sumUsage = _mm256_add_epi32(sumUsage, usage);
+                sumCap = _mm256_add_epi32(sumCap, cap);
+        }
+        stats->overflow += hsumAVX2(sumOverflow);
+        stats->maxOverflow = std::max(stats->maxOverflow, hmaxAVX2(maxOverflow));
+        stats->numOverflow += hsumAVX2(numOverflow);
+        stats->usage += hsumAVX2(sumUsage);
+        stats->cap += hsumAVX2(sumCap);
+
+        overflowScalar(capUsage, stride, n - i, stats);
+}
+
+// The AVX-512 kernel uses the masked forms of gather, srli and max with a zero
+// source and reduces through memory: GCC 12 implements the unmasked forms and
+// the reductions on an uninitialized source vector and warns
+#define ALL_LANES ((__mmask16)0xffff)
+
+__attribute__((target("avx512f"))) static int hsumAVX512(__m512i v) {
+        int lanes[16], k, sum = 0;
+
+        _mm512_storeu_si512(lanes, v);
+        for (k = 0; k < 16; k++)
+                sum += lanes[k];
+        return sum;
+}
+
+__attribute__((target("avx512f"))) static int hmaxAVX512(__m512i v) {
+        int lanes[16], k, max = 0;
+
+        _mm512_storeu_si512(lanes, v);
+        for (k = 0; k < 16; k++)
+                max = std::max(max, lanes[k]);
+        return max;
+}
+
+__attribute__((target("avx512f"))) static void overflowAVX512(const unsigned short *capUsage, int stride, int n, OverflowStats *stats) {
+        int i;
+        __m512i idx = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(stride));
+        __m512i low = _mm512_set1_epi32(0xffff);
+        __m512i zero = _mm512_setzero_si512();
+        __m512i one = _mm512_set1_epi32(1);
+        __m512i sumOverflow = zero, maxOverflow = zero, numOverflow = zero, sumUsage = zero, sumCap = zero;
+        __m512i word, cap, usage, overflow;
+
+        for (i = 0; i + 16 <= n; i += 16, capUsage += 16 * stride) {
+                word = _mm512_mask_i32gather_epi32(zero, ALL_LANES, idx, (const int *)capUsage, 2);
+                cap = _mm512_and_si512(word, low);
+                usage = _mm512_maskz_srli_epi32(ALL_LANES, word, 16);
+                overflow = _mm512_maskz_max_epi32(ALL_LANES, _mm512_sub_epi32(usage, cap), zero);
+                sumOverflow = _mm512_add_epi32(sumOverflow, overflow);
+                maxOverflow = _mm512_maskz_max_epi32(ALL_LANES, maxOverflow, overflow);
+                numOverflow = _mm512_mask_add_epi32(numOverflow, _mm512_cmpgt_epi32_mask(overflow, zero), numOverflow, one);
+                sumUsage = _mm512_add_epi32(sumUsage, usage);
+                sumCap = _mm512_add_epi32(sumCap, cap);
+        }
+        stats->overflow += hsumAVX512(sumOverflow);
+        stats->maxOverflow = std::max(stats->maxOverflow, hmaxAVX512(maxOverflow));
+        stats->numOverflow += hsumAVX512(numOverflow);
+        stats->usage += hsumAVX512(sumUsage);
+        stats->cap += hsumAVX512(sumCap);
+
+        overflowScalar(capUsage, stride, n - i, stats);
+}
+#endif
+
+static void sumOverflowWords(const unsigned short *capUsage, int stride, int n, OverflowStats *stats) {
+        int c, numChunks;
+        std::vector<OverflowStats> parts(std::max(1, numThreads));
+        void (*kernel)(const unsigned short *, int, int, OverflowStats *) = overflowScalar;
+
+#ifdef OVERFLOW_X86
+        if (getLCostKernel() == LCOST_AVX512)
+                kernel = overflowAVX512;
+        else if (getLCostKernel() == LCOST_AVX2)
+                kernel = overflowAVX2;
+#endif
+
+        numChunks = runInChunks(n, MIN_EDGES_PER_THREAD, [&](int lo, int hi, int chunk) {
+                OverflowStats *part = &parts[chunk];
+                part->overflow = part->maxOverflow = part->numOverflow = part->usage = part->cap = 0;
+                kernel(capUsage + (long)lo * stride, stride, hi - lo, part);
+        });
+
+        stats->overflow = stats->maxOverflow = stats->numOverflow = stats->usage = stats->cap = 0;
+        for (c = 0; c < numChunks; c++)
+                addStats(stats, &parts[c]);
+}
+
+void sumOverflow(const Edge *edges, int n, OverflowStats *stats) {
+        sumOverflowWords(&edges->cap, sizeof(Edge) / sizeof(short), n, stats);
+}
+
+void sumOverflow3D(const Edge3D *edges, int n, OverflowStats *stats) {
+        sumOverflowWords(&edges->cap, sizeof(Edge3D) / sizeof(short), n, stats);
+}
+
+int updateHistory(Edge *edges, int n, int upType, Bool stopDEC, Bool clampCnt) {
+        int c, numChunks, maxlimit;
+        std::vector<int> parts(std::max(1, numThreads));
+
+        // the edges are independent, every chunk updates its own
+        numChunks = runInChunks(n, MIN_EDGES_PER_THREAD, [&](int lo, int hi, int chunk) {
+                int i, overflow, maxPart = 0;
+                Edge *edge;
+
+                for (i = lo; i < hi; i++) {
+                        edge = &edges[i];
+                        overflow = edge->usage - edge->cap;
+
+                        if (overflow > 0) {
+                                edge->last_usage += overflow;
+                                edge->congCNT++;
+                        } else if (!stopDEC) {
+                                if (upType != 1) {
+                                        edge->congCNT--;
+                                        if (upType != 3 || clampCnt)
+                                                edge->congCNT = std::max<int>(0, edge->congCNT);
+                                }
+                                if (upType == 3) {
+                                        edge->last_usage += overflow;
+                                        edge->last_usage = std::max<int>(edge->last_usage, 0);
+                                } else {
+                                        edge->last_usage = edge->last_usage * 0.9;
+                                }
+                        }
+                        maxPart = std::max<int>(maxPart, edge->last_usage);
+                }
+                parts[chunk] = maxPart;
+        });
+
+        maxlimit = 0;
+        for (c = 0; c < numChunks; c++)
+                maxlimit = std::max(maxlimit, parts[c]);
+        return maxlimit;
+}
+
+}  // namespace FastRoute
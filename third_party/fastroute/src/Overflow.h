@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, Iowa State University All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software
+// without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __OVERFLOW_H__
+#define __OVERFLOW_H__
+
+namespace FastRoute {
+
+// usage against capacity of a set of edges
+typedef struct
+{
+        int overflow;     // sum of usage - cap over the overflowed edges
+        int maxOverflow;  // largest usage - cap, 0 if no edge is overflowed
+        int numOverflow;  // # edges with usage > cap
+        int usage;        // total usage
+        int cap;          // total capacity
+} OverflowStats;
+
+// overflow statistics of the n edges starting at edges, in one pass, with the
+// SIMD kernel selected by setLCostKernel and numThreads threads on large grids
+extern void sumOverflow(const Edge *edges, int n, OverflowStats *stats);
+extern void sumOverflow3D(const Edge3D *edges, int n, OverflowStats *stats);
+// congestion history update of updateCongestionHistory for the n edges starting
+// at edges; clampCnt keeps congCNT >= 0 when upType 3 decreases it (upType 2 and
+// 4 always do). Returns the largest last_usage, 0 if all of them are negative
+extern int updateHistory(Edge *edges, int n, int upType, Bool stopDEC, Bool clampCnt);
+
+}  // namespace FastRoute
+
+#endif /* __OVERFLOW_H__ */
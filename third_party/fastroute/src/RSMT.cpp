@@ -33,6 +33,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <algorithm>
+#include <vector>
 #include "DataType.h"
 #include "flute.h"
 #include "DataProc.h"
@@ -40,10 +41,13 @@
 #include "EdgeShift.h"
 #include "route.h"
 #include "RipUp.h"
+#include "mst2.h"
 
 namespace FastRoute {
 
 #define FLUTEACCURACY 2
+#define HIGH_FANOUT_DEGREE 1000  // nets with more pins are decomposed by fluteHighFanout
+#define CLUSTER_DEGREE 100       // max # pins in one cluster of a decomposed net
 
 struct pnt {
         Flute::DTYPE x, y;
@@ -220,13 +224,266 @@ void copyStTree(int ind, Flute::Tree rsmt) {
         }
 }
 
+// split the pins ids[lo, hi) at the median of the longer side of their bounding
+// box until every part has at most CLUSTER_DEGREE pins
+static void clusterPins(Flute::DTYPE x[], Flute::DTYPE y[], int *ids, int lo, int hi, std::vector<int> &clusterStart) {
+        int i, mid;
+        Flute::DTYPE xmin, xmax, ymin, ymax;
+
+        if (hi - lo <= CLUSTER_DEGREE) {
+                clusterStart.push_back(lo);
+                return;
+        }
+
+        xmin = xmax = x[ids[lo]];
+        ymin = ymax = y[ids[lo]];
+        for (i = lo + 1; i < hi; i++) {
+                xmin = std::min(xmin, x[ids[i]]);
+                xmax = std::max(xmax, x[ids[i]]);
+                ymin = std::min(ymin, y[ids[i]]);
+                ymax = std::max(ymax, y[ids[i]]);
+        }
+
+        mid = lo + (hi - lo) / 2;
+        if (xmax - xmin >= ymax - ymin) {
+                std::nth_element(ids + lo, ids + mid, ids + hi, [x](int a, int b) {
+                        return x[a] < x[b] || (x[a] == x[b] && a < b);
+                });
+        } else {
+                std::nth_element(ids + lo, ids + mid, ids + hi, [y](int a, int b) {
+                        return y[a] < y[b] || (y[a] == y[b] && a < b);
+                });
+        }
+        clusterPins(x, y, ids, lo, mid, clusterStart);
+        clusterPins(x, y, ids, mid, hi, clusterStart);
+}
+
+// FLUTE tree of the n pins ids[0, n), node[i] gets the pin id of the pin branches i < n
+static Flute::Tree fluteCluster(Flute::DTYPE x[], Flute::DTYPE y[], int *ids, int n, int acc, float coeffV, int *node) {
+        int i, yScale;
+        std::vector<int> xo(n), yo(n), xrank(n), s(n), pb(n), pp(n);
+        std::vector<Flute::DTYPE> xs(n), ys(n);
+        Flute::Tree t;
+
+        yScale = (int)(100 * coeffV);
+        for (i = 0; i < n; i++)
+                xo[i] = yo[i] = pb[i] = pp[i] = i;
+        std::sort(xo.begin(), xo.end(), [x, ids](int a, int b) {
+                return x[ids[a]] < x[ids[b]] || (x[ids[a]] == x[ids[b]] && a < b);
+        });
+        std::sort(yo.begin(), yo.end(), [y, ids](int a, int b) {
+                return y[ids[a]] < y[ids[b]] || (y[ids[a]] == y[ids[b]] && a < b);
+        });
+        for (i = 0; i < n; i++) {
+                xrank[xo[i]] = i;
+                xs[i] = x[ids[xo[i]]] * 100;
+        }
+        for (i = 0; i < n; i++) {
+                ys[i] = y[ids[yo[i]]] * yScale;
+                s[i] = xrank[yo[i]];
+        }
+
+        t = Flute::flutes(n, xs.data(), ys.data(), s.data(), acc);
+
+        for (i = 0; i < 2 * n - 2; i++) {
+                t.branch[i].x = t.branch[i].x / 100;
+                t.branch[i].y = t.branch[i].y / yScale;
+        }
+
+        // match the pin branches to the pins by location
+        std::sort(pb.begin(), pb.end(), [&t](int a, int b) {
+                if (t.branch[a].x != t.branch[b].x)
+                        return t.branch[a].x < t.branch[b].x;
+                return t.branch[a].y < t.branch[b].y || (t.branch[a].y == t.branch[b].y && a < b);
+        });
+        std::sort(pp.begin(), pp.end(), [x, y, ids](int a, int b) {
+                if (x[ids[a]] != x[ids[b]])
+                        return x[ids[a]] < x[ids[b]];
+                return y[ids[a]] < y[ids[b]] || (y[ids[a]] == y[ids[b]] && a < b);
+        });
+        for (i = 0; i < n; i++)
+                node[pb[i]] = ids[pp[i]];
+
+        return t;
+}
+
+static int findCluster(std::vector<int> &comp, int c) {
+        while (comp[c] != c) {
+                comp[c] = comp[comp[c]];
+                c = comp[c];
+        }
+        return c;
+}
+
+// Tree of a high fanout net. The pins are clustered by recursive bisection,
+// every cluster gets its own FLUTE tree and the clusters are connected along
+// the cross cluster edges of the pin MST (mst2), shortest first. A connection
+// (p, q) puts a Steiner node on an edge of p and one on an edge of q, so the
+// result has 2*d-2 nodes with the pins first, like a FLUTE tree.
+static void fluteHighFanout(int d, Flute::DTYPE x[], Flute::DTYPE y[], int acc, float coeffV, Flute::Tree *t) {
+        int i, j, k, c, n, a, b, e, s, v, numClusters, numNodes, nextNode, head;
+        std::vector<int> ids(d), clusterStart, clusterOf(d), pinEdge(d, -1);
+        std::vector<int> nodeX(2 * d - 2), nodeY(2 * d - 2), edgeN1, edgeN2;
+        std::vector<int> cross, comp;
+        std::vector<long> parent(d, -1);
+        std::vector<Point> pt(d);
+        Flute::Tree ct;
+
+        for (i = 0; i < d; i++) {
+                ids[i] = i;
+                nodeX[i] = x[i];
+                nodeY[i] = y[i];
+        }
+        clusterPins(x, y, ids.data(), 0, d, clusterStart);
+        numClusters = clusterStart.size();
+        clusterStart.push_back(d);
+
+        numNodes = 2 * d - 2;
+        nextNode = d;
+        edgeN1.reserve(numNodes - 1);
+        edgeN2.reserve(numNodes - 1);
+        auto addEdge = [&](int n1, int n2) {
+                edgeN1.push_back(n1);
+                edgeN2.push_back(n2);
+                if (n1 < d)
+                        pinEdge[n1] = edgeN1.size() - 1;
+                if (n2 < d)
+                        pinEdge[n2] = edgeN1.size() - 1;
+        };
+
+        // sub-trees of the clusters
+        for (c = 0; c < numClusters; c++) {
+                n = clusterStart[c + 1] - clusterStart[c];
+                std::vector<int> node(2 * n - 2);
+
+                for (j = clusterStart[c]; j < clusterStart[c + 1]; j++)
+                        clusterOf[ids[j]] = c;
+                ct = fluteCluster(x, y, &ids[clusterStart[c]], n, acc, coeffV, node.data());
+                for (j = n; j < 2 * n - 2; j++) {
+                        node[j] = nextNode;
+                        nodeX[nextNode] = ct.branch[j].x;
+                        nodeY[nextNode] = ct.branch[j].y;
+                        nextNode++;
+                }
+                for (j = 0; j < 2 * n - 2; j++) {
+                        if (ct.branch[j].n != j)
+                                addEdge(node[j], node[ct.branch[j].n]);
+                }
+                free(ct.branch);
+        }
+
+        // cross cluster edges of the pin MST
+        for (i = 0; i < d; i++) {
+                pt[i].x = x[i];
+                pt[i].y = y[i];
+        }
+        mst2_package_init(d);
+        mst2(d, pt.data(), parent.data());
+        mst2_package_done();
+
+        for (i = 0; i < d; i++) {
+                if (parent[i] >= 0 && clusterOf[i] != clusterOf[parent[i]])
+                        cross.push_back(i);
+        }
+        std::sort(cross.begin(), cross.end(), [&](int p, int q) {
+                int lenP = ADIFF(x[p], x[parent[p]]) + ADIFF(y[p], y[parent[p]]);
+                int lenQ = ADIFF(x[q], x[parent[q]]) + ADIFF(y[q], y[parent[q]]);
+                return lenP < lenQ || (lenP == lenQ && p < q);
+        });
+
+        // a connection splits an edge of each end pin with a new Steiner node
+        auto splitPinEdge = [&](int pin) {
+                e = pinEdge[pin];
+                s = nextNode++;
+                nodeX[s] = nodeX[pin];
+                nodeY[s] = nodeY[pin];
+                if (edgeN1[e] == pin)
+                        edgeN1[e] = s;
+                else
+                        edgeN2[e] = s;
+                addEdge(pin, s);
+                return s;
+        };
+
+        comp.resize(numClusters);
+        for (c = 0; c < numClusters; c++)
+                comp[c] = c;
+        for (k = 0; k < (int)cross.size(); k++) {
+                i = cross[k];
+                a = findCluster(comp, clusterOf[i]);
+                b = findCluster(comp, clusterOf[parent[i]]);
+                if (a != b) {
+                        comp[a] = b;
+                        a = splitPinEdge(i);
+                        b = splitPinEdge(parent[i]);
+                        addEdge(a, b);
+                }
+        }
+        // the MST spans all the pins, this only catches points mst2 could not reach
+        for (c = 1; c < numClusters; c++) {
+                a = findCluster(comp, c);
+                b = findCluster(comp, 0);
+                if (a != b) {
+                        comp[a] = b;
+                        a = splitPinEdge(ids[clusterStart[c]]);
+                        b = splitPinEdge(ids[clusterStart[0]]);
+                        addEdge(a, b);
+                }
+        }
+
+        if (nextNode != numNodes || (int)edgeN1.size() != numNodes - 1) {
+                printf("high fanout tree wrong: %d nodes, %d edges for degree %d\n", nextNode, (int)edgeN1.size(), d);
+                exit(1);
+        }
+
+        // root the tree at a Steiner node to get the FLUTE branches, the pins stay
+        // leaves pointing to their Steiner node like in a FLUTE tree (edgeShift relies on it)
+        std::vector<int> adjStart(numNodes + 1, 0), adj(2 * (numNodes - 1)), queue(numNodes);
+        for (e = 0; e < numNodes - 1; e++) {
+                adjStart[edgeN1[e] + 1]++;
+                adjStart[edgeN2[e] + 1]++;
+        }
+        for (v = 0; v < numNodes; v++)
+                adjStart[v + 1] += adjStart[v];
+        std::vector<int> fill(adjStart.begin(), adjStart.end() - 1);
+        for (e = 0; e < numNodes - 1; e++) {
+                adj[fill[edgeN1[e]]++] = edgeN2[e];
+                adj[fill[edgeN2[e]]++] = edgeN1[e];
+        }
+
+        t->deg = d;
+        t->length = 0;
+        t->branch = (Flute::Branch *)malloc(numNodes * sizeof(Flute::Branch));
+        for (v = 0; v < numNodes; v++) {
+                t->branch[v].x = nodeX[v];
+                t->branch[v].y = nodeY[v];
+                t->branch[v].n = -1;
+        }
+        t->branch[d].n = d;
+        queue[0] = d;
+        n = 1;
+        for (head = 0; head < n; head++) {
+                v = queue[head];
+                for (j = adjStart[v]; j < adjStart[v + 1]; j++) {
+                        k = adj[j];
+                        if (t->branch[k].n < 0) {
+                                t->branch[k].n = v;
+                                t->length += ADIFF(nodeX[k], nodeX[v]) + ADIFF(nodeY[k], nodeY[v]);
+                                queue[n++] = k;
+                        }
+                }
+        }
+}
+
 void fluteNormal(int netID, int d, Flute::DTYPE x[], Flute::DTYPE y[], int acc, float coeffV, Flute::Tree *t) {
         Flute::DTYPE *xs, *ys, minval, x_max, x_min, x_mid, y_max, y_min, y_mid, *tmp_xs, *tmp_ys;
         int *s;
         int i, j, k, minidx;
         struct pnt *pt, **ptp, *tmpp;
 
-        if (d == 2) {
+        if (d > HIGH_FANOUT_DEGREE) {
+                fluteHighFanout(d, x, y, acc, coeffV, t);
+        } else if (d == 2) {
                 t->deg = 2;
                 t->length = ADIFF(x[0], x[1]) + ADIFF(y[0], y[1]);
                 t->branch = (Flute::Branch *)malloc(2 * sizeof(Flute::Branch));
@@ -415,7 +672,10 @@ void fluteCongest(int netID, int d, Flute::DTYPE x[], Flute::DTYPE y[], int acc,
         float coeffH = 1;
         //	float coeffV = 2;//1.36;//hCapacity/vCapacity;//1;//
 
-        if (d == 2) {
+        if (d > HIGH_FANOUT_DEGREE) {
+                // no congestion warping of the coordinates, edgeShiftNew still runs on the tree
+                fluteHighFanout(d, x, y, acc, coeffV, t);
+        } else if (d == 2) {
                 t->deg = 2;
                 t->length = ADIFF(x[0], x[1]) + ADIFF(y[0], y[1]);
                 t->branch = (Flute::Branch *)malloc(2 * sizeof(Flute::Branch));
@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, Iowa State University All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software
+// without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "Recording.h"
+
+namespace FastRoute {
+
+static FILE *recordFile = NULL;
+
+bool openRecording(const char *fileName) {
+        int header[2] = {RECORDING_MAGIC, RECORDING_VERSION};
+
+        closeRecording();
+        recordFile = fopen(fileName, "wb");
+        if (recordFile == NULL) {
+                printf("Error opening the recording file %s\n", fileName);
+                return false;
+        }
+        // the nets make most of a recording, written in large blocks
+        setvbuf(recordFile, NULL, _IOFBF, 1 << 20);
+        fwrite(header, sizeof(int), 2, recordFile);
+        return true;
+}
+
+void closeRecording() {
+        if (recordFile == NULL)
+                return;
+
+        if (ferror(recordFile))
+                printf("Error writing the recording, it is incomplete\n");
+        fclose(recordFile);
+        recordFile = NULL;
+}
+
+bool isRecording() {
+        return recordFile != NULL;
+}
+
+void record(int op, const int *args, int numArgs, const char *bytes, int numBytes) {
+        int head[3] = {op, numArgs, numBytes};
+
+        if (recordFile == NULL)
+                return;
+
+        fwrite(head, sizeof(int), 3, recordFile);
+        if (numArgs > 0)
+                fwrite(args, sizeof(int), numArgs, recordFile);
+        if (numBytes > 0)
+                fwrite(bytes, 1, numBytes, recordFile);
+}
+
+int floatBits(float value) {
+        int bits;
+
+        memcpy(&bits, &value, sizeof(int));
+        return bits;
+}
+
+float bitsFloat(int bits) {
+        float value;
+
+        memcpy(&value, &bits, sizeof(float));
+        return value;
+}
+
+bool readRecordingHeader(FILE *file) {
+        int header[2];
+
+        if (fread(header, sizeof(int), 2, file) != 2)
+                return false;
+        return header[0] == RECORDING_MAGIC && header[1] == RECORDING_VERSION;
+}
+
+int readRecord(FILE *file, std::vector<int> &args, std::string &bytes) {
+        int head[3];
+
+        if (fread(head, sizeof(int), 3, file) != 3 || head[1] < 0 || head[2] < 0)
+                return 0;
+
+        args.resize(head[1]);
+        bytes.resize(head[2]);
+        if (head[1] > 0 && fread(&args[0], sizeof(int), head[1], file) != (size_t)head[1])
+                return 0;
+        if (head[2] > 0 && fread(&bytes[0], 1, head[2], file) != (size_t)head[2])
+                return 0;
+        return head[0];
+}
+
+}  // namespace FastRoute
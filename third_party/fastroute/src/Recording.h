@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, Iowa State University All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software
+// without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __RECORDING_H__
+#define __RECORDING_H__
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace FastRoute {
+
+// Recording of the calls that give FastRoute its routing input, from
+// FT::startRecording to FT::initAuxVar, so that a design can be routed again
+// without the database it was read from (see bench/Replay.cpp). A recording is
+// a header (RECORDING_MAGIC, RECORDING_VERSION) followed by one record per
+// call: the opcode, the number of integer arguments, the number of bytes of
+// the string argument, then the arguments and the bytes. Integers are 32 bits
+// in the byte order of the machine, floats are stored by their bits.
+
+#define RECORDING_MAGIC 0x46524543  // "FREC"
+#define RECORDING_VERSION 1
+
+// one opcode per recorded call of FT
+enum { REC_GRIDS_AND_LAYERS = 1,   // x, y, nLayers
+       REC_V_CAPACITY,             // capacity, layer
+       REC_H_CAPACITY,             // capacity, layer
+       REC_MIN_WIDTH,              // width, layer
+       REC_MIN_SPACING,            // spacing, layer
+       REC_VIA_SPACING,            // spacing, layer
+       REC_NUMBER_NETS,            // nNets
+       REC_LOWER_LEFT,             // x, y
+       REC_TILE_SIZE,              // width, height
+       REC_LAYER_ORIENTATION,      // orientation
+       REC_MAX_NET_DEGREE,         // degree
+       REC_NET,                    // netIdx, minWidth, x, y, layer of each pin; the name
+       REC_INIT_EDGES,             // no arguments
+       REC_ADJUSTMENT,             // x1, y1, l1, x2, y2, l2, reducedCap, isReduce
+       REC_EDGE_CAPACITIES,        // layer, horizontal, x1, y1, x2, y2, cap, isReduce
+       REC_SCALE_EDGE_CAPACITIES,  // layer, horizontal, x1, y1, x2, y2, factor
+       REC_LAYER_CAPACITIES,       // layer, horizontal, isReduce, capacity of each edge
+       REC_NUM_THREADS,            // nThreads
+       REC_MAX_RUNTIME,            // seconds
+       REC_MAX_MAZE_ROUND,         // rounds
+       REC_OVERFLOW_PLATEAU,       // rounds
+       REC_MULTI_START,            // variants, rounds
+       REC_HILBERT_NET_ORDER,      // enable
+       REC_VERIFICATION_LEVEL,     // level
+       REC_INIT_AUX_VAR };         // last record
+
+// open fileName and write the header. Returns false if the file cannot be
+// written, and nothing is recorded then
+extern bool openRecording(const char *fileName);
+// close the recording, if any
+extern void closeRecording();
+// true between openRecording and closeRecording
+extern bool isRecording();
+// append a record of numArgs integers and numBytes bytes
+extern void record(int op, const int *args, int numArgs, const char *bytes = NULL, int numBytes = 0);
+extern int floatBits(float value);
+extern float bitsFloat(int bits);
+
+// check the header of a recording. Returns false if it is not a recording of
+// this version
+extern bool readRecordingHeader(FILE *file);
+// read the next record into args and bytes. Returns its opcode, or 0 at the end
+// of the file or on a truncated record
+extern int readRecord(FILE *file, std::vector<int> &args, std::string &bytes);
+
+}  // namespace FastRoute
+
+#endif /* __RECORDING_H__ */
@@ -42,6 +42,7 @@
 #include "utility.h"
 #include "RSMT.h"
 #include "EdgeShift.h"
+#include "Overflow.h"
 
 namespace FastRoute {
 
@@ -282,171 +283,23 @@ void extractMin(float **array, int arrayLen) {
  */
 
 void updateCongestionHistory(int round, int upType) {
-        int i, j, grid, maxlimit, overflow;
-
-        maxlimit = 0;
+        int maxlimit;
 
         printf("updateType %d\n", upType);
 
-        if (upType == 1) {
-                for (i = 0; i < yGrid; i++) {
-                        for (j = 0; j < xGrid - 1; j++) {
-                                grid = i * (xGrid - 1) + j;
-                                overflow = h_edges[grid].usage - h_edges[grid].cap;
-
-                                if (overflow > 0) {
-                                        h_edges[grid].last_usage += overflow;
-                                        h_edges[grid].congCNT++;
-                                } else {
-                                        if (!stopDEC) {
-                                                h_edges[grid].last_usage = h_edges[grid].last_usage * 0.9;
-                                        }
-                                }
-                                maxlimit = std::max<int>(maxlimit, h_edges[grid].last_usage);
-                        }
-                }
-
-                for (i = 0; i < yGrid - 1; i++) {
-                        for (j = 0; j < xGrid; j++) {
-                                grid = i * xGrid + j;
-                                overflow = v_edges[grid].usage - v_edges[grid].cap;
-
-                                if (overflow > 0) {
-                                        v_edges[grid].last_usage += overflow;
-                                        v_edges[grid].congCNT++;
-                                } else {
-                                        if (!stopDEC) {
-                                                v_edges[grid].last_usage = v_edges[grid].last_usage * 0.9;
-                                        }
-                                }
-                                maxlimit = std::max<int>(maxlimit, v_edges[grid].last_usage);
-                        }
-                }
-        } else if (upType == 2) {
+        if (upType == 2) {
                 if (max_adj < ahTH) {
                         stopDEC = TRUE;
                 } else {
                         stopDEC = FALSE;
                 }
-                for (i = 0; i < yGrid; i++) {
-                        for (j = 0; j < xGrid - 1; j++) {
-                                grid = i * (xGrid - 1) + j;
-                                overflow = h_edges[grid].usage - h_edges[grid].cap;
-
-                                if (overflow > 0) {
-                                        h_edges[grid].congCNT++;
-                                        h_edges[grid].last_usage += overflow;
-                                } else {
-                                        if (!stopDEC) {
-                                                h_edges[grid].congCNT--;
-                                                h_edges[grid].congCNT = std::max<int>(0, h_edges[grid].congCNT);
-                                                h_edges[grid].last_usage = h_edges[grid].last_usage * 0.9;
-                                        }
-                                }
-                                maxlimit = std::max<int>(maxlimit, h_edges[grid].last_usage);
-                        }
-                }
-
-                for (i = 0; i < yGrid - 1; i++) {
-                        for (j = 0; j < xGrid; j++) {
-                                grid = i * xGrid + j;
-                                overflow = v_edges[grid].usage - v_edges[grid].cap;
-
-                                if (overflow > 0) {
-                                        v_edges[grid].congCNT++;
-                                        v_edges[grid].last_usage += overflow;
-                                } else {
-                                        if (!stopDEC) {
-                                                v_edges[grid].congCNT--;
-                                                v_edges[grid].congCNT = std::max<int>(0, v_edges[grid].congCNT);
-                                                v_edges[grid].last_usage = v_edges[grid].last_usage * 0.9;
-                                        }
-                                }
-                                maxlimit = std::max<int>(maxlimit, v_edges[grid].last_usage);
-                        }
-                }
-
-        } else if (upType == 3) {
-                for (i = 0; i < yGrid; i++) {
-                        for (j = 0; j < xGrid - 1; j++) {
-                                grid = i * (xGrid - 1) + j;
-                                overflow = h_edges[grid].usage - h_edges[grid].cap;
-
-                                if (overflow > 0) {
-                                        h_edges[grid].congCNT++;
-                                        h_edges[grid].last_usage += overflow;
-                                } else {
-                                        if (!stopDEC) {
-                                                h_edges[grid].congCNT--;
-                                                h_edges[grid].congCNT = std::max<int>(0, h_edges[grid].congCNT);
-                                                h_edges[grid].last_usage += overflow;
-                                                h_edges[grid].last_usage = std::max<int>(h_edges[grid].last_usage, 0);
-                                        }
-                                }
-                                maxlimit = std::max<int>(maxlimit, h_edges[grid].last_usage);
-                        }
-                }
-
-                for (i = 0; i < yGrid - 1; i++) {
-                        for (j = 0; j < xGrid; j++) {
-                                grid = i * xGrid + j;
-                                overflow = v_edges[grid].usage - v_edges[grid].cap;
-
-                                if (overflow > 0) {
-                                        v_edges[grid].congCNT++;
-                                        v_edges[grid].last_usage += overflow;
-                                } else {
-                                        if (!stopDEC) {
-                                                v_edges[grid].congCNT--;
-                                                v_edges[grid].last_usage += overflow;
-                                                v_edges[grid].last_usage = std::max<int>(v_edges[grid].last_usage, 0);
-                                        }
-                                }
-                                maxlimit = std::max<int>(maxlimit, v_edges[grid].last_usage);
-                        }
-                }
-
-        } else if (upType == 4) {
-                for (i = 0; i < yGrid; i++) {
-                        for (j = 0; j < xGrid - 1; j++) {
-                                grid = i * (xGrid - 1) + j;
-                                overflow = h_edges[grid].usage - h_edges[grid].cap;
-
-                                if (overflow > 0) {
-                                        h_edges[grid].congCNT++;
-                                        h_edges[grid].last_usage += overflow;
-                                } else {
-                                        if (!stopDEC) {
-                                                h_edges[grid].congCNT--;
-                                                h_edges[grid].congCNT = std::max<int>(0, h_edges[grid].congCNT);
-                                                h_edges[grid].last_usage = h_edges[grid].last_usage * 0.9;
-                                        }
-                                }
-                                maxlimit = std::max<int>(maxlimit, h_edges[grid].last_usage);
-                        }
-                }
-
-                for (i = 0; i < yGrid - 1; i++) {
-                        for (j = 0; j < xGrid; j++) {
-                                grid = i * xGrid + j;
-                                overflow = v_edges[grid].usage - v_edges[grid].cap;
-
-                                if (overflow > 0) {
-                                        v_edges[grid].congCNT++;
-                                        v_edges[grid].last_usage += overflow;
-                                } else {
-                                        if (!stopDEC) {
-                                                v_edges[grid].congCNT--;
-                                                v_edges[grid].congCNT = std::max<int>(0, v_edges[grid].congCNT);
-                                                v_edges[grid].last_usage = v_edges[grid].last_usage * 0.9;
-                                        }
-                                }
-                                maxlimit = std::max<int>(maxlimit, v_edges[grid].last_usage);
-                        }
-                }
-                //	if (maxlimit < 20) {
-                //		stopDEC = TRUE;
-                //	}
+        }
+        if (upType < 1 || upType > 4) {
+                maxlimit = 0;
+        } else {
+                // the v-edges keep a negative congCNT in upType 3
+                maxlimit = std::max(updateHistory(h_edges, yGrid * (xGrid - 1), upType, stopDEC, TRUE),
+                                    updateHistory(v_edges, (yGrid - 1) * xGrid, upType, stopDEC, FALSE));
         }
 
         max_adj = maxlimit;
@@ -961,10 +814,10 @@ void reInitTree(int netID) {
         numEdges = 2 * deg - 3;
         for (edgeID = 0; edgeID < numEdges; edgeID++) {
                 treeedge = &(sttrees[netID].edges[edgeID]);
+                // 2D routes only, gridsL is not allocated yet
                 if (treeedge->len > 0) {
                         free(treeedge->route.gridsX);
                         free(treeedge->route.gridsY);
-                        free(treeedge->route.gridsL);
                 }
         }
         free(sttrees[netID].nodes);
@@ -1110,6 +963,8 @@ void mazeRouteMSMD(int iter, int expand, float costHeight, int ripup_threshold,
 
                                 // ripup the routing for the edge
                                 if (enter) {
+                                        // keep the tree of the best solution before changing it
+                                        saveTreeBK(netID);
                                         if (n1y <= n2y) {
                                                 ymin = n1y;
                                                 ymax = n2y;
@@ -1645,8 +1500,6 @@ void mazeRouteMSMD(int iter, int expand, float costHeight, int ripup_threshold,
 
                                         if (checkRoute2DTree(netID)) {
                                                 reInitTree(netID);
-                                                free(netEO);
-                                                netEO = NULL;
                                                 return;
                                         }
                                 }  // congested route
@@ -1671,48 +1524,21 @@ void mazeRouteMSMD(int iter, int expand, float costHeight, int ripup_threshold,
 int getOverflow2Dmaze(int *maxOverflow, int *tUsage) {
         int H_overflow = 0;
         int V_overflow = 0;
-        int grid = 0;
-        int i = 0;
-        int j = 0;
         int max_H_overflow = 0;
         int max_V_overflow = 0;
         int max_overflow = 0;
         int numedges = 0;
-        int overflow = 0;
-        int total_cap = 0;
         int total_usage = 0;
+        OverflowStats hStats, vStats;
 
-        total_usage = 0;
-        total_cap = 0;
-
-        //    fprintf(fph, "Horizontal Congestion\n");
-        for (i = 0; i < yGrid; i++) {
-                for (j = 0; j < xGrid - 1; j++) {
-                        grid = i * (xGrid - 1) + j;
-                        total_usage += h_edges[grid].usage;
-                        overflow = h_edges[grid].usage - h_edges[grid].cap;
-                        total_cap += h_edges[grid].cap;
-                        if (overflow > 0) {
-                                H_overflow += overflow;
-                                max_H_overflow = std::max(max_H_overflow, overflow);
-                                numedges++;
-                        }
-                }
-        }
-        //    fprintf(fpv, "\nVertical Congestion\n");
-        for (i = 0; i < yGrid - 1; i++) {
-                for (j = 0; j < xGrid; j++) {
-                        grid = i * xGrid + j;
-                        total_usage += v_edges[grid].usage;
-                        overflow = v_edges[grid].usage - v_edges[grid].cap;
-                        total_cap += v_edges[grid].cap;
-                        if (overflow > 0) {
-                                V_overflow += overflow;
-                                max_V_overflow = std::max(max_V_overflow, overflow);
-                                numedges++;
-                        }
-                }
-        }
+        sumOverflow(h_edges, yGrid * (xGrid - 1), &hStats);
+        sumOverflow(v_edges, (yGrid - 1) * xGrid, &vStats);
+        H_overflow = hStats.overflow;
+        V_overflow = vStats.overflow;
+        max_H_overflow = hStats.maxOverflow;
+        max_V_overflow = vStats.maxOverflow;
+        numedges = hStats.numOverflow + vStats.numOverflow;
+        total_usage = hStats.usage + vStats.usage;
 
         max_overflow = std::max(max_H_overflow, max_V_overflow);
         totalOverflow = H_overflow + V_overflow;
@@ -1804,45 +1630,20 @@ int getOverflow2D(int *maxOverflow) {
 }
 
 int getOverflow3D(void) {
-        int i, j, k, grid, overflow, max_overflow, H_overflow, max_H_overflow, V_overflow, max_V_overflow;
+        int max_overflow, H_overflow, max_H_overflow, V_overflow, max_V_overflow;
         int cap;
         int total_usage;
-
-        // get overflow
-        overflow = max_overflow = H_overflow = max_H_overflow = V_overflow = max_V_overflow = 0;
-
-        total_usage = 0;
-        cap = 0;
-        //    fprintf(fph, "Horizontal Congestion\n");
-
-        for (k = 0; k < numLayers; k++) {
-                for (i = 0; i < yGrid; i++) {
-                        for (j = 0; j < xGrid - 1; j++) {
-                                grid = i * (xGrid - 1) + j + k * (xGrid - 1) * yGrid;
-                                total_usage += h_edges3D[grid].usage;
-                                overflow = h_edges3D[grid].usage - h_edges3D[grid].cap;
-                                cap += h_edges3D[grid].cap;
-
-                                if (overflow > 0) {
-                                        H_overflow += overflow;
-                                        max_H_overflow = std::max(max_H_overflow, overflow);
-                                }
-                        }
-                }
-                for (i = 0; i < yGrid - 1; i++) {
-                        for (j = 0; j < xGrid; j++) {
-                                grid = i * xGrid + j + k * xGrid * (yGrid - 1);
-                                total_usage += v_edges3D[grid].usage;
-                                overflow = v_edges3D[grid].usage - v_edges3D[grid].cap;
-                                cap += v_edges3D[grid].cap;
-
-                                if (overflow > 0) {
-                                        V_overflow += overflow;
-                                        max_V_overflow = std::max(max_V_overflow, overflow);
-                                }
-                        }
-                }
-        }
+        OverflowStats hStats, vStats;
+
+        // all the layers in one sweep of each array
+        sumOverflow3D(h_edges3D, numLayers * yGrid * (xGrid - 1), &hStats);
+        sumOverflow3D(v_edges3D, numLayers * (yGrid - 1) * xGrid, &vStats);
+        H_overflow = hStats.overflow;
+        V_overflow = vStats.overflow;
+        max_H_overflow = hStats.maxOverflow;
+        max_V_overflow = vStats.maxOverflow;
+        total_usage = hStats.usage + vStats.usage;
+        cap = hStats.cap + vStats.cap;
 
         max_overflow = std::max(max_H_overflow, max_V_overflow);
         totalOverflow = H_overflow + V_overflow;
@@ -791,8 +791,8 @@ void mazeRouteMSMDOrder3D(int expand, int ripupTHlb, int ripupTHub) {
         int edge_n2B1, edge_n2B2, edge_n2D1, edge_n2D2, edge_B1B2, edge_D1D2, D1, D2;
         int E1x, E1y, E2x, E2y, range, corE1, corE2, edgeID;
 
-        Bool Horizontal, n1Shift, n2Shift, redundant;
-        int lastL, origL, headRoom, tailRoom, newcnt_n1n2, numpoints, d, n1a, n2a, connectionCNT;
+        Bool Horizontal, n1Shift, n2Shift;
+        int lastL, origL, headRoom, tailRoom, newcnt_n1n2, d, n1a, n2a, connectionCNT;
         int origEng, orderIndex;
 
         directions3D = (dirctionT ***)calloc(numLayers, sizeof(dirctionT **));
@@ -1482,8 +1482,6 @@ void mazeRouteMSMDOrder3D(int expand, int ripupTHlb, int ripupTHub) {
 
                                         if (n1Shift || n2Shift) {
                                                 // re statis the node overlap
-                                                numpoints = 0;
-
                                                 for (d = 0; d < 2 * deg - 2; d++) {
                                                         treenodes[d].topL = -1;
                                                         treenodes[d].botL = numLayers;
@@ -1499,29 +1497,9 @@ void mazeRouteMSMDOrder3D(int expand, int ripupTHlb, int ripupTHub) {
                                                                 //treenodes[d].l = 0;
                                                                 treenodes[d].assigned = TRUE;
                                                                 treenodes[d].status = 1;
-
-                                                                xcor[numpoints] = treenodes[d].x;
-                                                                ycor[numpoints] = treenodes[d].y;
-                                                                dcor[numpoints] = d;
-                                                                numpoints++;
-                                                        } else {
-                                                                redundant = FALSE;
-                                                                for (k = 0; k < numpoints; k++) {
-                                                                        if ((treenodes[d].x == xcor[k]) && (treenodes[d].y == ycor[k])) {
-                                                                                treenodes[d].stackAlias = dcor[k];
-
-                                                                                redundant = TRUE;
-                                                                                break;
-                                                                        }
-                                                                }
-                                                                if (!redundant) {
-                                                                        xcor[numpoints] = treenodes[d].x;
-                                                                        ycor[numpoints] = treenodes[d].y;
-                                                                        dcor[numpoints] = d;
-                                                                        numpoints++;
-                                                                }
                                                         }
                                                 }  // numerating for nodes
+                                                setStackAlias(treenodes, deg);
                                                 for (k = 0; k < 2 * deg - 3; k++) {
                                                         treeedge = &(treeedges[k]);
 
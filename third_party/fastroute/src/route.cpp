@@ -34,62 +34,431 @@
 #include <time.h>
 #include <math.h>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <queue>
+#include <thread>
+#include <vector>
 #include "DataType.h"
 #include "flute.h"
 #include "DataProc.h"
 #include "route.h"
 #include "RipUp.h"
+#include "LCost.h"
+#include "utility.h"
 
 #define HCOST 5000
+#define WAVE_TILE 64  // tile side used to detect nets that may share edges, a multiple of the congestion index word
+#define MIN_ROWS_PER_THREAD 64  // fewer rows or columns of edges are swept by the calling thread
 
 namespace FastRoute {
 
-float costHVH[XRANGE];  // Horizontal first Z
-float costVHV[YRANGE];  // Vertical first Z
-float costH[YRANGE];    // Horizontal segment cost
-float costV[XRANGE];    // Vertical segment cost
-float costLR[YRANGE];   // Left and right boundary cost
-float costTB[XRANGE];   // Top and bottom boundary cost
+// Congestion index used by the pattern routing passes (Z and monotonic).
+// An edge is congested when its estimated cost (est_usage - cap_lb + red)
+// is positive; only those edges contribute to the segment costs. The flags
+// are kept as bitsets, one per row of h-edges and one per column of v-edges,
+// so empty ranges are skipped a word at a time and non-empty ranges are
+// summed by visiting only the congested edges, in the same order as a plain
+// scan (the float sums are bit-identical). A flag update only touches the
+// 64-bit word holding the edge, so nets routed in the same wave (see
+// routeNetsInWaves) never share a word.
+unsigned long long *hCongBits = NULL;  // row y starts at y*hCongWords
+unsigned long long *vCongBits = NULL;  // column x starts at x*vCongWords
+int hCongWords, vCongWords;
+
+static Bool hEdgeCongested(int grid) {
+        float tmp1 = h_edges[grid].est_usage - hCapacity_lb + h_edges[grid].red;
+        float tmp2 = h_edges[grid].red + h_edges[grid].est_usage - hCapacity_lb;
+        return (tmp1 > 0 || tmp2 > 0);
+}
+
+static Bool vEdgeCongested(int grid) {
+        float tmp1 = v_edges[grid].est_usage - vCapacity_lb + v_edges[grid].red;
+        float tmp2 = v_edges[grid].red + v_edges[grid].est_usage - vCapacity_lb;
+        return (tmp1 > 0 || tmp2 > 0);
+}
 
-float costHVHtest[YRANGE];  // Vertical first Z
-float costVtest[XRANGE];    // Vertical segment cost
-float costTBtest[XRANGE];   // Top and bottom boundary cost
+static void setCongBit(unsigned long long *bits, int pos, Bool flag) {
+        unsigned long long mask = 1ULL << (pos & 63);
 
+        if (flag) {
+                if (!(bits[pos >> 6] & mask))
+                        bits[pos >> 6] |= mask;
+        } else {
+                if (bits[pos >> 6] & mask)
+                        bits[pos >> 6] &= ~mask;
+        }
+}
 
-// estimate the routing by assigning 1 for H and V segments, 0.5 to both possible L for L segments
-void estimateOneSeg(Segment *seg) {
+// first congested position in [from, to), to if there is none
+static int nextCongBit(unsigned long long *bits, int from, int to) {
+        int w, pos;
+        unsigned long long word;
+
+        if (from >= to)
+                return to;
+
+        w = from >> 6;
+        word = bits[w] & (~0ULL << (from & 63));
+        while (word == 0) {
+                w++;
+                if ((w << 6) >= to)
+                        return to;
+                word = bits[w];
+        }
+        pos = (w << 6) + __builtin_ctzll(word);
+        return std::min(pos, to);
+}
+
+void initCongestionIndex() {
+        int i, j;
+
+        hCongWords = (xGrid - 1 + 63) / 64;
+        vCongWords = (yGrid - 1 + 63) / 64;
+        hCongBits = (unsigned long long *)calloc(yGrid * hCongWords, sizeof(unsigned long long));
+        vCongBits = (unsigned long long *)calloc(xGrid * vCongWords, sizeof(unsigned long long));
+
+        for (i = 0; i < yGrid; i++) {
+                for (j = 0; j < xGrid - 1; j++)
+                        setCongBit(&hCongBits[i * hCongWords], j, hEdgeCongested(i * (xGrid - 1) + j));
+        }
+        for (j = 0; j < xGrid; j++) {
+                for (i = 0; i < yGrid - 1; i++)
+                        setCongBit(&vCongBits[j * vCongWords], i, vEdgeCongested(i * xGrid + j));
+        }
+}
+
+void freeCongestionIndex() {
+        free(hCongBits);
+        free(vCongBits);
+        hCongBits = NULL;
+        vCongBits = NULL;
+}
+
+// re-evaluate the congested flag of the h-edges [x1, x2) in row y after their est_usage changed
+static void refreshCongRow(int y, int x1, int x2) {
+        int i;
+
+        for (i = x1; i < x2; i++)
+                setCongBit(&hCongBits[y * hCongWords], i, hEdgeCongested(y * (xGrid - 1) + i));
+}
+
+// re-evaluate the congested flag of the v-edges [y1, y2) in column x after their est_usage changed
+static void refreshCongCol(int x, int y1, int y2) {
+        int j;
+
+        for (j = y1; j < y2; j++)
+                setCongBit(&vCongBits[x * vCongWords], j, vEdgeCongested(j * xGrid + x));
+}
+
+static void refreshCongPath(short *gridsX, short *gridsY, int routelen) {
         int i;
+
+        for (i = 0; i < routelen; i++) {
+                if (gridsX[i] == gridsX[i + 1]) {
+                        refreshCongCol(gridsX[i], std::min(gridsY[i], gridsY[i + 1]), std::max(gridsY[i], gridsY[i + 1]));
+                } else {
+                        refreshCongRow(gridsY[i], std::min(gridsX[i], gridsX[i + 1]), std::max(gridsX[i], gridsX[i + 1]));
+                }
+        }
+}
+
+// re-evaluate the edges used by the L, Z or maze route of a tree edge from (x1, y1) to (x2, y2)
+static void refreshCongRoute(TreeEdge *treeedge, int x1, int y1, int x2, int y2) {
         int ymin, ymax;
 
-        if (seg->y1 < seg->y2) {
-                ymin = seg->y1;
-                ymax = seg->y2;
+        if (treeedge->len == 0)
+                return;
+
+        if (treeedge->route.type == MAZEROUTE) {
+                refreshCongPath(treeedge->route.gridsX, treeedge->route.gridsY, treeedge->route.routelen);
+                return;
+        }
+
+        ymin = std::min(y1, y2);
+        ymax = std::max(y1, y2);
+        refreshCongRow(y1, x1, x2);
+        refreshCongRow(y2, x1, x2);
+        refreshCongCol(x1, ymin, ymax);
+        refreshCongCol(x2, ymin, ymax);
+        if (treeedge->route.type == ZROUTE) {
+                if (treeedge->route.HVH) {
+                        refreshCongCol(treeedge->route.Zpoint, ymin, ymax);
+                } else {
+                        refreshCongRow(treeedge->route.Zpoint, x1, x2);
+                }
+        }
+}
+
+static Bool congEmptyRow(int y, int x1, int x2) {
+        return (nextCongBit(&hCongBits[y * hCongWords], x1, x2) == x2);
+}
+
+static Bool congEmptyCol(int x, int y1, int y2) {
+        return (nextCongBit(&vCongBits[x * vCongWords], y1, y2) == y2);
+}
+
+// sum of the positive h-edge costs in [x1, x2) of row y, accumulated from left to right
+static float congCostRow(int y, int x1, int x2) {
+        unsigned long long *bits = &hCongBits[y * hCongWords];
+        int i, grid;
+        float tmp, cost = 0;
+
+        for (i = nextCongBit(bits, x1, x2); i < x2; i = nextCongBit(bits, i + 1, x2)) {
+                grid = y * (xGrid - 1) + i;
+                tmp = h_edges[grid].est_usage - hCapacity_lb + h_edges[grid].red;
+                if (tmp > 0)
+                        cost += tmp;
+        }
+        return cost;
+}
+
+// sum of the positive v-edge costs in [y1, y2) of column x, accumulated from bottom to top
+static float congCostCol(int x, int y1, int y2) {
+        unsigned long long *bits = &vCongBits[x * vCongWords];
+        int j, grid;
+        float tmp, cost = 0;
+
+        for (j = nextCongBit(bits, y1, y2); j < y2; j = nextCongBit(bits, j + 1, y2)) {
+                grid = j * xGrid + x;
+                tmp = v_edges[grid].est_usage - vCapacity_lb + v_edges[grid].red;
+                if (tmp > 0)
+                        cost += tmp;
+        }
+        return cost;
+}
+
+
+// Footprint of a net in the pattern routing passes: the bbox in gcells of its
+// pins and of its segments (useSegs, in the passes that route the segments
+// before the trees are built) or of its tree nodes. Every edge that routing the net
+// reads or writes lies in the bbox, except the h-edge right after the segment
+// end read by newrouteZ_edge, which wraps to the first edge of the next row at
+// the right border; the first column is locked for it.
+static void netFootprint(int netID, Bool useSegs, int *x1, int *y1, int *x2, int *y2) {
+        int i, xmin, ymin, xmax, ymax;
+        TreeNode *treenodes;
+
+        xmin = xmax = nets[netID]->pinX[0];
+        ymin = ymax = nets[netID]->pinY[0];
+        for (i = 1; i < nets[netID]->deg; i++) {
+                xmin = std::min(xmin, (int)nets[netID]->pinX[i]);
+                xmax = std::max(xmax, (int)nets[netID]->pinX[i]);
+                ymin = std::min(ymin, (int)nets[netID]->pinY[i]);
+                ymax = std::max(ymax, (int)nets[netID]->pinY[i]);
+        }
+        if (useSegs) {
+                for (i = seglistIndex[netID]; i < seglistIndex[netID] + seglistCnt[netID]; i++) {
+                        xmin = std::min(xmin, (int)std::min(seglist[i].x1, seglist[i].x2));
+                        xmax = std::max(xmax, (int)std::max(seglist[i].x1, seglist[i].x2));
+                        ymin = std::min(ymin, (int)std::min(seglist[i].y1, seglist[i].y2));
+                        ymax = std::max(ymax, (int)std::max(seglist[i].y1, seglist[i].y2));
+                }
         } else {
-                ymin = seg->y2;
-                ymax = seg->y1;
+                treenodes = sttrees[netID].nodes;
+                for (i = 0; i < 2 * sttrees[netID].deg - 2; i++) {
+                        xmin = std::min(xmin, (int)treenodes[i].x);
+                        xmax = std::max(xmax, (int)treenodes[i].x);
+                        ymin = std::min(ymin, (int)treenodes[i].y);
+                        ymax = std::max(ymax, (int)treenodes[i].y);
+                }
+        }
+        if (xmax == xGrid - 1) {
+                xmin = 0;
+                ymax = std::min(ymax + 1, yGrid - 1);
         }
 
-        // assign 0.5 to both Ls (x1,y1)-(x1,y2) + (x1,y2)-(x2,y2) + (x1,y1)-(x2,y1) + (x2,y1)-(x2,y2)
-        if (seg->x1 == seg->x2)  // a vertical segment
-        {
-                for (i = ymin; i < ymax; i++)
-                        v_edges[i * xGrid + seg->x1].est_usage += 1;
-        } else if (seg->y1 == seg->y2)  // a horizontal segment
-        {
-                for (i = seg->x1; i < seg->x2; i++)
-                        h_edges[seg->y1 * (xGrid - 1) + i].est_usage += 1;
-        } else  // a diagonal segment
-        {
-                for (i = ymin; i < ymax; i++) {
-                        v_edges[i * xGrid + seg->x1].est_usage += 0.5;
-                        v_edges[i * xGrid + seg->x2].est_usage += 0.5;
+        *x1 = xmin;
+        *x2 = xmax;
+        *y1 = ymin;
+        *y2 = ymax;
+}
+
+// Group the items in waves: items of the same wave have disjoint footprints
+// and items whose footprints overlap keep their relative order in different
+// waves.
+static int buildWaves(int numItems, const WaveFootprint &footprint, std::vector<int> &waveStart, std::vector<int> &waveNets) {
+        int i, x, y, tx1, ty1, tx2, ty2, numTilesX, numTilesY, numWaves;
+        std::vector<int> lastWave, netWave(numItems);
+
+        numTilesX = (xGrid + WAVE_TILE - 1) / WAVE_TILE;
+        numTilesY = (yGrid + WAVE_TILE - 1) / WAVE_TILE;
+        lastWave.assign(numTilesX * numTilesY, -1);
+
+        numWaves = 0;
+        for (i = 0; i < numItems; i++) {
+                footprint(i, &tx1, &ty1, &tx2, &ty2);
+                tx1 /= WAVE_TILE;
+                ty1 /= WAVE_TILE;
+                tx2 /= WAVE_TILE;
+                ty2 /= WAVE_TILE;
+                netWave[i] = 0;
+                for (y = ty1; y <= ty2; y++) {
+                        for (x = tx1; x <= tx2; x++)
+                                netWave[i] = std::max(netWave[i], lastWave[y * numTilesX + x] + 1);
                 }
-                for (i = seg->x1; i < seg->x2; i++) {
-                        h_edges[seg->y1 * (xGrid - 1) + i].est_usage += 0.5;
-                        h_edges[seg->y2 * (xGrid - 1) + i].est_usage += 0.5;
+                for (y = ty1; y <= ty2; y++) {
+                        for (x = tx1; x <= tx2; x++)
+                                lastWave[y * numTilesX + x] = netWave[i];
+                }
+                numWaves = std::max(numWaves, netWave[i] + 1);
+        }
+
+        waveStart.assign(numWaves + 1, 0);
+        for (i = 0; i < numItems; i++)
+                waveStart[netWave[i] + 1]++;
+        for (i = 0; i < numWaves; i++)
+                waveStart[i + 1] += waveStart[i];
+        waveNets.resize(numItems);
+        std::vector<int> fill(waveStart.begin(), waveStart.end() - 1);
+        for (i = 0; i < numItems; i++)
+                waveNets[fill[netWave[i]]++] = i;
+
+        return numWaves;
+}
+
+// Run fn(lo, hi, chunk) over numThreads contiguous chunks of [0, numItems), or
+// over the whole range on the calling thread when the chunks would have less
+// than minItems items. Returns the # chunks; the callers combine the per-chunk
+// results in chunk order.
+int runInChunks(int numItems, int minItems, const std::function<void(int, int, int)> &fn) {
+        int c, numChunks;
+        std::vector<std::thread> workers;
+
+        numChunks = std::max(1, std::min(numThreads, numItems / minItems));
+        if (numChunks == 1) {
+                fn(0, numItems, 0);
+                return 1;
+        }
+        for (c = 1; c < numChunks; c++)
+                workers.push_back(std::thread(fn, (int)((long)numItems * c / numChunks), (int)((long)numItems * (c + 1) / numChunks), c));
+        fn(0, numItems / numChunks, 0);
+        for (c = 0; c < numChunks - 1; c++)
+                workers[c].join();
+        return numChunks;
+}
+
+// Run fn(item, worker) on the items 0 .. numItems-1. With numThreads > 1 the
+// items are processed wave by wave, the items of a wave in parallel; as their
+// footprints are disjoint, the result is the same as processing the items
+// serially in order. worker is the index of the thread, below numThreads.
+void runInWaves(int numItems, const WaveFootprint &footprint, const std::function<void(int, int)> &fn) {
+        int i, numWaves, arrived;
+        std::vector<int> waveStart, waveNets;
+        std::vector<std::thread> workers;
+        std::mutex mtx;
+        std::condition_variable cv;
+
+        if (numThreads <= 1) {
+                for (i = 0; i < numItems; i++)
+                        fn(i, 0);
+                return;
+        }
+
+        numWaves = buildWaves(numItems, footprint, waveStart, waveNets);
+        std::vector<std::atomic<int>> nextNet(numWaves);
+        for (i = 0; i < numWaves; i++)
+                nextNet[i] = 0;
+        arrived = 0;
+
+        auto work = [&](int worker) {
+                int w, k;
+                for (w = 0; w < numWaves; w++) {
+                        while ((k = nextNet[w]++) < waveStart[w + 1] - waveStart[w])
+                                fn(waveNets[waveStart[w] + k], worker);
+
+                        std::unique_lock<std::mutex> lock(mtx);
+                        arrived++;
+                        if (arrived == numThreads * (w + 1))
+                                cv.notify_all();
+                        else
+                                cv.wait(lock, [&] { return arrived >= numThreads * (w + 1); });
+                }
+        };
+
+        for (i = 1; i < numThreads; i++)
+                workers.push_back(std::thread(work, i));
+        work(0);
+        for (i = 0; i < numThreads - 1; i++)
+                workers[i].join();
+}
+
+// Run routeNet on every net, in parallel waves of nets that never touch the
+// same edges (see runInWaves and netFootprint).
+static void routeNetsInWaves(Bool useSegs, const std::function<void(int)> &routeNet) {
+        runInWaves(numValidNets,
+                   [useSegs](int netID, int *x1, int *y1, int *x2, int *y2) {
+                           netFootprint(netID, useSegs, x1, y1, x2, y2);
+                   },
+                   [&routeNet](int netID, int) { routeNet(netID); });
+}
+
+// Estimate the routing of all the segments by assigning 1 for H and V
+// segments, 0.5 to both possible L for L segments. Each segment only adds its
+// ends, in half units, to difference arrays along the rows of h-edges and the
+// columns of v-edges; a prefix sum over each row and column then gives the
+// usage of every edge. The usages are multiples of 0.5, exact in float, so
+// est_usage is the one of adding the segments one edge at a time.
+static void estimateAllSegs() {
+        int i, j, ymin, ymax;
+        Segment *seg;
+        std::vector<int> hDiff(yGrid * xGrid, 0), vDiff(yGrid * xGrid, 0);  // both [y][x], x1 <= x2 in the segments
+
+        for (j = 0; j < numValidNets; j++) {
+                for (i = seglistIndex[j]; i < seglistIndex[j] + seglistCnt[j]; i++) {
+                        seg = &seglist[i];
+                        ymin = std::min(seg->y1, seg->y2);
+                        ymax = std::max(seg->y1, seg->y2);
+
+                        // assign 0.5 to both Ls (x1,y1)-(x1,y2) + (x1,y2)-(x2,y2) + (x1,y1)-(x2,y1) + (x2,y1)-(x2,y2)
+                        if (seg->x1 == seg->x2)  // a vertical segment
+                        {
+                                vDiff[ymin * xGrid + seg->x1] += 2;
+                                vDiff[ymax * xGrid + seg->x1] -= 2;
+                        } else if (seg->y1 == seg->y2)  // a horizontal segment
+                        {
+                                hDiff[seg->y1 * xGrid + seg->x1] += 2;
+                                hDiff[seg->y1 * xGrid + seg->x2] -= 2;
+                        } else  // a diagonal segment
+                        {
+                                vDiff[ymin * xGrid + seg->x1]++;
+                                vDiff[ymax * xGrid + seg->x1]--;
+                                vDiff[ymin * xGrid + seg->x2]++;
+                                vDiff[ymax * xGrid + seg->x2]--;
+                                hDiff[seg->y1 * xGrid + seg->x1]++;
+                                hDiff[seg->y1 * xGrid + seg->x2]--;
+                                hDiff[seg->y2 * xGrid + seg->x1]++;
+                                hDiff[seg->y2 * xGrid + seg->x2]--;
+                        }
                 }
         }
+
+        // rows of h-edges
+        runInChunks(yGrid, MIN_ROWS_PER_THREAD, [&hDiff](int lo, int hi, int) {
+                int x, y, halves;
+                for (y = lo; y < hi; y++) {
+                        halves = 0;
+                        for (x = 0; x < xGrid - 1; x++) {
+                                halves += hDiff[y * xGrid + x];
+                                if (halves != 0)
+                                        h_edges[y * (xGrid - 1) + x].est_usage += 0.5 * halves;
+                        }
+                }
+        });
+        // columns of v-edges, swept row by row with a running sum per column
+        runInChunks(xGrid, MIN_ROWS_PER_THREAD, [&vDiff](int lo, int hi, int) {
+                int x, y;
+                std::vector<int> halves(hi - lo, 0);
+                for (y = 0; y < yGrid - 1; y++) {
+                        for (x = lo; x < hi; x++) {
+                                halves[x - lo] += vDiff[y * xGrid + x];
+                                if (halves[x - lo] != 0)
+                                        v_edges[y * xGrid + x].est_usage += 0.5 * halves[x - lo];
+                        }
+                }
+        });
 }
 
 void routeSegV(Segment *seg) {
@@ -117,8 +486,8 @@ void routeSegH(Segment *seg) {
 
 // L-route, based on previous L route
 void routeSegL(Segment *seg) {
-        int i, grid, grid1;
-        float costL1, costL2, tmp;
+        int i, grid;
+        float costL1, costL2;
         int ymin, ymax;
 
         if (seg->y1 < seg->y2) {
@@ -136,26 +505,7 @@ void routeSegL(Segment *seg) {
         else  // L route
         {
                 costL1 = costL2 = 0;
-
-                for (i = ymin; i < ymax; i++) {
-                        grid = i * xGrid;
-                        tmp = v_edges[grid + seg->x1].red + v_edges[grid + seg->x1].est_usage - vCapacity_lb;
-                        if (tmp > 0)
-                                costL1 += tmp;
-                        tmp = v_edges[grid + seg->x2].red + v_edges[grid + seg->x2].est_usage - vCapacity_lb;
-                        if (tmp > 0)
-                                costL2 += tmp;
-                }
-                grid = seg->y2 * (xGrid - 1);
-                grid1 = seg->y1 * (xGrid - 1);
-                for (i = seg->x1; i < seg->x2; i++) {
-                        tmp = h_edges[grid + i].red + h_edges[grid + i].est_usage - hCapacity_lb;
-                        if (tmp > 0)
-                                costL1 += tmp;
-                        tmp = h_edges[grid1 + i].red + h_edges[grid1 + i].est_usage - hCapacity_lb;
-                        if (tmp > 0)
-                                costL2 += tmp;
-                }
+                evalLCost(seg->x1, seg->y1, seg->x2, seg->y2, &costL1, &costL2);
 
                 printf("costL1 is %f, costL2 is %f\n", costL1, costL2);
 
@@ -187,7 +537,7 @@ void routeSegL(Segment *seg) {
 // First time L-route, based on 0.5-0.5 estimation
 void routeSegLFirstTime(Segment *seg) {
         int i, vedge, hedge;
-        float costL1, costL2, tmp;
+        float costL1, costL2;
         int ymin, ymax;
 
         if (seg->y1 < seg->y2) {
@@ -199,32 +549,7 @@ void routeSegLFirstTime(Segment *seg) {
         }
 
         costL1 = costL2 = 0;
-
-        for (i = ymin; i < ymax; i++) {
-                vedge = i * xGrid + seg->x1;
-                tmp = v_edges[vedge].red + v_edges[vedge].est_usage - vCapacity_lb;
-                if (tmp > 0)
-                        costL1 += tmp;
-        }
-        for (i = ymin; i < ymax; i++) {
-                vedge = i * xGrid + seg->x2;
-                tmp = v_edges[vedge].red + v_edges[vedge].est_usage - vCapacity_lb;
-                if (tmp > 0)
-                        costL2 += tmp;
-        }
-
-        for (i = seg->x1; i < seg->x2; i++) {
-                hedge = seg->y2 * (xGrid - 1) + i;
-                tmp = h_edges[hedge].red + h_edges[hedge].est_usage - hCapacity_lb;
-                if (tmp > 0)
-                        costL1 += tmp;
-        }
-        for (i = seg->x1; i < seg->x2; i++) {
-                hedge = seg->y1 * (xGrid - 1) + i;
-                tmp = h_edges[hedge].red + h_edges[hedge].est_usage - hCapacity_lb;
-                if (tmp > 0)
-                        costL2 += tmp;
-        }
+        evalLCost(seg->x1, seg->y1, seg->x2, seg->y2, &costL1, &costL2);
 
         if (costL1 < costL2) {
                 // two parts (x1, y1)-(x1, y2) and (x1, y2)-(x2, y2)
@@ -261,27 +586,23 @@ void routeSegLFirstTime(Segment *seg) {
 
 // route all segments with L, firstTime: TRUE, no previous route, FALSE - previous is L-route
 void routeLAll(Bool firstTime) {
-        int i, j;
-
         if (firstTime)  // no previous route
         {
                 // estimate congestion with 0.5+0.5 L
-                for (i = 0; i < numValidNets; i++) {
-                        for (j = seglistIndex[i]; j < seglistIndex[i] + seglistCnt[i]; j++) {
-                                estimateOneSeg(&seglist[j]);
-                        }
-                }
+                estimateAllSegs();
                 // L route
-                for (i = 0; i < numValidNets; i++) {
+                routeNetsInWaves(TRUE, [](int i) {
+                        int j;
                         for (j = seglistIndex[i]; j < seglistIndex[i] + seglistCnt[i]; j++) {
                                 // no need to reroute the H or V segs
                                 if (seglist[j].x1 != seglist[j].x2 || seglist[j].y1 != seglist[j].y2)
                                         routeSegLFirstTime(&seglist[j]);
                         }
-                }
+                });
         } else  // previous is L-route
         {
-                for (i = 0; i < numValidNets; i++) {
+                routeNetsInWaves(TRUE, [](int i) {
+                        int j;
                         for (j = seglistIndex[i]; j < seglistIndex[i] + seglistCnt[i]; j++) {
                                 // no need to reroute the H or V segs
                                 if (seglist[j].x1 != seglist[j].x2 || seglist[j].y1 != seglist[j].y2) {
@@ -289,15 +610,15 @@ void routeLAll(Bool firstTime) {
                                         routeSegL(&seglist[j]);
                                 }
                         }
-                }
+                });
         }
 }
 
 // L-route, rip-up the previous route according to the ripuptype
 // L-route, rip-up the previous route according to the ripuptype
 void newrouteL(int netID, RouteType ripuptype, Bool viaGuided) {
-        int i, j, d, n1, n2, x1, y1, x2, y2, grid, grid1;
-        float costL1, costL2, tmp;
+        int i, j, d, n1, n2, x1, y1, x2, y2, grid;
+        float costL1, costL2;
         int ymin, ymax;
         TreeEdge *treeedges, *treeedge;
         TreeNode *treenodes;
@@ -377,25 +698,7 @@ void newrouteL(int netID, RouteType ripuptype, Bool viaGuided) {
                                         costL1 = costL2 = 0;
                                 }
 
-                                for (j = ymin; j < ymax; j++) {
-                                        grid = j * xGrid;
-                                        tmp = v_edges[grid + x1].est_usage - vCapacity_lb + v_edges[grid + x1].red;
-                                        if (tmp > 0)
-                                                costL1 += tmp;
-                                        tmp = v_edges[grid + x2].est_usage - vCapacity_lb + v_edges[grid + x2].red;
-                                        if (tmp > 0)
-                                                costL2 += tmp;
-                                }
-                                grid = y2 * (xGrid - 1);
-                                grid1 = y1 * (xGrid - 1);
-                                for (j = x1; j < x2; j++) {
-                                        tmp = h_edges[grid + j].est_usage - hCapacity_lb + h_edges[grid + j].red;
-                                        if (tmp > 0)
-                                                costL1 += tmp;
-                                        tmp = h_edges[grid1 + j].est_usage - hCapacity_lb + h_edges[grid1 + j].red;
-                                        if (tmp > 0)
-                                                costL2 += tmp;
-                                }
+                                evalLCost(x1, y1, x2, y2, &costL1, &costL2);
 
                                 if (costL1 < costL2) {
                                         if (treenodes[n1].status % 2 == 0) {
@@ -443,22 +746,26 @@ void newrouteL(int netID, RouteType ripuptype, Bool viaGuided) {
 
 // route all segments with L, firstTime: TRUE, first newrouteLAll, FALSE - not first
 void newrouteLAll(Bool firstTime, Bool viaGuided) {
-        int i;
-
         if (firstTime) {
-                for (i = 0; i < numValidNets; i++) {
+                routeNetsInWaves(FALSE, [viaGuided](int i) {
                         newrouteL(i, NOROUTE, viaGuided);  // do L-routing
-                }
+                });
         } else {
-                for (i = 0; i < numValidNets; i++) {
+                routeNetsInWaves(FALSE, [viaGuided](int i) {
                         newrouteL(i, LROUTE, viaGuided);
-                }
+                });
         }
 }
 
 void newrouteZ_edge(int netID, int edgeID) {
         int i, j, n1, n2, x1, y1, x2, y2, segWidth, bestZ, grid, grid1, grid2, ymin, ymax;
         float tmp, bestcost, btTEST;
+        float costHVH[XRANGE];      // Horizontal first Z
+        float costV[XRANGE];        // Vertical segment cost
+        float costTB[XRANGE];       // Top and bottom boundary cost
+        float costHVHtest[XRANGE];  // Horizontal first Z
+        float costVtest[XRANGE];    // Vertical segment cost
+        float costTBtest[XRANGE];   // Top and bottom boundary cost
         Bool HVH;        // the shape of Z routing (TRUE - HVH, FALSE - VHV)
         TreeEdge *treeedges, *treeedge;
         TreeNode *treenodes;
@@ -593,9 +900,17 @@ void newrouteZ_edge(int netID, int edgeID) {
 }
 
 // Z-route, rip-up the previous route according to the ripuptype
+// the congestion index has to be built before (see newrouteZAll)
 void newrouteZ(int netID, int threshold) {
         int ind, i, j, d, n1, n2, x1, y1, x2, y2, segWidth, segHeight, bestZ, grid, grid1, grid2, ymin, ymax, n1a, n2a, status1, status2;
         float tmp, bestcost, btTEST;
+        float costHVH[XRANGE];      // Horizontal first Z
+        float costVHV[YRANGE];      // Vertical first Z
+        float costH[YRANGE];        // Horizontal segment cost
+        float costV[XRANGE];        // Vertical segment cost
+        float costLR[YRANGE];       // Left and right boundary cost
+        float costTB[XRANGE];       // Top and bottom boundary cost
+        float costHVHtest[XRANGE];  // Horizontal first Z
         Bool HVH;        // the shape of Z routing (TRUE - HVH, FALSE - VHV)
         Bool y1Smaller;  // TRUE - y1<y2, FALSE y1>y2
         TreeEdge *treeedges, *treeedge;
@@ -685,31 +1000,16 @@ void newrouteZ(int netID, int threshold) {
                                         }
 
                                         for (i = 0; i < segWidth; i++) {
-                                                costV[i] = 0;
                                                 costTB[i] = 0;
-
-                                                costVtest[i] = 0;
-                                                costTBtest[i] = 0;
                                         }
                                         for (i = 0; i < segHeight; i++) {
-                                                costH[i] = 0;
                                                 costLR[i] = 0;
                                         }
 
                                         // compute the cost for all H-segs and V-segs and partial boundary seg
-                                        // cost for V-segs
+                                        // cost for V-segs, only the congested edges of each column are visited
                                         for (i = x1; i < x2; i++) {
-                                                grid = ymin * xGrid;
-                                                for (j = ymin; j < ymax; j++) {
-                                                        tmp = v_edges[grid + i].est_usage - vCapacity_lb + v_edges[grid + i].red;
-                                                        grid += xGrid;
-                                                        if (tmp > 0) {
-                                                                costV[i - x1] += tmp;
-                                                                costVtest[i - x1] += HCOST;
-                                                        } else {
-                                                                costVtest[i - x1] += tmp;
-                                                        }
-                                                }
+                                                costV[i - x1] = congCostCol(i, ymin, ymax);
                                         }
                                         //cost for Top&Bot boundary segs (form Z with V-seg)
                                         grid = y2 * (xGrid - 1);
@@ -717,9 +1017,6 @@ void newrouteZ(int netID, int threshold) {
                                                 tmp = h_edges[grid + j].est_usage - hCapacity_lb + h_edges[grid + j].red;
                                                 if (tmp > 0) {
                                                         costTB[0] += tmp;
-                                                        costTBtest[0] += HCOST;
-                                                } else {
-                                                        costTBtest[0] += tmp;
                                                 }
                                         }
                                         grid1 = y1 * (xGrid - 1) + x1;
@@ -729,27 +1026,15 @@ void newrouteZ(int netID, int threshold) {
                                                 tmp = h_edges[grid1 + i - 1].est_usage - hCapacity_lb + h_edges[grid1 + i - 1].red;
                                                 if (tmp > 0) {
                                                         costTB[i] += tmp;
-                                                        costTBtest[0] += HCOST;
-                                                } else {
-                                                        costTBtest[0] += tmp;
                                                 }
                                                 tmp = h_edges[grid2 + i - 1].est_usage - hCapacity_lb + h_edges[grid2 + i - 1].red;
                                                 if (tmp > 0) {
                                                         costTB[i] -= tmp;
-                                                        costTBtest[0] -= HCOST;
-                                                } else {
-                                                        costTBtest[0] -= tmp;
                                                 }
                                         }
-                                        // cost for H-segs
-                                        grid = ymin * (xGrid - 1);
+                                        // cost for H-segs, only the congested edges of each row are visited
                                         for (i = ymin; i < ymax; i++) {
-                                                for (j = x1; j < x2; j++) {
-                                                        tmp = h_edges[grid + j].est_usage - hCapacity_lb + h_edges[grid + j].red;
-                                                        if (tmp > 0)
-                                                                costH[i - ymin] += tmp;
-                                                }
-                                                grid += xGrid - 1;
+                                                costH[i - ymin] = congCostRow(i, x1, x2);
                                         }
                                         //cost for Left&Right boundary segs (form Z with H-seg)
                                         if (y1Smaller) {
@@ -890,6 +1175,8 @@ void newrouteZ(int netID, int threshold) {
                                                 newrouteZ_edge(netID, ind);
                                         }
                                 }
+                                // the ripped L route lies on the bbox boundary, which is refreshed for the new route as well
+                                refreshCongRoute(treeedge, x1, y1, x2, y2);
                         }
 
                 } else
@@ -903,10 +1190,11 @@ void newrouteZ(int netID, int threshold) {
 // ripup a tree edge according to its ripup type and Z-route it
 // route all segments with L, firstTime: TRUE, first newrouteLAll, FALSE - not first
 void newrouteZAll(int threshold) {
-        int i;
-        for (i = 0; i < numValidNets; i++) {
+        initCongestionIndex();
+        routeNetsInWaves(FALSE, [threshold](int i) {
                 newrouteZ(i, threshold);  // ripup previous route and do Z-routing
-        }
+        });
+        freeCongestionIndex();
 }
 
 // Ripup the original route and do Monotonic routing within bounding box
@@ -916,6 +1204,7 @@ void routeMonotonic(int netID, int edgeID, int threshold) {
         int gridsX[XRANGE + YRANGE], gridsY[XRANGE + YRANGE];
         float **cost, tmp;
         Bool **parent;  // remember the parent of a grid on the shortest path, TRUE - same x, FALSE - same y
+        Bool congFree;
         TreeEdge *treeedges, *treeedge;
         TreeNode *treenodes;
 
@@ -935,6 +1224,7 @@ void routeMonotonic(int netID, int edgeID, int threshold) {
                 {
                         // ripup the original routing
                         newRipup(treeedge, treenodes, x1, y1, x2, y2);
+                        refreshCongRoute(treeedge, x1, y1, x2, y2);
 
                         segWidth = ADIFF(x1, x2);
                         segHeight = ADIFF(y1, y2);
@@ -951,135 +1241,181 @@ void routeMonotonic(int netID, int edgeID, int threshold) {
                         }
 
                         // find the best monotonic path from (x1, y1) to (x2, y2)
-                        cost = (float **)malloc((segHeight + 1) * sizeof(float *));
-                        parent = (Bool **)malloc((segHeight + 1) * sizeof(Bool *));
-                        for (i = 0; i <= segHeight; i++) {
-                                cost[i] = (float *)malloc((segWidth + 1) * sizeof(float));
-                                parent[i] = (Bool *)malloc((segWidth + 1) * sizeof(Bool));
+                        // without any congested edge in the bbox every cost is 0 and the path found by the
+                        // DP below always goes along row yr first and then along column xl
+                        congFree = TRUE;
+                        for (i = std::min(yl, yr); i <= std::max(yl, yr) && congFree; i++) {
+                                if (!congEmptyRow(i, xl, xr))
+                                        congFree = FALSE;
+                        }
+                        for (i = xl; i <= xr && congFree; i++) {
+                                if (!congEmptyCol(i, std::min(yl, yr), std::max(yl, yr)))
+                                        congFree = FALSE;
                         }
 
-                        xGrid_1 = xGrid - 1;  // tmp variable to save runtime
-                        if (yl <= yr) {
-                                // initialize first column
-                                cost[0][0] = 0;
-                                grid = yl * xGrid;
-                                for (j = 0; j < segHeight; j++) {
-                                        cost[j + 1][0] = cost[j][0] + std::max<float>(0, v_edges[grid + xl].red + v_edges[grid + xl].est_usage - vCapacity_lb);
-                                        parent[j + 1][0] = SAMEX;
-                                        grid += xGrid;
-                                }
-                                // update other columns
-                                for (i = 0; i < segWidth; i++) {
-                                        x = xl + i;
-                                        // update the cost of a column of grids by h-edges
-                                        grid = yl * xGrid_1;
-                                        for (j = 0; j <= segHeight; j++) {
-                                                tmp = std::max<float>(0, h_edges[grid + x].red + h_edges[grid + x].est_usage - hCapacity_lb);
-                                                cost[j][i + 1] = cost[j][i] + tmp;
-                                                parent[j][i + 1] = SAMEY;
-                                                grid += xGrid - 1;
-                                        }
-                                        // update the cost of a column of grids by v-edges
-                                        grid = yl * xGrid;
-                                        ind_x = x + 1;
-                                        ind_i = i + 1;
-                                        for (j = 0; j < segHeight; j++) {
-                                                ind_j = j + 1;
-                                                tmp = cost[j][ind_i] + std::max<float>(0, v_edges[grid + ind_x].red + v_edges[grid + ind_x].est_usage - vCapacity_lb);
-                                                if (cost[ind_j][ind_i] > tmp) {
-                                                        cost[ind_j][ind_i] = tmp;
-                                                        parent[ind_j][ind_i] = SAMEX;
-                                                }
-                                                grid += xGrid;
-                                        }
-                                }
-
-                                // store the shortest path and update the usage
+                        if (congFree) {
                                 curX = xr;
                                 curY = yr;
                                 cnt = 0;
-
-                                while (curX != xl || curY != yl) {
-                                        //printf("xl is %d, yl is %d, curX is %d, curY is %d\n",xl,yl,curX,curY);
-                                        //printf("%d\n", sttrees[netID].deg);
+                                while (curX != xl) {
                                         gridsX[cnt] = curX;
                                         gridsY[cnt] = curY;
                                         cnt++;
-                                        if (parent[curY - yl][curX - xl] == SAMEX) {
+                                        curX--;
+                                        h_edges[curY * (xGrid - 1) + curX].est_usage += 1;
+                                }
+                                while (curY != yl) {
+                                        gridsX[cnt] = curX;
+                                        gridsY[cnt] = curY;
+                                        cnt++;
+                                        if (curY > yl) {
                                                 curY--;
-                                                vedge = curY * xGrid + curX;
-                                                v_edges[vedge].est_usage += 1;
+                                                v_edges[curY * xGrid + curX].est_usage += 1;
                                         } else {
-                                                curX--;
-                                                hedge = curY * (xGrid - 1) + curX;
-                                                h_edges[hedge].est_usage += 1;
+                                                v_edges[curY * xGrid + curX].est_usage += 1;
+                                                curY++;
                                         }
                                 }
-
                                 gridsX[cnt] = xl;
                                 gridsY[cnt] = yl;
                                 cnt++;
+                        } else {
+                                cost = (float **)malloc((segHeight + 1) * sizeof(float *));
+                                parent = (Bool **)malloc((segHeight + 1) * sizeof(Bool *));
+                                for (i = 0; i <= segHeight; i++) {
+                                        cost[i] = (float *)malloc((segWidth + 1) * sizeof(float));
+                                        parent[i] = (Bool *)malloc((segWidth + 1) * sizeof(Bool));
+                                }
 
-                        }  // yl<=yr
+                                xGrid_1 = xGrid - 1;  // tmp variable to save runtime
+                                if (yl <= yr) {
+                                        // initialize first column
+                                        cost[0][0] = 0;
+                                        grid = yl * xGrid;
+                                        for (j = 0; j < segHeight; j++) {
+                                                cost[j + 1][0] = cost[j][0] + std::max<float>(0, v_edges[grid + xl].red + v_edges[grid + xl].est_usage - vCapacity_lb);
+                                                parent[j + 1][0] = SAMEX;
+                                                grid += xGrid;
+                                        }
+                                        // update other columns
+                                        for (i = 0; i < segWidth; i++) {
+                                                x = xl + i;
+                                                // update the cost of a column of grids by h-edges
+                                                grid = yl * xGrid_1;
+                                                for (j = 0; j <= segHeight; j++) {
+                                                        tmp = std::max<float>(0, h_edges[grid + x].red + h_edges[grid + x].est_usage - hCapacity_lb);
+                                                        cost[j][i + 1] = cost[j][i] + tmp;
+                                                        parent[j][i + 1] = SAMEY;
+                                                        grid += xGrid - 1;
+                                                }
+                                                // update the cost of a column of grids by v-edges
+                                                grid = yl * xGrid;
+                                                ind_x = x + 1;
+                                                ind_i = i + 1;
+                                                for (j = 0; j < segHeight; j++) {
+                                                        ind_j = j + 1;
+                                                        tmp = cost[j][ind_i] + std::max<float>(0, v_edges[grid + ind_x].red + v_edges[grid + ind_x].est_usage - vCapacity_lb);
+                                                        if (cost[ind_j][ind_i] > tmp) {
+                                                                cost[ind_j][ind_i] = tmp;
+                                                                parent[ind_j][ind_i] = SAMEX;
+                                                        }
+                                                        grid += xGrid;
+                                                }
+                                        }
 
-                        else  // yl>yr
-                        {
-                                // initialize first column
-                                cost[segHeight][0] = 0;
-                                grid = (yl - 1) * xGrid;
-                                for (j = segHeight - 1; j >= 0; j--) {
-                                        cost[j][0] = cost[j + 1][0] + std::max<float>(0, v_edges[grid + xl].red + v_edges[grid + xl].est_usage - vCapacity_lb);
-                                        parent[j][0] = SAMEX;
-                                        grid -= xGrid;
-                                }
-                                // update other columns
-                                for (i = 0; i < segWidth; i++) {
-                                        x = xl + i;
-                                        // update the cost of a column of grids by h-edges
-                                        grid = yl * (xGrid - 1);
-                                        ind_i = i + 1;
-                                        for (j = segHeight; j >= 0; j--) {
-                                                tmp = std::max<float>(0, h_edges[grid + x].red + h_edges[grid + x].est_usage - hCapacity_lb);
-                                                cost[j][ind_i] = cost[j][i] + tmp;
-                                                parent[j][ind_i] = SAMEY;
-                                                grid -= xGrid - 1;
+                                        // store the shortest path and update the usage
+                                        curX = xr;
+                                        curY = yr;
+                                        cnt = 0;
+
+                                        while (curX != xl || curY != yl) {
+                                                //printf("xl is %d, yl is %d, curX is %d, curY is %d\n",xl,yl,curX,curY);
+                                                //printf("%d\n", sttrees[netID].deg);
+                                                gridsX[cnt] = curX;
+                                                gridsY[cnt] = curY;
+                                                cnt++;
+                                                if (parent[curY - yl][curX - xl] == SAMEX) {
+                                                        curY--;
+                                                        vedge = curY * xGrid + curX;
+                                                        v_edges[vedge].est_usage += 1;
+                                                } else {
+                                                        curX--;
+                                                        hedge = curY * (xGrid - 1) + curX;
+                                                        h_edges[hedge].est_usage += 1;
+                                                }
                                         }
-                                        // update the cost of a column of grids by v-edges
+
+                                        gridsX[cnt] = xl;
+                                        gridsY[cnt] = yl;
+                                        cnt++;
+
+                                }  // yl<=yr
+
+                                else  // yl>yr
+                                {
+                                        // initialize first column
+                                        cost[segHeight][0] = 0;
                                         grid = (yl - 1) * xGrid;
-                                        ind_x = x + 1;
                                         for (j = segHeight - 1; j >= 0; j--) {
-                                                tmp = cost[j + 1][ind_i] + std::max<float>(0, v_edges[grid + ind_x].red + v_edges[grid + ind_x].est_usage - vCapacity_lb);
-                                                if (cost[j][ind_i] > tmp) {
-                                                        cost[j][ind_i] = tmp;
-                                                        parent[j][ind_i] = SAMEX;
-                                                }
+                                                cost[j][0] = cost[j + 1][0] + std::max<float>(0, v_edges[grid + xl].red + v_edges[grid + xl].est_usage - vCapacity_lb);
+                                                parent[j][0] = SAMEX;
                                                 grid -= xGrid;
                                         }
-                                }
+                                        // update other columns
+                                        for (i = 0; i < segWidth; i++) {
+                                                x = xl + i;
+                                                // update the cost of a column of grids by h-edges
+                                                grid = yl * (xGrid - 1);
+                                                ind_i = i + 1;
+                                                for (j = segHeight; j >= 0; j--) {
+                                                        tmp = std::max<float>(0, h_edges[grid + x].red + h_edges[grid + x].est_usage - hCapacity_lb);
+                                                        cost[j][ind_i] = cost[j][i] + tmp;
+                                                        parent[j][ind_i] = SAMEY;
+                                                        grid -= xGrid - 1;
+                                                }
+                                                // update the cost of a column of grids by v-edges
+                                                grid = (yl - 1) * xGrid;
+                                                ind_x = x + 1;
+                                                for (j = segHeight - 1; j >= 0; j--) {
+                                                        tmp = cost[j + 1][ind_i] + std::max<float>(0, v_edges[grid + ind_x].red + v_edges[grid + ind_x].est_usage - vCapacity_lb);
+                                                        if (cost[j][ind_i] > tmp) {
+                                                                cost[j][ind_i] = tmp;
+                                                                parent[j][ind_i] = SAMEX;
+                                                        }
+                                                        grid -= xGrid;
+                                                }
+                                        }
 
-                                // store the shortest path and update the usage
-                                curX = xr;
-                                curY = yr;
-                                cnt = 0;
-                                while (curX != xl || curY != yl) {
-                                        gridsX[cnt] = curX;
-                                        gridsY[cnt] = curY;
-                                        cnt++;
-                                        if (parent[curY - yr][curX - xl] == SAMEX) {
-                                                vedge = curY * xGrid + curX;
-                                                v_edges[vedge].est_usage += 1;
-                                                curY++;
-                                        } else {
-                                                curX--;
-                                                hedge = curY * (xGrid - 1) + curX;
-                                                h_edges[hedge].est_usage += 1;
+                                        // store the shortest path and update the usage
+                                        curX = xr;
+                                        curY = yr;
+                                        cnt = 0;
+                                        while (curX != xl || curY != yl) {
+                                                gridsX[cnt] = curX;
+                                                gridsY[cnt] = curY;
+                                                cnt++;
+                                                if (parent[curY - yr][curX - xl] == SAMEX) {
+                                                        vedge = curY * xGrid + curX;
+                                                        v_edges[vedge].est_usage += 1;
+                                                        curY++;
+                                                } else {
+                                                        curX--;
+                                                        hedge = curY * (xGrid - 1) + curX;
+                                                        h_edges[hedge].est_usage += 1;
+                                                }
                                         }
-                                }
-                                gridsX[cnt] = xl;
-                                gridsY[cnt] = yl;
-                                cnt++;
+                                        gridsX[cnt] = xl;
+                                        gridsY[cnt] = yl;
+                                        cnt++;
 
-                        }  // yl>yr
+                                }  // yl>yr
+                                for (i = 0; i <= segHeight; i++) {
+                                        free(cost[i]);
+                                        free(parent[i]);
+                                }
+                                free(cost);
+                                free(parent);
+                        }
                         treeedge->route.routelen = cnt - 1;
 
                         treeedge->route.gridsX = (short *)realloc(treeedge->route.gridsX, cnt * sizeof(short));
@@ -1099,13 +1435,7 @@ void routeMonotonic(int netID, int edgeID, int threshold) {
                                         treeedge->route.gridsY[i] = gridsY[i];
                                 }
                         }
-
-                        for (i = 0; i <= segHeight; i++) {
-                                free(cost[i]);
-                                free(parent[i]);
-                        }
-                        free(cost);
-                        free(parent);
+                        refreshCongPath(treeedge->route.gridsX, treeedge->route.gridsY, treeedge->route.routelen);
 
                 }  // if(x1!=x2 || y1!=y2)
         }          // non-degraded edge
@@ -1114,11 +1444,13 @@ void routeMonotonic(int netID, int edgeID, int threshold) {
 void routeMonotonicAll(int threshold) {
         int netID, edgeID;
 
+        initCongestionIndex();
         for (netID = 0; netID < numValidNets; netID++) {
                 for (edgeID = 0; edgeID < sttrees[netID].deg * 2 - 3; edgeID++) {
                         routeMonotonic(netID, edgeID, threshold);  // ripup previous route and do Monotonic routing
                 }
         }
+        freeCongestionIndex();
         printf("MonotonicAll OK\n");
 }
 
@@ -1298,20 +1630,16 @@ void spiralRoute(int netID, int edgeID) {
 }
 
 void spiralRouteAll() {
-        int netID, d, k, edgeID, nodeID, deg, numpoints, n1, n2;
+        int netID, d, edgeID, deg, n1, n2;
         int na;
-        Bool redundant;
         TreeEdge *treeedges, *treeedge;
         TreeNode *treenodes;
-        std::queue<int> edgeQueue;
 
         for (netID = 0; netID < numValidNets; netID++) {
                 treeedges = sttrees[netID].edges;
                 treenodes = sttrees[netID].nodes;
                 deg = sttrees[netID].deg;
 
-                numpoints = 0;
-
                 for (d = 0; d < 2 * deg - 2; d++) {
                         treenodes[d].topL = -1;
                         treenodes[d].botL = MAXLAYER;
@@ -1328,28 +1656,9 @@ void spiralRouteAll() {
                                 //treenodes[d].l = 0;
                                 treenodes[d].assigned = TRUE;
                                 treenodes[d].status = 2;
-
-                                xcor[numpoints] = treenodes[d].x;
-                                ycor[numpoints] = treenodes[d].y;
-                                dcor[numpoints] = d;
-                                numpoints++;
-                        } else {
-                                redundant = FALSE;
-                                for (k = 0; k < numpoints; k++) {
-                                        if ((treenodes[d].x == xcor[k]) && (treenodes[d].y == ycor[k])) {
-                                                treenodes[d].stackAlias = dcor[k];
-                                                redundant = TRUE;
-                                                break;
-                                        }
-                                }
-                                if (!redundant) {
-                                        xcor[numpoints] = treenodes[d].x;
-                                        ycor[numpoints] = treenodes[d].y;
-                                        dcor[numpoints] = d;
-                                        numpoints++;
-                                }
                         }
                 }
+                setStackAlias(treenodes, deg);
         }
 
         for (netID = 0; netID < numValidNets; netID++) {
@@ -1377,7 +1686,12 @@ void spiralRouteAll() {
                 }
         }
 
-        for (netID = 0; netID < numValidNets; netID++) {
+        routeNetsInWaves(FALSE, [](int netID) {
+                int k, edgeID, nodeID, deg;
+                TreeEdge *treeedges, *treeedge;
+                TreeNode *treenodes;
+                std::queue<int> edgeQueue;
+
                 newRipupNet(netID);
 
                 treeedges = sttrees[netID].edges;
@@ -1429,7 +1743,7 @@ void spiralRouteAll() {
                                 }
                         }
                 }
-        }
+        });
 
         for (netID = 0; netID < numValidNets; netID++) {
                 treenodes = sttrees[netID].nodes;
@@ -32,6 +32,8 @@
 #ifndef __ROUTE_H__
 #define __ROUTE_H__
 
+#include <functional>
+
 namespace FastRoute {
 
 #define SAMEX 0
@@ -51,5 +53,12 @@ extern void routeMonotonic(int netID, int edgeID, int threshold);
 extern void routeLVAll(int threshold, int expand);
 extern void spiralRouteAll();
 extern void newrouteLInMaze(int netID);
+extern void initCongestionIndex();
+extern void freeCongestionIndex();
+
+// bbox (x1, y1) - (x2, y2) in gcells of the edges read or written for an item
+typedef std::function<void(int, int *, int *, int *, int *)> WaveFootprint;
+extern int runInChunks(int numItems, int minItems, const std::function<void(int, int, int)> &fn);
+extern void runInWaves(int numItems, const WaveFootprint &footprint, const std::function<void(int, int)> &fn);
 }  // namespace FastRoute
 #endif /* __ROUTE_H__ */
@@ -31,15 +31,21 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <algorithm>
 #include <queue>
+#include <vector>
 #include "DataType.h"
 #include "flute.h"
 #include "DataProc.h"
+#include "route.h"
+#include "LayerDP.h"
 
 
 namespace FastRoute {
 
+#define MIN_NETS_PER_THREAD 256  // fewer nets are processed by the calling thread
+
 void printEdge(int netID, int edgeID) {
         int i;
         TreeEdge edge;
@@ -241,44 +247,52 @@ void ConvertToFull3DType2() {
         }
 }
 
-static int comparePVMINX(const void *a, const void *b) {
-        int ret = -2;
-        if (((OrderNetPin *)a)->minX > ((OrderNetPin *)b)->minX) {
-                ret = 1;
-        } else if (((OrderNetPin *)a)->minX == ((OrderNetPin *)b)->minX) {
-                ret = 0;
-        } else if (((OrderNetPin *)a)->minX < ((OrderNetPin *)b)->minX) {
-                ret = -1;
-        }
-        if (ret == -2) {
-                exit(1);
-        } else {
-                return ret;
-        }
+// the ties of the sort keys are broken by the index, qsort is not stable
+static int compareIndex(int a, int b) {
+        return (a > b) - (a < b);
 }
 
-static int comparePVPV(const void *a, const void *b) {
-        int ret = -2;
-        if (((OrderNetPin *)a)->npv > ((OrderNetPin *)b)->npv) {
-                ret = 1;
-        } else if (((OrderNetPin *)a)->npv == ((OrderNetPin *)b)->npv) {
-                ret = 0;
-        } else if (((OrderNetPin *)a)->npv < ((OrderNetPin *)b)->npv) {
-                ret = -1;
-        }
-        if (ret == -2) {
-                exit(1);
-        } else {
-                return ret;
+// Nets with their sort key, for sortByKey
+typedef struct
+{
+        unsigned long long key;
+        int index;
+} KeyedNet;
+
+// Stable LSD radix sort of the nets by key, 8 bits per pass; a pass is
+// skipped when all the keys have the same byte. The buffers are kept for the
+// next sort.
+static void sortByKey(std::vector<KeyedNet> &nets) {
+        static std::vector<KeyedNet> tmp;
+        int i, n, shift, digit, count[256];
+
+        n = nets.size();
+        tmp.resize(n);
+        for (shift = 0; shift < 64; shift += 8) {
+                std::fill(count, count + 256, 0);
+                for (i = 0; i < n; i++)
+                        count[(nets[i].key >> shift) & 255]++;
+                if (n == 0 || count[(nets[0].key >> shift) & 255] == n)
+                        continue;
+
+                for (digit = 0, i = 0; digit < 256; digit++) {
+                        i += count[digit];
+                        count[digit] = i - count[digit];
+                }
+                for (i = 0; i < n; i++)
+                        tmp[count[(nets[i].key >> shift) & 255]++] = nets[i];
+                nets.swap(tmp);
         }
 }
 
+// Orders the nets by increasing length over pins (npv), then minX, then net
+// index. The nets are scored in parallel and radix sorted on the float bits of
+// npv, which order like the floats as npv >= 0.
 void netpinOrderInc() {
-        int j, d, ind, totalLength, xmin;
-        TreeNode *treenodes;
-        StTree *stree;
-
-        float npvalue;
+        static int treeOrderPVSize = 0;
+        static std::vector<KeyedNet> order;
+        static std::vector<OrderNetPin> scored;
+        int j, d;
 
         numTreeedges = 0;
         for (j = 0; j < numValidNets; j++) {
@@ -286,34 +300,49 @@ void netpinOrderInc() {
                 numTreeedges += 2 * d - 3;
         }
 
-        if (treeOrderPV != NULL) {
+        if (treeOrderPV == NULL || treeOrderPVSize < numValidNets) {
                 free(treeOrderPV);
+                treeOrderPV = (OrderNetPin *)malloc(numValidNets * sizeof(OrderNetPin));
+                treeOrderPVSize = numValidNets;
         }
-
-        treeOrderPV = (OrderNetPin *)malloc(numValidNets * sizeof(OrderNetPin));
-
-        for (j = 0; j < numValidNets; j++) {
-                xmin = BIG_INT;
-                totalLength = 0;
-                treenodes = sttrees[j].nodes;
-                stree = &(sttrees[j]);
-                d = stree->deg;
-                for (ind = 0; ind < 2 * d - 3; ind++) {
-                        totalLength += stree->edges[ind].len;
-                        if (xmin < treenodes[stree->edges[ind].n1].x) {
-                                xmin = treenodes[stree->edges[ind].n1].x;
+        order.resize(numValidNets);
+
+        runInChunks(numValidNets, MIN_NETS_PER_THREAD, [](int lo, int hi, int) {
+                int j, d, ind, totalLength, xmin;
+                unsigned npvBits;
+                float npvalue;
+                TreeNode *treenodes;
+                StTree *stree;
+
+                for (j = lo; j < hi; j++) {
+                        xmin = BIG_INT;
+                        totalLength = 0;
+                        treenodes = sttrees[j].nodes;
+                        stree = &(sttrees[j]);
+                        d = stree->deg;
+                        for (ind = 0; ind < 2 * d - 3; ind++) {
+                                totalLength += stree->edges[ind].len;
+                                if (xmin < treenodes[stree->edges[ind].n1].x) {
+                                        xmin = treenodes[stree->edges[ind].n1].x;
+                                }
                         }
-                }
 
-                npvalue = (float)totalLength / d;
+                        npvalue = (float)totalLength / d;
 
-                treeOrderPV[j].npv = npvalue;
-                treeOrderPV[j].treeIndex = j;
-                treeOrderPV[j].minX = xmin;
-        }
+                        treeOrderPV[j].npv = npvalue;
+                        treeOrderPV[j].treeIndex = j;
+                        treeOrderPV[j].minX = xmin;
 
-        qsort(treeOrderPV, numValidNets, sizeof(OrderNetPin), comparePVMINX);
-        qsort(treeOrderPV, numValidNets, sizeof(OrderNetPin), comparePVPV);
+                        memcpy(&npvBits, &npvalue, sizeof(npvBits));
+                        order[j].key = ((unsigned long long)npvBits << 32) | ((unsigned)xmin ^ 0x80000000u);
+                        order[j].index = j;
+                }
+        });
+
+        sortByKey(order);
+        scored.assign(treeOrderPV, treeOrderPV + numValidNets);
+        for (j = 0; j < numValidNets; j++)
+                treeOrderPV[j] = scored[order[j].index];
 }
 
 void fillVIA() {
@@ -411,38 +440,9 @@ void fillVIA() {
         printf("via related stiner nodes %d\n", numVIAT2);
 }
 
-int threeDVIA() {
-        short *gridsL;
-        int netID, edgeID, deg;
-        int routeLen, numVIA, j;
-        TreeEdge *treeedges, *treeedge;
-
-        numVIA = 0;
-
-        for (netID = 0; netID < numValidNets; netID++) {
-                treeedges = sttrees[netID].edges;
-                deg = sttrees[netID].deg;
-
-                for (edgeID = 0; edgeID < 2 * deg - 3; edgeID++) {
-                        treeedge = &(treeedges[edgeID]);
-
-                        if (treeedge->len > 0) {
-                                routeLen = treeedge->route.routelen;
-                                gridsL = treeedge->route.gridsL;
-
-                                for (j = 0; j < routeLen; j++) {
-                                        if (gridsL[j] != gridsL[j + 1]) {
-                                                numVIA++;
-                                        }
-                                }
-                        }
-                }
-        }
-
-        return (numVIA);
-}
-
-void assignEdge(int netID, int edgeID, Bool processDIR) {
+// the DP arrays layerGrid, gridD and viaLink are the globals for a serial
+// layer assignment and a copy per thread for a parallel one
+static void assignEdge(int netID, int edgeID, Bool processDIR, int (*layerGrid)[MAXLAYER], int (*gridD)[MAXLAYER], int (*viaLink)[MAXLAYER]) {
         short *gridsX, *gridsY, *gridsL;
         int i, k, l, grid, min_x, min_y, routelen, n1a, n2a, last_layer;
         int min_result, endLayer;
@@ -461,33 +461,27 @@ void assignEdge(int netID, int edgeID, Bool processDIR) {
         n1a = treeedge->n1a;
         n2a = treeedge->n2a;
 
-        for (l = 0; l < numLayers; l++) {
-                for (k = 0; k <= routelen; k++) {
-                        gridD[l][k] = BIG_INT;
-                        viaLink[l][k] = BIG_INT;
+        for (k = 0; k <= routelen; k++) {
+                for (l = 0; l < numLayers; l++) {
+                        gridD[k][l] = BIG_INT;
+                        viaLink[k][l] = BIG_INT;
                 }
         }
 
         for (k = 0; k < routelen; k++) {
                 if (gridsX[k] == gridsX[k + 1]) {
                         min_y = std::min(gridsY[k], gridsY[k + 1]);
-                        for (l = 0; l < numLayers; l++) {
-                                grid = l * gridV + min_y * xGrid + gridsX[k];
-                                layerGrid[l][k] = v_edges3D[grid].cap - v_edges3D[grid].usage;
-                        }
+                        layerCapacity(&v_edges3D[min_y * xGrid + gridsX[k]], gridV, numLayers, layerGrid[k]);
                 } else {
                         min_x = std::min(gridsX[k], gridsX[k + 1]);
-                        for (l = 0; l < numLayers; l++) {
-                                grid = l * gridH + gridsY[k] * (xGrid - 1) + min_x;
-                                layerGrid[l][k] = h_edges3D[grid].cap - h_edges3D[grid].usage;
-                        }
+                        layerCapacity(&h_edges3D[gridsY[k] * (xGrid - 1) + min_x], gridH, numLayers, layerGrid[k]);
                 }
         }
 
         if (processDIR) {
                 if (treenodes[n1a].assigned) {
                         for (l = treenodes[n1a].botL; l <= treenodes[n1a].topL; l++) {
-                                gridD[l][0] = 0;
+                                gridD[0][l] = 0;
                         }
                 } else {
                         printf("warning, start point not assigned\n");
@@ -495,76 +489,51 @@ void assignEdge(int netID, int edgeID, Bool processDIR) {
                 }
 
                 for (k = 0; k < routelen; k++) {
+                        relaxVias(gridD[k], viaLink[k], numLayers, k == 0 ? 2 : 3);
                         for (l = 0; l < numLayers; l++) {
-                                for (i = 0; i < numLayers; i++) {
-                                        if (k == 0) {
-                                                if (l != i) {
-                                                        if (gridD[i][k] > gridD[l][k] + ADIFF(i, l) * 2) {
-                                                                gridD[i][k] = gridD[l][k] + ADIFF(i, l) * 2;
-                                                                viaLink[i][k] = l;
-                                                        }
-                                                }
-                                        } else {
-                                                if (l != i) {
-                                                        if (gridD[i][k] > gridD[l][k] + ADIFF(i, l) * 3) {
-                                                                gridD[i][k] = gridD[l][k] + ADIFF(i, l) * 3;
-                                                                viaLink[i][k] = l;
-                                                        }
-                                                }
-                                        }
-                                }
-                        }
-                        for (l = 0; l < numLayers; l++) {
-                                if (layerGrid[l][k] > 0) {
-                                        gridD[l][k + 1] = gridD[l][k] + 1;
+                                if (layerGrid[k][l] > 0) {
+                                        gridD[k + 1][l] = gridD[k][l] + 1;
                                 } else {
-                                        gridD[l][k + 1] = gridD[l][k] + BIG_INT;
+                                        gridD[k + 1][l] = gridD[k][l] + BIG_INT;
                                 }
                         }
                 }
 
-                for (l = 0; l < numLayers; l++) {
-                        for (i = 0; i < numLayers; i++) {
-                                if (l != i) {
-                                        if (gridD[i][k] > gridD[l][k] + ADIFF(i, l) * 1) {    //+ ADIFF(i,l) * 3 ) {
-                                                gridD[i][k] = gridD[l][k] + ADIFF(i, l) * 1;  //+ ADIFF(i,l) * 3 ;
-                                                viaLink[i][k] = l;
-                                        }
-                                }
-                        }
-                }
+                relaxVias(gridD[k], viaLink[k], numLayers, 1);
 
                 k = routelen;
 
                 if (treenodes[n2a].assigned) {
+                        // every layer can be blocked when the 2D route still has overflow
                         min_result = BIG_INT;
+                        endLayer = treenodes[n2a].topL;
                         for (i = treenodes[n2a].topL; i >= treenodes[n2a].botL; i--) {
-                                if (gridD[i][routelen] < min_result) {
-                                        min_result = gridD[i][routelen];
+                                if (gridD[routelen][i] < min_result) {
+                                        min_result = gridD[routelen][i];
                                         endLayer = i;
                                 }
                         }
                 } else {
-                        min_result = gridD[0][routelen];
+                        min_result = gridD[routelen][0];
                         endLayer = 0;
                         for (i = 0; i < numLayers; i++) {
-                                if (gridD[i][routelen] < min_result) {
-                                        min_result = gridD[i][routelen];
+                                if (gridD[routelen][i] < min_result) {
+                                        min_result = gridD[routelen][i];
                                         endLayer = i;
                                 }
                         }
                 }
 
-                if (viaLink[endLayer][routelen] == BIG_INT) {
+                if (viaLink[routelen][endLayer] == BIG_INT) {
                         last_layer = endLayer;
                 } else {
-                        last_layer = viaLink[endLayer][routelen];
+                        last_layer = viaLink[routelen][endLayer];
                 }
 
                 for (k = routelen; k >= 0; k--) {
                         gridsL[k] = last_layer;
-                        if (viaLink[last_layer][k] != BIG_INT) {
-                                last_layer = viaLink[last_layer][k];
+                        if (viaLink[k][last_layer] != BIG_INT) {
+                                last_layer = viaLink[k][last_layer];
                         }
                 }
 
@@ -603,65 +572,40 @@ void assignEdge(int netID, int edgeID, Bool processDIR) {
         } else {
                 if (treenodes[n2a].assigned) {
                         for (l = treenodes[n2a].botL; l <= treenodes[n2a].topL; l++) {
-                                gridD[l][routelen] = 0;
+                                gridD[routelen][l] = 0;
                         }
                 }
 
                 for (k = routelen; k > 0; k--) {
+                        relaxVias(gridD[k], viaLink[k], numLayers, k == routelen ? 2 : 3);
                         for (l = 0; l < numLayers; l++) {
-                                for (i = 0; i < numLayers; i++) {
-                                        if (k == routelen) {
-                                                if (l != i) {
-                                                        if (gridD[i][k] > gridD[l][k] + ADIFF(i, l) * 2) {
-                                                                gridD[i][k] = gridD[l][k] + ADIFF(i, l) * 2;
-                                                                viaLink[i][k] = l;
-                                                        }
-                                                }
-                                        } else {
-                                                if (l != i) {
-                                                        if (gridD[i][k] > gridD[l][k] + ADIFF(i, l) * 3) {
-                                                                gridD[i][k] = gridD[l][k] + ADIFF(i, l) * 3;
-                                                                viaLink[i][k] = l;
-                                                        }
-                                                }
-                                        }
-                                }
-                        }
-                        for (l = 0; l < numLayers; l++) {
-                                if (layerGrid[l][k - 1] > 0) {
-                                        gridD[l][k - 1] = gridD[l][k] + 1;
+                                if (layerGrid[k - 1][l] > 0) {
+                                        gridD[k - 1][l] = gridD[k][l] + 1;
                                 } else {
-                                        gridD[l][k - 1] = gridD[l][k] + BIG_INT;
+                                        gridD[k - 1][l] = gridD[k][l] + BIG_INT;
                                 }
                         }
                 }
 
-                for (l = 0; l < numLayers; l++) {
-                        for (i = 0; i < numLayers; i++) {
-                                if (l != i) {
-                                        if (gridD[i][0] > gridD[l][0] + ADIFF(i, l) * 1) {
-                                                gridD[i][0] = gridD[l][0] + ADIFF(i, l) * 1;
-                                                viaLink[i][0] = l;
-                                        }
-                                }
-                        }
-                }
+                relaxVias(gridD[0], viaLink[0], numLayers, 1);
 
                 if (treenodes[n1a].assigned) {
+                        // every layer can be blocked when the 2D route still has overflow
                         min_result = BIG_INT;
+                        endLayer = treenodes[n1a].topL;
                         for (i = treenodes[n1a].topL; i >= treenodes[n1a].botL; i--) {
-                                if (gridD[i][k] < min_result) {
-                                        min_result = gridD[i][0];
+                                if (gridD[k][i] < min_result) {
+                                        min_result = gridD[0][i];
                                         endLayer = i;
                                 }
                         }
 
                 } else {
-                        min_result = gridD[0][k];
+                        min_result = gridD[k][0];
                         endLayer = 0;
                         for (i = 0; i < numLayers; i++) {
-                                if (gridD[i][k] < min_result) {
-                                        min_result = gridD[i][k];
+                                if (gridD[k][i] < min_result) {
+                                        min_result = gridD[k][i];
                                         endLayer = i;
                                 }
                         }
@@ -670,8 +614,8 @@ void assignEdge(int netID, int edgeID, Bool processDIR) {
                 last_layer = endLayer;
 
                 for (k = 0; k <= routelen; k++) {
-                        if (viaLink[last_layer][k] != BIG_INT) {
-                                last_layer = viaLink[last_layer][k];
+                        if (viaLink[k][last_layer] != BIG_INT) {
+                                last_layer = viaLink[k][last_layer];
                         }
                         gridsL[k] = last_layer;
                 }
@@ -731,9 +675,11 @@ void assignEdge(int netID, int edgeID, Bool processDIR) {
         }
 }
 
-void newLayerAssignmentV4() {
+// Layer assignment of the tree edges of a net, from its pins outwards. dp holds
+// the layerGrid, gridD and viaLink arrays used by assignEdge.
+static void assignNetLayers(int netID, int (*dp[3])[MAXLAYER]) {
         short *gridsL;
-        int i, k, netID, edgeID, nodeID, routeLen;
+        int k, edgeID, nodeID, routeLen;
         int n1, n2, connectionCNT, deg;
 
         int n1a, n2a;
@@ -742,139 +688,209 @@ void newLayerAssignmentV4() {
         TreeEdge *treeedges, *treeedge;
         TreeNode *treenodes;
 
-        for (netID = 0; netID < numValidNets; netID++) {
-                treeedges = sttrees[netID].edges;
-                treenodes = sttrees[netID].nodes;
-                deg = sttrees[netID].deg;
-                for (edgeID = 0; edgeID < 2 * deg - 3; edgeID++) {
-                        treeedge = &(treeedges[edgeID]);
-                        if (treeedge->len > 0) {
-                                routeLen = treeedge->route.routelen;
-                                treeedge->route.gridsL = (short *)calloc((routeLen + 1), sizeof(short));
-                                treeedge->assigned = FALSE;
+        treeedges = sttrees[netID].edges;
+        treenodes = sttrees[netID].nodes;
+        deg = sttrees[netID].deg;
+
+        for (nodeID = 0; nodeID < deg; nodeID++) {
+                for (k = 0; k < treenodes[nodeID].conCNT; k++) {
+                        edgeID = treenodes[nodeID].eID[k];
+                        if (!treeedges[edgeID].assigned) {
+                                edgeQueue.push(edgeID);
+                                treeedges[edgeID].assigned = TRUE;
                         }
                 }
         }
-        netpinOrderInc();
 
-        for (i = 0; i < numValidNets; i++) {
-                netID = treeOrderPV[i].treeIndex;
-                treeedges = sttrees[netID].edges;
-                treenodes = sttrees[netID].nodes;
-                deg = sttrees[netID].deg;
-
-                for (nodeID = 0; nodeID < deg; nodeID++) {
-                        for (k = 0; k < treenodes[nodeID].conCNT; k++) {
-                                edgeID = treenodes[nodeID].eID[k];
-                                if (!treeedges[edgeID].assigned) {
-                                        edgeQueue.push(edgeID);
-                                        treeedges[edgeID].assigned = TRUE;
-                                }
-                        }
-                }
-
-                while (!edgeQueue.empty()) {
-                        edgeID = edgeQueue.front();
-                        edgeQueue.pop();
-                        treeedge = &(treeedges[edgeID]);
-                        if (treenodes[treeedge->n1a].assigned) {
-                                assignEdge(netID, edgeID, 1);
-                                treeedge->assigned = TRUE;
-                                if (!treenodes[treeedge->n2a].assigned) {
-                                        for (k = 0; k < treenodes[treeedge->n2a].conCNT; k++) {
-                                                edgeID = treenodes[treeedge->n2a].eID[k];
-                                                if (!treeedges[edgeID].assigned) {
-                                                        edgeQueue.push(edgeID);
-                                                        treeedges[edgeID].assigned = TRUE;
-                                                }
+        while (!edgeQueue.empty()) {
+                edgeID = edgeQueue.front();
+                edgeQueue.pop();
+                treeedge = &(treeedges[edgeID]);
+                if (treenodes[treeedge->n1a].assigned) {
+                        assignEdge(netID, edgeID, 1, dp[0], dp[1], dp[2]);
+                        treeedge->assigned = TRUE;
+                        if (!treenodes[treeedge->n2a].assigned) {
+                                for (k = 0; k < treenodes[treeedge->n2a].conCNT; k++) {
+                                        edgeID = treenodes[treeedge->n2a].eID[k];
+                                        if (!treeedges[edgeID].assigned) {
+                                                edgeQueue.push(edgeID);
+                                                treeedges[edgeID].assigned = TRUE;
                                         }
-                                        treenodes[treeedge->n2a].assigned = TRUE;
                                 }
-                        } else {
-                                assignEdge(netID, edgeID, 0);
-                                treeedge->assigned = TRUE;
-                                if (!treenodes[treeedge->n1a].assigned) {
-                                        for (k = 0; k < treenodes[treeedge->n1a].conCNT; k++) {
-                                                edgeID = treenodes[treeedge->n1a].eID[k];
-                                                if (!treeedges[edgeID].assigned) {
-                                                        edgeQueue.push(edgeID);
-                                                        treeedges[edgeID].assigned = TRUE;
-                                                }
+                                treenodes[treeedge->n2a].assigned = TRUE;
+                        }
+                } else {
+                        assignEdge(netID, edgeID, 0, dp[0], dp[1], dp[2]);
+                        treeedge->assigned = TRUE;
+                        if (!treenodes[treeedge->n1a].assigned) {
+                                for (k = 0; k < treenodes[treeedge->n1a].conCNT; k++) {
+                                        edgeID = treenodes[treeedge->n1a].eID[k];
+                                        if (!treeedges[edgeID].assigned) {
+                                                edgeQueue.push(edgeID);
+                                                treeedges[edgeID].assigned = TRUE;
                                         }
-                                        treenodes[treeedge->n1a].assigned = TRUE;
                                 }
+                                treenodes[treeedge->n1a].assigned = TRUE;
                         }
                 }
+        }
 
-                deg = sttrees[netID].deg;
+        deg = sttrees[netID].deg;
+
+        for (nodeID = 0; nodeID < 2 * deg - 2; nodeID++) {
+                treenodes[nodeID].topL = -1;
+                treenodes[nodeID].botL = numLayers;
+                treenodes[nodeID].conCNT = 0;
+                treenodes[nodeID].hID = BIG_INT;
+                treenodes[nodeID].lID = BIG_INT;
+                treenodes[nodeID].status = 0;
+                treenodes[nodeID].assigned = FALSE;
+
+                if (nodeID < deg) {
+                        treenodes[nodeID].botL = 0;
+                        treenodes[nodeID].assigned = TRUE;
+                        treenodes[nodeID].status = 1;
+                }
+        }
 
-                for (nodeID = 0; nodeID < 2 * deg - 2; nodeID++) {
-                        treenodes[nodeID].topL = -1;
-                        treenodes[nodeID].botL = numLayers;
-                        treenodes[nodeID].conCNT = 0;
-                        treenodes[nodeID].hID = BIG_INT;
-                        treenodes[nodeID].lID = BIG_INT;
-                        treenodes[nodeID].status = 0;
-                        treenodes[nodeID].assigned = FALSE;
+        for (edgeID = 0; edgeID < 2 * deg - 3; edgeID++) {
+                treeedge = &(treeedges[edgeID]);
 
-                        if (nodeID < deg) {
-                                treenodes[nodeID].botL = 0;
-                                treenodes[nodeID].assigned = TRUE;
-                                treenodes[nodeID].status = 1;
+                if (treeedge->len > 0) {
+                        routeLen = treeedge->route.routelen;
+
+                        n1 = treeedge->n1;
+                        n2 = treeedge->n2;
+                        gridsL = treeedge->route.gridsL;
+
+                        n1a = treenodes[n1].stackAlias;
+                        n2a = treenodes[n2].stackAlias;
+                        connectionCNT = treenodes[n1a].conCNT;
+                        treenodes[n1a].heights[connectionCNT] = gridsL[0];
+                        treenodes[n1a].eID[connectionCNT] = edgeID;
+                        treenodes[n1a].conCNT++;
+
+                        if (gridsL[0] > treenodes[n1a].topL) {
+                                treenodes[n1a].hID = edgeID;
+                                treenodes[n1a].topL = gridsL[0];
+                        }
+                        if (gridsL[0] < treenodes[n1a].botL) {
+                                treenodes[n1a].lID = edgeID;
+                                treenodes[n1a].botL = gridsL[0];
                         }
-                }
 
-                for (edgeID = 0; edgeID < 2 * deg - 3; edgeID++) {
-                        treeedge = &(treeedges[edgeID]);
+                        treenodes[n1a].assigned = TRUE;
 
-                        if (treeedge->len > 0) {
-                                routeLen = treeedge->route.routelen;
+                        connectionCNT = treenodes[n2a].conCNT;
+                        treenodes[n2a].heights[connectionCNT] = gridsL[routeLen];
+                        treenodes[n2a].eID[connectionCNT] = edgeID;
+                        treenodes[n2a].conCNT++;
+                        if (gridsL[routeLen] > treenodes[n2a].topL) {
+                                treenodes[n2a].hID = edgeID;
+                                treenodes[n2a].topL = gridsL[routeLen];
+                        }
+                        if (gridsL[routeLen] < treenodes[n2a].botL) {
+                                treenodes[n2a].lID = edgeID;
+                                treenodes[n2a].botL = gridsL[routeLen];
+                        }
 
-                                n1 = treeedge->n1;
-                                n2 = treeedge->n2;
-                                gridsL = treeedge->route.gridsL;
+                        treenodes[n2a].assigned = TRUE;
 
-                                n1a = treenodes[n1].stackAlias;
-                                n2a = treenodes[n2].stackAlias;
-                                connectionCNT = treenodes[n1a].conCNT;
-                                treenodes[n1a].heights[connectionCNT] = gridsL[0];
-                                treenodes[n1a].eID[connectionCNT] = edgeID;
-                                treenodes[n1a].conCNT++;
+                }  //edge len > 0
+        }          // eunmerating edges
+}
 
-                                if (gridsL[0] > treenodes[n1a].topL) {
-                                        treenodes[n1a].hID = edgeID;
-                                        treenodes[n1a].topL = gridsL[0];
-                                }
-                                if (gridsL[0] < treenodes[n1a].botL) {
-                                        treenodes[n1a].lID = edgeID;
-                                        treenodes[n1a].botL = gridsL[0];
-                                }
+// bbox of the maze routes of a net: the 3D edges read and written by its layer assignment
+static void routeFootprint(int netID, int *x1, int *y1, int *x2, int *y2) {
+        int edgeID, k;
+        TreeEdge *treeedge;
 
-                                treenodes[n1a].assigned = TRUE;
+        *x1 = *x2 = sttrees[netID].nodes[0].x;
+        *y1 = *y2 = sttrees[netID].nodes[0].y;
+        for (edgeID = 0; edgeID < 2 * sttrees[netID].deg - 3; edgeID++) {
+                treeedge = &(sttrees[netID].edges[edgeID]);
+                if (treeedge->len > 0) {
+                        for (k = 0; k <= treeedge->route.routelen; k++) {
+                                *x1 = std::min(*x1, (int)treeedge->route.gridsX[k]);
+                                *x2 = std::max(*x2, (int)treeedge->route.gridsX[k]);
+                                *y1 = std::min(*y1, (int)treeedge->route.gridsY[k]);
+                                *y2 = std::max(*y2, (int)treeedge->route.gridsY[k]);
+                        }
+                }
+        }
+}
 
-                                connectionCNT = treenodes[n2a].conCNT;
-                                treenodes[n2a].heights[connectionCNT] = gridsL[routeLen];
-                                treenodes[n2a].eID[connectionCNT] = edgeID;
-                                treenodes[n2a].conCNT++;
-                                if (gridsL[routeLen] > treenodes[n2a].topL) {
-                                        treenodes[n2a].hID = edgeID;
-                                        treenodes[n2a].topL = gridsL[routeLen];
-                                }
-                                if (gridsL[routeLen] < treenodes[n2a].botL) {
-                                        treenodes[n2a].lID = edgeID;
-                                        treenodes[n2a].botL = gridsL[routeLen];
-                                }
+// The nets are assigned in treeOrderPV order. With numThreads > 1, nets whose
+// routes are in disjoint regions are assigned in parallel (see runInWaves),
+// each thread with its own DP arrays; the 3D usage of a region is only updated
+// by the thread assigning the net there, so the result is the same as the
+// serial one.
+void newLayerAssignmentV4() {
+        int i, netID, edgeID, deg, routeLen;
+        TreeEdge *treeedges, *treeedge;
 
-                                treenodes[n2a].assigned = TRUE;
+        for (netID = 0; netID < numValidNets; netID++) {
+                treeedges = sttrees[netID].edges;
+                deg = sttrees[netID].deg;
+                for (edgeID = 0; edgeID < 2 * deg - 3; edgeID++) {
+                        treeedge = &(treeedges[edgeID]);
+                        if (treeedge->len > 0) {
+                                routeLen = treeedge->route.routelen;
+                                treeedge->route.gridsL = (short *)calloc((routeLen + 1), sizeof(short));
+                                treeedge->assigned = FALSE;
+                        }
+                }
+        }
+        netpinOrderInc();
 
-                        }  //edge len > 0
-                }          // eunmerating edges
+        std::vector<int(*)[MAXLAYER]> scratch(3 * std::max(numThreads, 1));
+        scratch[0] = layerGrid;
+        scratch[1] = gridD;
+        scratch[2] = viaLink;
+        for (i = 3; i < (int)scratch.size(); i++)
+                scratch[i] = (int(*)[MAXLAYER])malloc(MAXLEN * MAXLAYER * sizeof(int));
+
+        runInWaves(numValidNets,
+                   [](int i, int *x1, int *y1, int *x2, int *y2) {
+                           routeFootprint(treeOrderPV[i].treeIndex, x1, y1, x2, y2);
+                   },
+                   [&scratch](int i, int worker) {
+                           assignNetLayers(treeOrderPV[i].treeIndex, &scratch[3 * worker]);
+                   });
+
+        for (i = 3; i < (int)scratch.size(); i++)
+                free(scratch[i]);
+}
+
+// stackAlias of the 2*deg-2 tree nodes: a Steiner node on the same gcell as a
+// pin or another Steiner node is an alias of the smallest such node
+void setStackAlias(TreeNode *treenodes, int deg) {
+        int i, j, numnodes;
+
+        numnodes = 2 * deg - 2;
+        std::vector<int> order(numnodes);
+        for (i = 0; i < numnodes; i++)
+                order[i] = i;
+        std::sort(order.begin(), order.end(), [treenodes](int a, int b) {
+                if (treenodes[a].x != treenodes[b].x)
+                        return treenodes[a].x < treenodes[b].x;
+                if (treenodes[a].y != treenodes[b].y)
+                        return treenodes[a].y < treenodes[b].y;
+                return a < b;
+        });
+
+        for (i = 0; i < numnodes; i = j) {
+                for (j = i + 1; j < numnodes; j++) {
+                        if (treenodes[order[j]].x != treenodes[order[i]].x || treenodes[order[j]].y != treenodes[order[i]].y)
+                                break;
+                        if (order[j] >= deg)
+                                treenodes[order[j]].stackAlias = order[i];
+                }
         }
 }
 
 void newLA() {
-        int netID, d, k, edgeID, deg, numpoints, n1, n2;
-        Bool redundant;
+        int netID, d, edgeID, deg, n1, n2;
         TreeEdge *treeedges, *treeedge;
         TreeNode *treenodes;
 
@@ -883,8 +899,6 @@ void newLA() {
                 treenodes = sttrees[netID].nodes;
                 deg = sttrees[netID].deg;
 
-                numpoints = 0;
-
                 for (d = 0; d < 2 * deg - 2; d++) {
                         treenodes[d].topL = -1;
                         treenodes[d].botL = numLayers;
@@ -901,29 +915,9 @@ void newLA() {
                                 //treenodes[d].l = 0;
                                 treenodes[d].assigned = TRUE;
                                 treenodes[d].status = 1;
-
-                                xcor[numpoints] = treenodes[d].x;
-                                ycor[numpoints] = treenodes[d].y;
-                                dcor[numpoints] = d;
-                                numpoints++;
-                        } else {
-                                redundant = FALSE;
-                                for (k = 0; k < numpoints; k++) {
-                                        if ((treenodes[d].x == xcor[k]) && (treenodes[d].y == ycor[k])) {
-                                                treenodes[d].stackAlias = dcor[k];
-
-                                                redundant = TRUE;
-                                                break;
-                                        }
-                                }
-                                if (!redundant) {
-                                        xcor[numpoints] = treenodes[d].x;
-                                        ycor[numpoints] = treenodes[d].y;
-                                        dcor[numpoints] = d;
-                                        numpoints++;
-                                }
                         }
                 }
+                setStackAlias(treenodes, deg);
         }
 
         for (netID = 0; netID < numValidNets; netID++) {
@@ -1052,6 +1046,75 @@ void checkRoute3D() {
         }
 }
 
+// Counts of the final 3D routes, over chunks of nets checked in parallel; the
+// routes are only read. VERIFY_FAST counts the vias, VERIFY_FULL also counts
+// the defects that checkRoute3D prints: floating pins, routes that do not
+// join the nodes of their tree edge, steps that skip grid points and negative
+// layers.
+void checkRoutes3D(VerifyLevel level, RouteCheck *check) {
+        int c, numChunks;
+        std::vector<RouteCheck> parts(std::max(1, numThreads));
+
+        numChunks = runInChunks(numValidNets, MIN_NETS_PER_THREAD, [&](int lo, int hi, int chunk) {
+                short *gridsX, *gridsY, *gridsL;
+                int i, netID, edgeID, nodeID, routeLen, deg, distance;
+                TreeEdge *treeedge;
+                TreeNode *treenodes;
+                RouteCheck *part = &parts[chunk];
+
+                part->numVia = part->floatPins = part->badEnds = part->badSteps = part->badLayers = 0;
+                for (netID = lo; netID < hi; netID++) {
+                        treenodes = sttrees[netID].nodes;
+                        deg = sttrees[netID].deg;
+
+                        if (level == VERIFY_FULL) {
+                                for (nodeID = 0; nodeID < deg; nodeID++) {
+                                        if (treenodes[nodeID].botL != 0)
+                                                part->floatPins++;
+                                }
+                        }
+                        for (edgeID = 0; edgeID < 2 * deg - 3; edgeID++) {
+                                treeedge = &(sttrees[netID].edges[edgeID]);
+                                if (treeedge->len == 0)
+                                        continue;
+                                routeLen = treeedge->route.routelen;
+                                gridsX = treeedge->route.gridsX;
+                                gridsY = treeedge->route.gridsY;
+                                gridsL = treeedge->route.gridsL;
+
+                                for (i = 0; i < routeLen; i++) {
+                                        if (gridsL[i] != gridsL[i + 1])
+                                                part->numVia++;
+                                }
+                                if (level != VERIFY_FULL)
+                                        continue;
+
+                                if (gridsX[0] != treenodes[treeedge->n1].x || gridsY[0] != treenodes[treeedge->n1].y ||
+                                    gridsX[routeLen] != treenodes[treeedge->n2].x || gridsY[routeLen] != treenodes[treeedge->n2].y)
+                                        part->badEnds++;
+                                for (i = 0; i < routeLen; i++) {
+                                        distance = ADIFF(gridsX[i + 1], gridsX[i]) + ADIFF(gridsY[i + 1], gridsY[i]) + ADIFF(gridsL[i + 1], gridsL[i]);
+                                        if (distance > 1 || distance < 0)
+                                                part->badSteps++;
+                                }
+                                for (i = 0; i <= routeLen; i++) {
+                                        if (gridsL[i] < 0)
+                                                part->badLayers++;
+                                }
+                        }
+                }
+        });
+
+        check->numVia = check->floatPins = check->badEnds = check->badSteps = check->badLayers = 0;
+        for (c = 0; c < numChunks; c++) {
+                check->numVia += parts[c].numVia;
+                check->floatPins += parts[c].floatPins;
+                check->badEnds += parts[c].badEnds;
+                check->badSteps += parts[c].badSteps;
+                check->badLayers += parts[c].badLayers;
+        }
+}
+
 void write3D() {
         short *gridsX, *gridsY, *gridsL;
         int netID, i, edgeID, deg, lastX, lastY, lastL, xreal, yreal, routeLen;
@@ -1097,65 +1160,66 @@ void write3D() {
         fclose(fp);
 }
 
-static int compareTEL(const void *a, const void *b) {
-        int ret = -2;
-        if (((OrderTree *)a)->xmin < ((OrderTree *)b)->xmin) {
-                ret = 1;
-        } else if (((OrderTree *)a)->xmin == ((OrderTree *)b)->xmin) {
-                ret = 0;
-        } else if (((OrderTree *)a)->xmin > ((OrderTree *)b)->xmin) {
-                ret = -1;
-        }
-        if (ret == -2) {
-                exit(1);
-        } else {
-                return ret;
-        }
-}
-
+// Orders the nets by decreasing overflow along their routes (kept in xmin),
+// then net index. The nets are scored in parallel and radix sorted.
 void StNetOrder() {
-        short *gridsX, *gridsY;
-        int i, j, d, ind, grid, min_x, min_y;
-        TreeEdge *treeedges, *treeedge;
-        StTree *stree;
+        static int treeOrderCongSize = 0;
+        static std::vector<KeyedNet> order;
+        static std::vector<OrderTree> scored;
+        int j;
 
         numTreeedges = 0;
 
-        if (treeOrderCong != NULL) {
+        if (treeOrderCong == NULL || treeOrderCongSize < numValidNets) {
                 free(treeOrderCong);
+                treeOrderCong = (OrderTree *)malloc(numValidNets * sizeof(OrderTree));
+                treeOrderCongSize = numValidNets;
         }
+        order.resize(numValidNets);
+
+        runInChunks(numValidNets, MIN_NETS_PER_THREAD, [](int lo, int hi, int) {
+                short *gridsX, *gridsY;
+                int i, j, d, ind, grid, min_x, min_y, overflow;
+                TreeEdge *treeedges, *treeedge;
+                StTree *stree;
+
+                for (j = lo; j < hi; j++) {
+                        stree = &(sttrees[j]);
+                        d = stree->deg;
+                        overflow = 0;
+                        for (ind = 0; ind < 2 * d - 3; ind++) {
+                                treeedges = stree->edges;
+                                treeedge = &(treeedges[ind]);
 
-        treeOrderCong = (OrderTree *)malloc(numValidNets * sizeof(OrderTree));
-
-        i = 0;
-        for (j = 0; j < numValidNets; j++) {
-                stree = &(sttrees[j]);
-                d = stree->deg;
-                treeOrderCong[j].xmin = 0;
-                treeOrderCong[j].treeIndex = j;
-                for (ind = 0; ind < 2 * d - 3; ind++) {
-                        treeedges = stree->edges;
-                        treeedge = &(treeedges[ind]);
-
-                        gridsX = treeedge->route.gridsX;
-                        gridsY = treeedge->route.gridsY;
-                        for (i = 0; i <= treeedge->route.routelen; i++) {
-                                if (gridsX[i] == gridsX[i + 1])  // a vertical edge
-                                {
-                                        min_y = std::min(gridsY[i], gridsY[i + 1]);
-                                        grid = min_y * xGrid + gridsX[i];
-                                        treeOrderCong[j].xmin += std::max(0, v_edges[grid].usage - v_edges[grid].cap);
-                                } else  ///if(gridsY[i]==gridsY[i+1])// a horizontal edge
-                                {
-                                        min_x = std::min(gridsX[i], gridsX[i + 1]);
-                                        grid = gridsY[i] * (xGrid - 1) + min_x;
-                                        treeOrderCong[j].xmin += std::max(0, h_edges[grid].usage - h_edges[grid].cap);
+                                gridsX = treeedge->route.gridsX;
+                                gridsY = treeedge->route.gridsY;
+                                for (i = 0; i < treeedge->route.routelen; i++) {
+                                        if (gridsX[i] == gridsX[i + 1])  // a vertical edge
+                                        {
+                                                min_y = std::min(gridsY[i], gridsY[i + 1]);
+                                                grid = min_y * xGrid + gridsX[i];
+                                                overflow += std::max(0, v_edges[grid].usage - v_edges[grid].cap);
+                                        } else  ///if(gridsY[i]==gridsY[i+1])// a horizontal edge
+                                        {
+                                                min_x = std::min(gridsX[i], gridsX[i + 1]);
+                                                grid = gridsY[i] * (xGrid - 1) + min_x;
+                                                overflow += std::max(0, h_edges[grid].usage - h_edges[grid].cap);
+                                        }
                                 }
                         }
+                        treeOrderCong[j].xmin = overflow;
+                        treeOrderCong[j].treeIndex = j;
+
+                        // decreasing overflow
+                        order[j].key = ~(unsigned)overflow;
+                        order[j].index = j;
                 }
-        }
+        });
 
-        qsort(treeOrderCong, numValidNets, sizeof(OrderTree), compareTEL);
+        sortByKey(order);
+        scored.assign(treeOrderCong, treeOrderCong + numValidNets);
+        for (j = 0; j < numValidNets; j++)
+                treeOrderCong[j] = scored[order[j].index];
 }
 
 void recoverEdge(int netID, int edgeID) {
@@ -1232,52 +1296,54 @@ void recoverEdge(int netID, int edgeID) {
         }
 }
 
+// removes the loops of the 2D routes; every net only changes its own routes,
+// so chunks of nets are processed in parallel
 void checkUsage() {
-        short *gridsX, *gridsY;
-        int netID, i, k, edgeID, deg;
-        int j, cnt;
-        Bool redsus;
-        TreeEdge *treeedges, *treeedge;
-        TreeEdge edge;
-
-        for (netID = 0; netID < numValidNets; netID++) {
-                treeedges = sttrees[netID].edges;
-                deg = sttrees[netID].deg;
-
-                for (edgeID = 0; edgeID < 2 * deg - 3; edgeID++) {
-                        edge = sttrees[netID].edges[edgeID];
-                        treeedge = &(treeedges[edgeID]);
-                        if (treeedge->len > 0) {
-                                gridsX = treeedge->route.gridsX;
-                                gridsY = treeedge->route.gridsY;
-
-                                redsus = TRUE;
-
-                                while (redsus) {
-                                        redsus = FALSE;
-
-                                        for (i = 0; i <= treeedge->route.routelen; i++) {
-                                                for (j = 0; j < i; j++) {
-                                                        if (gridsX[i] == gridsX[j] && gridsY[i] == gridsY[j])  // a vertical edge
-                                                        {
-                                                                cnt = 1;
-                                                                for (k = i + 1; k <= treeedge->route.routelen; k++) {
-                                                                        gridsX[j + cnt] = gridsX[k];
-                                                                        gridsY[j + cnt] = gridsY[k];
-                                                                        cnt++;
+        runInChunks(numValidNets, MIN_NETS_PER_THREAD, [](int lo, int hi, int) {
+                short *gridsX, *gridsY;
+                int netID, i, k, edgeID, deg;
+                int j, cnt;
+                Bool redsus;
+                TreeEdge *treeedges, *treeedge;
+
+                for (netID = lo; netID < hi; netID++) {
+                        treeedges = sttrees[netID].edges;
+                        deg = sttrees[netID].deg;
+
+                        for (edgeID = 0; edgeID < 2 * deg - 3; edgeID++) {
+                                treeedge = &(treeedges[edgeID]);
+                                if (treeedge->len > 0) {
+                                        gridsX = treeedge->route.gridsX;
+                                        gridsY = treeedge->route.gridsY;
+
+                                        redsus = TRUE;
+
+                                        while (redsus) {
+                                                redsus = FALSE;
+
+                                                for (i = 0; i <= treeedge->route.routelen; i++) {
+                                                        for (j = 0; j < i; j++) {
+                                                                if (gridsX[i] == gridsX[j] && gridsY[i] == gridsY[j])  // a vertical edge
+                                                                {
+                                                                        cnt = 1;
+                                                                        for (k = i + 1; k <= treeedge->route.routelen; k++) {
+                                                                                gridsX[j + cnt] = gridsX[k];
+                                                                                gridsY[j + cnt] = gridsY[k];
+                                                                                cnt++;
+                                                                        }
+                                                                        treeedge->route.routelen -= i - j;
+                                                                        redsus = TRUE;
+                                                                        i = 0;
+                                                                        j = 0;
+                                                                        printf("redundant edge component discovered\n");
                                                                 }
-                                                                treeedge->route.routelen -= i - j;
-                                                                redsus = TRUE;
-                                                                i = 0;
-                                                                j = 0;
-                                                                printf("redundant edge component discovered\n");
                                                         }
                                                 }
                                         }
                                 }
                         }
                 }
-        }
+        });
 
         printf("usage checked\n");
 }
@@ -1287,7 +1353,7 @@ static int compareEdgeLen(const void *a, const void *b) {
         if (((OrderNetEdge *)a)->length < ((OrderNetEdge *)b)->length) {
                 ret = 1;
         } else if (((OrderNetEdge *)a)->length == ((OrderNetEdge *)b)->length) {
-                ret = 0;
+                ret = compareIndex(((OrderNetEdge *)a)->edgeID, ((OrderNetEdge *)b)->edgeID);
         } else if (((OrderNetEdge *)a)->length > ((OrderNetEdge *)b)->length) {
                 ret = -1;
         }
@@ -1478,131 +1544,128 @@ struct wire {
         int netID;
 };
 
-// Copy Routing Solution for the best routing solution so far
-void copyRS(void) {
-        int i, j, netID, edgeID, numEdges, numNodes;
-
-        if (sttreesBK != NULL) {
-                for (netID = 0; netID < numValidNets; netID++) {
-                        numEdges = 2 * sttreesBK[netID].deg - 3;
-                        for (edgeID = 0; edgeID < numEdges; edgeID++) {
-                                if (sttreesBK[netID].edges[edgeID].len > 0) {
-                                        free(sttreesBK[netID].edges[edgeID].route.gridsX);
-                                        free(sttreesBK[netID].edges[edgeID].route.gridsY);
-                                }
-                        }
-                        free(sttreesBK[netID].nodes);
-                        free(sttreesBK[netID].edges);
+// The best routing solution so far is kept as a journal: copyRS marks the
+// current solution as the best one, and from then on saveTreeBK saves the tree
+// of a net in sttreesBK before its first reroute. copyBR puts the saved trees
+// back, so both cost O(rerouted nets) instead of a copy of every tree.
+
+// copy of the nodes and edges of a tree with the fields copyBR restores
+static void copyTree(StTree *dst, StTree *src) {
+        int i, j, edgeID, numEdges, numNodes;
+
+        numNodes = 2 * src->deg - 2;
+        numEdges = 2 * src->deg - 3;
+        dst->deg = src->deg;
+
+        dst->nodes = (TreeNode *)malloc(numNodes * sizeof(TreeNode));
+        for (i = 0; i < numNodes; i++) {
+                dst->nodes[i].x = src->nodes[i].x;
+                dst->nodes[i].y = src->nodes[i].y;
+                for (j = 0; j < 3; j++) {
+                        dst->nodes[i].nbr[j] = src->nodes[i].nbr[j];
+                        dst->nodes[i].edge[j] = src->nodes[i].edge[j];
                 }
-                free(sttreesBK);
         }
 
-        sttreesBK = (StTree *)malloc(numValidNets * sizeof(StTree));
-
-        for (netID = 0; netID < numValidNets; netID++) {
-                numNodes = 2 * sttrees[netID].deg - 2;
-                numEdges = 2 * sttrees[netID].deg - 3;
-
-                sttreesBK[netID].nodes = (TreeNode *)malloc(numNodes * sizeof(TreeNode));
-
-                for (i = 0; i < numNodes; i++) {
-                        sttreesBK[netID].nodes[i].x = sttrees[netID].nodes[i].x;
-                        sttreesBK[netID].nodes[i].y = sttrees[netID].nodes[i].y;
-                        for (j = 0; j < 3; j++) {
-                                sttreesBK[netID].nodes[i].nbr[j] = sttrees[netID].nodes[i].nbr[j];
-                                sttreesBK[netID].nodes[i].edge[j] = sttrees[netID].nodes[i].edge[j];
-                        }
+        dst->edges = (TreeEdge *)malloc(numEdges * sizeof(TreeEdge));
+        for (edgeID = 0; edgeID < numEdges; edgeID++) {
+                dst->edges[edgeID].len = src->edges[edgeID].len;
+                dst->edges[edgeID].n1 = src->edges[edgeID].n1;
+                dst->edges[edgeID].n2 = src->edges[edgeID].n2;
+                dst->edges[edgeID].route.type = MAZEROUTE;
+                dst->edges[edgeID].route.routelen = src->edges[edgeID].route.routelen;
+
+                // the degraded edges (len 0) also keep their single grid
+                dst->edges[edgeID].route.gridsX = (short *)calloc((src->edges[edgeID].route.routelen + 1), sizeof(short));
+                dst->edges[edgeID].route.gridsY = (short *)calloc((src->edges[edgeID].route.routelen + 1), sizeof(short));
+
+                for (i = 0; i <= src->edges[edgeID].route.routelen; i++) {
+                        dst->edges[edgeID].route.gridsX[i] = src->edges[edgeID].route.gridsX[i];
+                        dst->edges[edgeID].route.gridsY[i] = src->edges[edgeID].route.gridsY[i];
                 }
-                sttreesBK[netID].deg = sttrees[netID].deg;
-
-                sttreesBK[netID].edges = (TreeEdge *)malloc(numEdges * sizeof(TreeEdge));
-
-                for (edgeID = 0; edgeID < numEdges; edgeID++) {
-                        sttreesBK[netID].edges[edgeID].len = sttrees[netID].edges[edgeID].len;
-                        sttreesBK[netID].edges[edgeID].n1 = sttrees[netID].edges[edgeID].n1;
-                        sttreesBK[netID].edges[edgeID].n2 = sttrees[netID].edges[edgeID].n2;
+        }
+}
 
-                        if (sttrees[netID].edges[edgeID].len > 0)  // only route the non-degraded edges (len>0)
-                        {
-                                sttreesBK[netID].edges[edgeID].route.routelen = sttrees[netID].edges[edgeID].route.routelen;
-                                sttreesBK[netID].edges[edgeID].route.gridsX = (short *)calloc((sttrees[netID].edges[edgeID].route.routelen + 1), sizeof(short));
-                                sttreesBK[netID].edges[edgeID].route.gridsY = (short *)calloc((sttrees[netID].edges[edgeID].route.routelen + 1), sizeof(short));
+static void freeTree(StTree *tree) {
+        int edgeID, numEdges;
 
-                                for (i = 0; i <= sttrees[netID].edges[edgeID].route.routelen; i++) {
-                                        sttreesBK[netID].edges[edgeID].route.gridsX[i] = sttrees[netID].edges[edgeID].route.gridsX[i];
-                                        sttreesBK[netID].edges[edgeID].route.gridsY[i] = sttrees[netID].edges[edgeID].route.gridsY[i];
-                                }
-                        }
-                }
+        numEdges = 2 * tree->deg - 3;
+        for (edgeID = 0; edgeID < numEdges; edgeID++) {
+                free(tree->edges[edgeID].route.gridsX);
+                free(tree->edges[edgeID].route.gridsY);
         }
+        free(tree->nodes);
+        free(tree->edges);
+        tree->nodes = NULL;
+        tree->edges = NULL;
 }
 
-void copyBR(void) {
+// add inc to the usage of the 2D edges used by the maze routes of a tree
+static void addTreeUsage(StTree *tree, int inc) {
         short *gridsX, *gridsY;
-        int i, j, netID, edgeID, numEdges, numNodes, grid, min_y, min_x;
-
-        if (sttreesBK != NULL) {
-                printf("copy BR working\n");
-
-                for (netID = 0; netID < numValidNets; netID++) {
-                        numEdges = 2 * sttrees[netID].deg - 3;
-                        for (edgeID = 0; edgeID < numEdges; edgeID++) {
-                                if (sttrees[netID].edges[edgeID].len > 0) {
-                                        free(sttrees[netID].edges[edgeID].route.gridsX);
-                                        free(sttrees[netID].edges[edgeID].route.gridsY);
+        int i, edgeID, numEdges, min_y, min_x;
+
+        numEdges = 2 * tree->deg - 3;
+        for (edgeID = 0; edgeID < numEdges; edgeID++) {
+                if (tree->edges[edgeID].len > 0) {
+                        gridsX = tree->edges[edgeID].route.gridsX;
+                        gridsY = tree->edges[edgeID].route.gridsY;
+                        for (i = 0; i < tree->edges[edgeID].route.routelen; i++) {
+                                if (gridsX[i] == gridsX[i + 1])  // a vertical edge
+                                {
+                                        min_y = std::min(gridsY[i], gridsY[i + 1]);
+                                        v_edges[min_y * xGrid + gridsX[i]].usage += inc;
+                                } else  ///if(gridsY[i]==gridsY[i+1])// a horizontal edge
+                                {
+                                        min_x = std::min(gridsX[i], gridsX[i + 1]);
+                                        h_edges[gridsY[i] * (xGrid - 1) + min_x].usage += inc;
                                 }
                         }
-                        free(sttrees[netID].nodes);
-                        free(sttrees[netID].edges);
                 }
-                free(sttrees);
-
-                sttrees = (StTree *)malloc(numValidNets * sizeof(StTree));
-
-                for (netID = 0; netID < numValidNets; netID++) {
-                        numNodes = 2 * sttreesBK[netID].deg - 2;
-                        numEdges = 2 * sttreesBK[netID].deg - 3;
-
-                        sttrees[netID].nodes = (TreeNode *)malloc(numNodes * sizeof(TreeNode));
+        }
+}
 
-                        for (i = 0; i < numNodes; i++) {
-                                sttrees[netID].nodes[i].x = sttreesBK[netID].nodes[i].x;
-                                sttrees[netID].nodes[i].y = sttreesBK[netID].nodes[i].y;
-                                for (j = 0; j < 3; j++) {
-                                        sttrees[netID].nodes[i].nbr[j] = sttreesBK[netID].nodes[i].nbr[j];
-                                        sttrees[netID].nodes[i].edge[j] = sttreesBK[netID].nodes[i].edge[j];
-                                }
-                        }
+// Copy Routing Solution for the best routing solution so far
+void copyRS(void) {
+        int k;
 
-                        sttrees[netID].edges = (TreeEdge *)malloc(numEdges * sizeof(TreeEdge));
+        if (sttreesBK == NULL) {
+                // the nodes of a net are NULL until it is saved
+                sttreesBK = (StTree *)calloc(numValidNets, sizeof(StTree));
+                bkNets = (int *)malloc(numValidNets * sizeof(int));
+        } else {
+                for (k = 0; k < numBkNets; k++)
+                        freeTree(&sttreesBK[bkNets[k]]);
+        }
+        numBkNets = 0;
+}
 
-                        sttrees[netID].deg = sttreesBK[netID].deg;
+// save the tree of a net before it is rerouted, once per best solution
+void saveTreeBK(int netID) {
+        if (sttreesBK != NULL && sttreesBK[netID].nodes == NULL) {
+                copyTree(&sttreesBK[netID], &sttrees[netID]);
+                bkNets[numBkNets++] = netID;
+        }
+}
 
-                        for (edgeID = 0; edgeID < numEdges; edgeID++) {
-                                sttrees[netID].edges[edgeID].len = sttreesBK[netID].edges[edgeID].len;
-                                sttrees[netID].edges[edgeID].n1 = sttreesBK[netID].edges[edgeID].n1;
-                                sttrees[netID].edges[edgeID].n2 = sttreesBK[netID].edges[edgeID].n2;
+void copyBR(void) {
+        int i, j, k, netID, grid;
 
-                                sttrees[netID].edges[edgeID].route.type = MAZEROUTE;
-                                sttrees[netID].edges[edgeID].route.routelen = sttreesBK[netID].edges[edgeID].route.routelen;
+        if (sttreesBK != NULL) {
+                printf("copy BR working\n");
 
-                                if (sttreesBK[netID].edges[edgeID].len > 0)  // only route the non-degraded edges (len>0)
-                                {
-                                        sttrees[netID].edges[edgeID].route.type = MAZEROUTE;
-                                        sttrees[netID].edges[edgeID].route.routelen = sttreesBK[netID].edges[edgeID].route.routelen;
-                                        sttrees[netID].edges[edgeID].route.gridsX = (short *)calloc((sttreesBK[netID].edges[edgeID].route.routelen + 1), sizeof(short));
-                                        sttrees[netID].edges[edgeID].route.gridsY = (short *)calloc((sttreesBK[netID].edges[edgeID].route.routelen + 1), sizeof(short));
-
-                                        for (i = 0; i <= sttreesBK[netID].edges[edgeID].route.routelen; i++) {
-                                                sttrees[netID].edges[edgeID].route.gridsX[i] = sttreesBK[netID].edges[edgeID].route.gridsX[i];
-                                                sttrees[netID].edges[edgeID].route.gridsY[i] = sttreesBK[netID].edges[edgeID].route.gridsY[i];
-                                                //printf("x %d y %d     ",sttrees[netID].edges[edgeID].route.gridsX[i],sttrees[netID].edges[edgeID].route.gridsY[i]);
-                                        }
-                                        //printf("\n");
-                                }
-                        }
+                // swap the saved trees back in
+                for (k = 0; k < numBkNets; k++) {
+                        netID = bkNets[k];
+                        freeTree(&sttrees[netID]);
+                        sttrees[netID] = sttreesBK[netID];
+                        sttreesBK[netID].nodes = NULL;
+                        sttreesBK[netID].edges = NULL;
                 }
+                numBkNets = 0;
 
+                // the usage is counted again from all the routes, which also drops
+                // any difference the maze rounds left between usage and the routes
                 for (i = 0; i < yGrid; i++) {
                         for (j = 0; j < xGrid - 1; j++) {
                                 grid = i * (xGrid - 1) + j;
@@ -1615,44 +1678,78 @@ void copyBR(void) {
                                 v_edges[grid].usage = 0;
                         }
                 }
-                for (netID = 0; netID < numValidNets; netID++) {
-                        numEdges = 2 * sttrees[netID].deg - 3;
-                        for (edgeID = 0; edgeID < numEdges; edgeID++) {
-                                if (sttrees[netID].edges[edgeID].len > 0) {
-                                        gridsX = sttrees[netID].edges[edgeID].route.gridsX;
-                                        gridsY = sttrees[netID].edges[edgeID].route.gridsY;
-                                        for (i = 0; i < sttrees[netID].edges[edgeID].route.routelen; i++) {
-                                                if (gridsX[i] == gridsX[i + 1])  // a vertical edge
-                                                {
-                                                        min_y = std::min(gridsY[i], gridsY[i + 1]);
-                                                        v_edges[min_y * xGrid + gridsX[i]].usage += 1;
-                                                } else  ///if(gridsY[i]==gridsY[i+1])// a horizontal edge
-                                                {
-                                                        min_x = std::min(gridsX[i], gridsX[i + 1]);
-                                                        h_edges[gridsY[i] * (xGrid - 1) + min_x].usage += 1;
-                                                }
-                                        }
-                                }
-                        }
-                }
+                for (netID = 0; netID < numValidNets; netID++)
+                        addTreeUsage(&sttrees[netID], 1);
         }
 }
 
+// full copy of a tree with its maze routes, the 2D routes have no gridsL yet
+static void snapshotTree(StTree *dst, const StTree *src) {
+        int edgeID, numEdges, numNodes, routelen;
+        TreeEdge *treeedge;
+
+        numNodes = 2 * src->deg - 2;
+        numEdges = 2 * src->deg - 3;
+        dst->deg = src->deg;
+
+        dst->nodes = (TreeNode *)malloc(numNodes * sizeof(TreeNode));
+        memcpy(dst->nodes, src->nodes, numNodes * sizeof(TreeNode));
+        dst->edges = (TreeEdge *)malloc(numEdges * sizeof(TreeEdge));
+        memcpy(dst->edges, src->edges, numEdges * sizeof(TreeEdge));
+        for (edgeID = 0; edgeID < numEdges; edgeID++) {
+                treeedge = &dst->edges[edgeID];
+                routelen = treeedge->route.routelen;
+                treeedge->route.gridsX = (short *)malloc((routelen + 1) * sizeof(short));
+                treeedge->route.gridsY = (short *)malloc((routelen + 1) * sizeof(short));
+                treeedge->route.gridsL = NULL;
+                memcpy(treeedge->route.gridsX, src->edges[edgeID].route.gridsX, (routelen + 1) * sizeof(short));
+                memcpy(treeedge->route.gridsY, src->edges[edgeID].route.gridsY, (routelen + 1) * sizeof(short));
+        }
+}
+
+// save the 2D routing solution (the edges and the trees of all the nets) in
+// hEdges, vEdges and trees, numValidNets trees
+void saveRS(Edge *hEdges, Edge *vEdges, StTree *trees) {
+        int netID;
+
+        memcpy(hEdges, h_edges, (xGrid - 1) * yGrid * sizeof(Edge));
+        memcpy(vEdges, v_edges, xGrid * (yGrid - 1) * sizeof(Edge));
+        for (netID = 0; netID < numValidNets; netID++)
+                snapshotTree(&trees[netID], &sttrees[netID]);
+}
+
+// replace the 2D routing solution with a copy of one saved by saveRS, the
+// replaced trees are kept by saveTreeBK
+void restoreRS(const Edge *hEdges, const Edge *vEdges, const StTree *trees) {
+        int netID;
+        StTree tree;
+
+        memcpy(h_edges, hEdges, (xGrid - 1) * yGrid * sizeof(Edge));
+        memcpy(v_edges, vEdges, xGrid * (yGrid - 1) * sizeof(Edge));
+        for (netID = 0; netID < numValidNets; netID++) {
+                snapshotTree(&tree, &trees[netID]);
+                saveTreeBK(netID);
+                freeTree(&sttrees[netID]);
+                sttrees[netID] = tree;
+        }
+}
+
+// free the trees saved by saveRS
+void freeRS(StTree *trees) {
+        int netID;
+
+        for (netID = 0; netID < numValidNets; netID++)
+                freeTree(&trees[netID]);
+}
+
 void freeRR(void) {
-        int netID, edgeID, numEdges;
+        int k;
+
         if (sttreesBK != NULL) {
-                for (netID = 0; netID < numValidNets; netID++) {
-                        numEdges = 2 * sttreesBK[netID].deg - 3;
-                        for (edgeID = 0; edgeID < numEdges; edgeID++) {
-                                if (sttreesBK[netID].edges[edgeID].len > 0) {
-                                        free(sttreesBK[netID].edges[edgeID].route.gridsX);
-                                        free(sttreesBK[netID].edges[edgeID].route.gridsY);
-                                }
-                        }
-                        free(sttreesBK[netID].nodes);
-                        free(sttreesBK[netID].edges);
-                }
+                for (k = 0; k < numBkNets; k++)
+                        freeTree(&sttreesBK[bkNets[k]]);
                 free(sttreesBK);
+                free(bkNets);
         }
 }
 
@@ -39,12 +39,12 @@ extern void printEdge(int netID, int edgeID);
 extern void plotTree(int netID);
 
 extern void fillVIA();
-extern int threeDVIA();
 
 extern void netpinOrderInc();
 
 extern void writeRoute3D(char routingfile3D[]);
 extern void checkRoute3D();
+extern void checkRoutes3D(VerifyLevel level, RouteCheck *check);
 extern void write3D();
 extern void StNetOrder();
 extern Bool checkRoute3DEdgeType2(int netID, int edgeID);
@@ -60,10 +60,15 @@ extern void finalSumCheck();
 extern void ACE();
 
 extern void newLA();
+extern void setStackAlias(TreeNode *treenodes, int deg);
 extern void iniBDE();
 extern void copyBR(void);
 extern void copyRS(void);
+extern void saveTreeBK(int netID);
 extern void freeRR(void);
+extern void saveRS(Edge *hEdges, Edge *vEdges, StTree *trees);
+extern void restoreRS(const Edge *hEdges, const Edge *vEdges, const StTree *trees);
+extern void freeRS(StTree *trees);
 
 }  // namespace FastRoute
 